@@ -0,0 +1,136 @@
+#include "graphics/incremental_depth_sorter/incremental_depth_sorter.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+/**
+ * compares the persistent depth order against rebuilding and copying a fully sorted list every frame, which is what
+ * the particle emitter did before. every frame the particles drift a little, a few die and a few spawn, which is the
+ * coherent case. the incoherent case reshuffles all depths every frame to show the cost of the radix fallback.
+ */
+
+namespace {
+
+const int WARMUP_FRAMES = 10;
+const int MEASURED_FRAMES = 200;
+const double TURNOVER_PER_FRAME = 0.01;
+
+// keeps the sorts from being optimized away
+volatile unsigned int benchmark_sink;
+
+struct SimulatedParticles {
+    std::vector<float> depths;
+    std::vector<float> depth_velocities;
+};
+
+void step(SimulatedParticles &particles, std::mt19937 &rng, bool coherent) {
+    std::uniform_real_distribution<float> depth_dist(1.0f, 50.0f);
+    for (std::size_t i = 0; i < particles.depths.size(); i++) {
+        particles.depths[i] = coherent ? particles.depths[i] + particles.depth_velocities[i] : depth_dist(rng);
+    }
+}
+
+// the old path, a fresh sorted list every frame that the caller then copies
+std::vector<unsigned int> sort_by_rebuilding(const std::vector<float> &depths) {
+    std::vector<unsigned int> indices(depths.size());
+    std::iota(indices.begin(), indices.end(), 0);
+    std::sort(indices.begin(), indices.end(), [&](unsigned int a, unsigned int b) { return depths[a] > depths[b]; });
+    return indices;
+}
+
+double run_rebuild(std::size_t count, bool coherent) {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> depth_dist(1.0f, 50.0f);
+    std::uniform_real_distribution<float> velocity_dist(-0.01f, 0.01f);
+    SimulatedParticles particles;
+    for (std::size_t i = 0; i < count; i++) {
+        particles.depths.push_back(depth_dist(rng));
+        particles.depth_velocities.push_back(velocity_dist(rng));
+    }
+
+    double total_ms = 0;
+    for (int frame = 0; frame < WARMUP_FRAMES + MEASURED_FRAMES; frame++) {
+        step(particles, rng, coherent);
+        std::size_t turnover = count * TURNOVER_PER_FRAME;
+        for (std::size_t i = 0; i < turnover; i++) {
+            particles.depths[rng() % count] = depth_dist(rng);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<unsigned int> sorted = sort_by_rebuilding(particles.depths);
+        std::vector<unsigned int> copy = sorted;
+        auto end = std::chrono::steady_clock::now();
+
+        benchmark_sink = copy.front();
+        if (frame >= WARMUP_FRAMES) {
+            total_ms += std::chrono::duration<double, std::milli>(end - start).count();
+        }
+    }
+    return total_ms / MEASURED_FRAMES;
+}
+
+double run_incremental(std::size_t count, bool coherent, IncrementalDepthSorter &sorter) {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> depth_dist(1.0f, 50.0f);
+    std::uniform_real_distribution<float> velocity_dist(-0.01f, 0.01f);
+    SimulatedParticles particles;
+    for (std::size_t i = 0; i < count; i++) {
+        particles.depths.push_back(depth_dist(rng));
+        particles.depth_velocities.push_back(velocity_dist(rng));
+        sorter.insert(i);
+    }
+
+    double total_ms = 0;
+    for (int frame = 0; frame < WARMUP_FRAMES + MEASURED_FRAMES; frame++) {
+        step(particles, rng, coherent);
+        // a death followed by a spawn in the freed slot, the same way the emitter swaps and pops
+        std::size_t turnover = count * TURNOVER_PER_FRAME;
+        std::size_t last = count - 1;
+
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < turnover; i++) {
+            unsigned int dead = rng() % count;
+            sorter.remove(dead, last);
+            particles.depths[dead] = particles.depths[last];
+            particles.depths[last] = depth_dist(rng);
+            sorter.insert(last);
+        }
+        std::span<const unsigned int> sorted = sorter.sort_back_to_front(particles.depths);
+        auto end = std::chrono::steady_clock::now();
+
+        benchmark_sink = sorted.front();
+        if (frame >= WARMUP_FRAMES) {
+            total_ms += std::chrono::duration<double, std::milli>(end - start).count();
+        }
+    }
+    return total_ms / MEASURED_FRAMES;
+}
+
+} // namespace
+
+int main() {
+    std::cout << std::left << std::setw(12) << "particles" << std::setw(12) << "coherent" << std::setw(16)
+              << "rebuild ms" << std::setw(16) << "incremental ms" << std::setw(12) << "speedup"
+              << "insertion/radix" << std::endl;
+
+    for (std::size_t count : {1000, 10000, 100000}) {
+        for (bool coherent : {true, false}) {
+            double rebuild_ms = run_rebuild(count, coherent);
+            IncrementalDepthSorter sorter(count);
+            double incremental_ms = run_incremental(count, coherent, sorter);
+
+            std::cout << std::left << std::setw(12) << count << std::setw(12) << (coherent ? "yes" : "no")
+                      << std::setw(16) << rebuild_ms << std::setw(16) << incremental_ms << std::setw(12)
+                      << rebuild_ms / incremental_ms << sorter.get_insertion_sort_count() << "/"
+                      << sorter.get_radix_sort_count() << std::endl;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
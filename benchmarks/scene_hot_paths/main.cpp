@@ -0,0 +1,654 @@
+#include "graphics/retained_mesh_registry/retained_mesh_registry.hpp"
+#include "graphics/scripted_event_timeline/scripted_event_timeline.hpp"
+#include "graphics/scripted_transform/scripted_transform.hpp"
+#include "graphics/scripted_transform_system/scripted_transform_system.hpp"
+#include "graphics/soa_particle_emitter/soa_particle_emitter.hpp"
+
+#include "utility/animation_pose_cache/animation_pose_cache.hpp"
+#include "utility/bone_socket_system/bone_socket_system.hpp"
+#include "utility/work_stealing_scheduler/work_stealing_scheduler.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * times the cpu side hot paths of the scene without a window or gl context and writes the results as json so that
+ * runs can be diffed release over release, every performance change is judged against a run of this on the commit
+ * before it.
+ *
+ * every benchmark is a family over one size parameter, each size is measured over a number of samples and every
+ * sample runs the operation a fixed number of times, the json keeps the median, mean, min and max nanoseconds per
+ * operation over the samples.
+ */
+
+using json = nlohmann::json;
+
+namespace {
+
+struct BenchmarkArguments {
+    std::string output_path = "scene_hot_paths_benchmark.json";
+    std::string filter;
+    // smaller sizes and fewer samples, for a quick sanity check rather than numbers to compare
+    bool quick = false;
+};
+
+BenchmarkArguments parse_arguments(int argc, char *argv[]) {
+    BenchmarkArguments arguments;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "--output" and i + 1 < argc) {
+            arguments.output_path = argv[++i];
+        } else if (argument == "--filter" and i + 1 < argc) {
+            arguments.filter = argv[++i];
+        } else if (argument == "--quick") {
+            arguments.quick = true;
+        } else {
+            throw std::runtime_error("usage: " + std::string(argv[0]) +
+                                     " [--output results.json] [--filter name_substring] [--quick]");
+        }
+    }
+    return arguments;
+}
+
+// keeps the results of the measured operations from being optimized away
+volatile float benchmark_sink;
+
+struct BenchmarkResult {
+    std::string name;
+    std::string parameter_name;
+    std::size_t parameter;
+    std::size_t operations_per_sample;
+    std::vector<double> ns_per_operation; // one entry per sample
+};
+
+class BenchmarkSuite {
+  public:
+    explicit BenchmarkSuite(const BenchmarkArguments &arguments) : arguments(arguments) {}
+
+    bool is_selected(const std::string &name) const {
+        return arguments.filter.empty() or name.find(arguments.filter) != std::string::npos;
+    }
+
+    std::vector<std::size_t> sizes(std::vector<std::size_t> full, std::vector<std::size_t> quick) const {
+        return arguments.quick ? quick : full;
+    }
+
+    int get_num_samples() const { return arguments.quick ? 3 : 15; }
+
+    /**
+     * setup runs before every sample and isn't timed, operation is timed operations_per_sample times in a row
+     */
+    void run(const std::string &name, const std::string &parameter_name, std::size_t parameter,
+             std::size_t operations_per_sample, const std::function<void()> &setup,
+             const std::function<void()> &operation) {
+        BenchmarkResult result{name, parameter_name, parameter, operations_per_sample, {}};
+        // one untimed sample to fault in memory and warm the caches
+        for (int sample = -1; sample < get_num_samples(); sample++) {
+            setup();
+            auto start = std::chrono::steady_clock::now();
+            for (std::size_t i = 0; i < operations_per_sample; i++) {
+                operation();
+            }
+            auto end = std::chrono::steady_clock::now();
+            if (sample >= 0) {
+                result.ns_per_operation.push_back(std::chrono::duration<double, std::nano>(end - start).count() /
+                                                  operations_per_sample);
+            }
+        }
+        print(result);
+        results.push_back(std::move(result));
+    }
+
+    void write_json(const std::string &output_path) const {
+        json benchmarks = json::array();
+        for (const BenchmarkResult &result : results) {
+            std::vector<double> sorted = result.ns_per_operation;
+            std::sort(sorted.begin(), sorted.end());
+            double sum = 0;
+            for (double ns : sorted) {
+                sum += ns;
+            }
+            benchmarks.push_back({{"name", result.name},
+                                  {"parameter_name", result.parameter_name},
+                                  {"parameter", result.parameter},
+                                  {"operations_per_sample", result.operations_per_sample},
+                                  {"samples", sorted.size()},
+                                  {"median_ns", sorted[sorted.size() / 2]},
+                                  {"mean_ns", sum / sorted.size()},
+                                  {"min_ns", sorted.front()},
+                                  {"max_ns", sorted.back()}});
+        }
+
+        json report = {
+            {"suite", "scene_hot_paths"},
+            {"unix_time", std::chrono::duration_cast<std::chrono::seconds>(
+                              std::chrono::system_clock::now().time_since_epoch())
+                              .count()},
+            {"quick", arguments.quick},
+            {"benchmarks", benchmarks},
+        };
+
+        std::ofstream file(output_path);
+        if (not file.is_open()) {
+            throw std::runtime_error("couldn't open " + output_path + " for writing");
+        }
+        file << report.dump(2) << std::endl;
+    }
+
+  private:
+    static void print(const BenchmarkResult &result) {
+        std::vector<double> sorted = result.ns_per_operation;
+        std::sort(sorted.begin(), sorted.end());
+        std::cout << std::left << std::setw(40) << result.name << std::setw(24)
+                  << (result.parameter_name + "=" + std::to_string(result.parameter)) << std::right << std::setw(14)
+                  << std::fixed << std::setprecision(1) << sorted[sorted.size() / 2] << " ns/op" << std::endl;
+    }
+
+    const BenchmarkArguments &arguments;
+    std::vector<BenchmarkResult> results;
+};
+
+glm::mat4 make_world_to_clip() {
+    glm::mat4 projection = glm::perspective(glm::radians(90.0f), 16.0f / 9.0f, 0.1f, 50.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0, 1, 5), glm::vec3(0, 0, 0), glm::vec3(0, 1, 0));
+    return projection * view;
+}
+
+// VVV SCRIPTED TRANSFORM
+
+std::vector<ScriptedTransformKeyframe> make_keyframes(std::size_t num_keyframes) {
+    std::vector<ScriptedTransformKeyframe> keyframes;
+    keyframes.reserve(num_keyframes);
+    for (std::size_t i = 0; i < num_keyframes; i++) {
+        // a helix so that consecutive segments have different lengths and directions
+        float angle = i * 0.3f;
+        keyframes.push_back({glm::vec3(std::cos(angle) * 3.0f, i * 0.01f, std::sin(angle) * 3.0f),
+                             glm::vec3(0.1f * std::sin(angle), angle, 0.0f), glm::vec3(1.0f + 0.1f * std::cos(angle))});
+    }
+    return keyframes;
+}
+
+void benchmark_scripted_transform(BenchmarkSuite &suite) {
+    for (std::size_t num_keyframes : suite.sizes({10, 100, 1000, 10000, 100000}, {10, 1000})) {
+        std::vector<ScriptedTransformKeyframe> keyframes = make_keyframes(num_keyframes);
+        double ms_end_time = num_keyframes * 100.0;
+
+        if (suite.is_selected("scripted_transform_construct")) {
+            suite.run("scripted_transform_construct", "keyframes", num_keyframes, 1, [] {}, [&] {
+                ScriptedTransform scripted_transform(keyframes, 0, ms_end_time);
+                benchmark_sink = scripted_transform.transform.position.x;
+            });
+        }
+
+        if (suite.is_selected("scripted_transform_update")) {
+            // forward playback through the whole path, like the camera in the scene
+            const std::size_t num_updates = 10000;
+            ScriptedTransform scripted_transform(keyframes, 0, ms_end_time);
+            std::size_t update_index = 0;
+            suite.run(
+                "scripted_transform_update", "keyframes", num_keyframes, num_updates,
+                [&] {
+                    scripted_transform = ScriptedTransform(keyframes, 0, ms_end_time);
+                    update_index = 0;
+                },
+                [&] {
+                    scripted_transform.update(ms_end_time * update_index++ / num_updates);
+                    benchmark_sink = scripted_transform.transform.position.x;
+                });
+        }
+
+        // what the scene needs in the end is a matrix, either through the euler angles or straight from quaternions
+        bool euler_selected = suite.is_selected("scripted_transform_euler_matrix");
+        bool quaternion_selected = suite.is_selected("scripted_transform_quaternion_matrix");
+        if (euler_selected or quaternion_selected) {
+            const std::size_t num_updates = 10000;
+            ScriptedTransform scripted_transform(keyframes, 0, ms_end_time, 0.5, 0.5, 0.5, 0.01, true);
+            std::size_t update_index = 0;
+            glm::mat4 transform_matrix;
+            auto restart = [&] { update_index = 0; };
+
+            if (euler_selected) {
+                suite.run("scripted_transform_euler_matrix", "keyframes", num_keyframes, num_updates, restart, [&] {
+                    scripted_transform.update(ms_end_time * update_index++ / num_updates);
+                    transform_matrix = scripted_transform.transform.get_transform_matrix();
+                    benchmark_sink = transform_matrix[0][0];
+                });
+            }
+
+            if (quaternion_selected) {
+                suite.run("scripted_transform_quaternion_matrix", "keyframes", num_keyframes, num_updates, restart,
+                          [&] {
+                              scripted_transform.update(ms_end_time * update_index++ / num_updates, transform_matrix);
+                              benchmark_sink = transform_matrix[0][0];
+                          });
+            }
+        }
+    }
+}
+
+/**
+ * many tracks evaluated at the same time, once by calling update on every ScriptedTransform and once through a
+ * ScriptedTransformSystem holding the same tracks, an operation evaluates all of them
+ */
+void benchmark_scripted_transform_tracks(BenchmarkSuite &suite) {
+    bool per_track_selected = suite.is_selected("scripted_transform_tracks_update");
+    bool system_selected = suite.is_selected("scripted_transform_system_update");
+    if (not per_track_selected and not system_selected) {
+        return;
+    }
+
+    const std::size_t num_keyframes = 100;
+    std::vector<ScriptedTransformKeyframe> keyframes = make_keyframes(num_keyframes);
+    for (std::size_t num_tracks : suite.sizes({16, 256, 4096}, {16, 256})) {
+        std::vector<ScriptedTransform> scripted_transforms;
+        ScriptedTransformSystem scripted_transform_system;
+        for (std::size_t i = 0; i < num_tracks; i++) {
+            // staggered so that the tracks are on different segments at the same time
+            double ms_start_time = (i % 64) * 50.0;
+            scripted_transforms.emplace_back(keyframes, ms_start_time, ms_start_time + num_keyframes * 100.0);
+            scripted_transform_system.add_track(scripted_transforms.back());
+        }
+        std::vector<Transform> transforms(num_tracks);
+
+        // forward playback, like the scene
+        const std::size_t num_updates = 1000;
+        const double ms_end_time = num_keyframes * 100.0 + 64 * 50.0;
+        std::size_t update_index = 0;
+        auto restart = [&] { update_index = 0; };
+
+        if (per_track_selected) {
+            suite.run("scripted_transform_tracks_update", "tracks", num_tracks, num_updates, restart, [&] {
+                double ms_curr_time = ms_end_time * update_index++ / num_updates;
+                for (std::size_t i = 0; i < num_tracks; i++) {
+                    scripted_transforms[i].update(ms_curr_time);
+                    transforms[i] = scripted_transforms[i].transform;
+                }
+                benchmark_sink = transforms.back().position.x;
+            });
+        }
+
+        if (system_selected) {
+            suite.run("scripted_transform_system_update", "tracks", num_tracks, num_updates, restart, [&] {
+                scripted_transform_system.update(ms_end_time * update_index++ / num_updates, transforms.data());
+                benchmark_sink = transforms.back().position.x;
+            });
+        }
+    }
+}
+
+// ^^^ SCRIPTED TRANSFORM
+// VVV SCRIPTED EVENTS
+
+/**
+ * writes a scripted events json with half toggles and half playthroughs spread over duration_sec
+ */
+std::string write_scripted_events_json(std::size_t num_events, double duration_sec) {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> time_dist(0.0, duration_sec);
+    std::uniform_real_distribution<double> toggle_length_dist(0.1, 2.0);
+
+    json events = json::array();
+    for (std::size_t i = 0; i < num_events; i++) {
+        // a few hundred distinct names, events repeat like they do in a real script
+        std::string name = "event_" + std::to_string(i % 256);
+        double time_sec = time_dist(rng);
+        if (i % 2 == 0) {
+            events.push_back({{"name", name},
+                              {"type", "toggle"},
+                              {"start_time", time_sec},
+                              {"end_time", time_sec + toggle_length_dist(rng)}});
+        } else {
+            events.push_back({{"name", name}, {"type", "playthrough"}, {"time", time_sec}});
+        }
+    }
+
+    std::filesystem::path path = std::filesystem::temp_directory_path() /
+                                 ("scene_hot_paths_benchmark_events_" + std::to_string(num_events) + ".json");
+    std::ofstream file(path);
+    file << json{{"events", events}}.dump();
+    return path.string();
+}
+
+void benchmark_scripted_events(BenchmarkSuite &suite) {
+    if (not suite.is_selected("scripted_event_timeline_run")) {
+        return;
+    }
+
+    for (std::size_t num_events : suite.sizes({1000, 10000, 100000}, {1000})) {
+        const double duration_sec = 600.0;
+        const std::size_t num_frames = duration_sec * 60;
+        std::string json_path = write_scripted_events_json(num_events, duration_sec);
+
+        std::size_t fired_edges = 0;
+        std::optional<ScriptedEventTimeline> scripted_event_timeline;
+        std::size_t frame = 0;
+        // a whole playthrough at 60 fps per sample, so one operation is one frame
+        suite.run(
+            "scripted_event_timeline_run", "events", num_events, num_frames,
+            [&] {
+                scripted_event_timeline.emplace(json_path);
+                for (unsigned int event_id = 0; event_id < scripted_event_timeline->get_event_count(); event_id++) {
+                    scripted_event_timeline->bind_callback(event_id,
+                                                           [&](bool first_call, bool last_call) { fired_edges++; });
+                }
+                frame = 0;
+            },
+            [&] { scripted_event_timeline->run_scripted_events(frame++ / 60.0); });
+        benchmark_sink = fired_edges;
+
+        std::filesystem::remove(json_path);
+    }
+}
+
+void benchmark_scripted_event_seek(BenchmarkSuite &suite) {
+    if (not suite.is_selected("scripted_event_timeline_seek")) {
+        return;
+    }
+
+    for (std::size_t num_events : suite.sizes({1000, 10000, 100000}, {1000})) {
+        const double duration_sec = 600.0;
+        std::string json_path = write_scripted_events_json(num_events, duration_sec);
+
+        std::size_t fired_edges = 0;
+        ScriptedEventTimeline scripted_event_timeline(json_path);
+        for (unsigned int event_id = 0; event_id < scripted_event_timeline.get_event_count(); event_id++) {
+            scripted_event_timeline.bind_callback(event_id, [&](bool first_call, bool last_call) { fired_edges++; });
+        }
+
+        // scrubbing back and forth over the whole script
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<double> time_dist(0.0, duration_sec);
+        suite.run("scripted_event_timeline_seek", "events", num_events, 1000, [] {},
+                  [&] { scripted_event_timeline.seek(time_dist(rng)); });
+        benchmark_sink = fired_edges;
+
+        std::filesystem::remove(json_path);
+    }
+}
+
+// ^^^ SCRIPTED EVENTS
+// VVV PARTICLES
+
+// set before constructing an emitter so that it settles at about as many alive particles as it has slots
+float benchmark_spawn_delay_sec = 0.1f;
+
+struct BenchmarkLifeSpan {
+    static float sample(ParticleRandomGenerator &random) { return random.uniform(1.0f, 3.0f); }
+};
+
+struct BenchmarkInitialVelocity {
+    static glm::vec3 sample(ParticleRandomGenerator &random) {
+        return glm::vec3(random.uniform(-0.1f, 0.1f), random.uniform(0.1f, 0.2f), random.uniform(-0.1f, 0.1f));
+    }
+};
+
+struct BenchmarkVelocityChange {
+    static glm::vec3 compute(float life_percentage, float delta_time, ParticleRandomGenerator &random) {
+        return -glm::vec3(random.uniform(-0.0025f, 0.0025f), 0, random.uniform(-0.0025f, 0.0025f)) * delta_time;
+    }
+};
+
+struct BenchmarkScaling {
+    static float compute(float life_percentage) { return life_percentage * 0.1f; }
+};
+
+struct BenchmarkRotation {
+    static float compute(float life_percentage) { return life_percentage / 5.0f; }
+};
+
+struct BenchmarkSpawnDelay {
+    static float sample(ParticleRandomGenerator &random) { return benchmark_spawn_delay_sec; }
+};
+
+// the same policies as the cigarette smoke except that the spawn rate scales with the particle count
+using BenchmarkParticleEmitter =
+    SoAParticleEmitter<BenchmarkLifeSpan, BenchmarkInitialVelocity, BenchmarkVelocityChange, BenchmarkScaling,
+                       BenchmarkRotation, BenchmarkSpawnDelay>;
+
+void benchmark_particles(BenchmarkSuite &suite) {
+    if (not suite.is_selected("particle_emitter_update_and_sort")) {
+        return;
+    }
+
+    glm::mat4 world_to_clip = make_world_to_clip();
+    for (std::size_t num_particles : suite.sizes({1000, 10000, 100000, 1000000}, {1000, 10000})) {
+        // a mean life span of 2 seconds, so this spawns about as many particles as die
+        benchmark_spawn_delay_sec = 2.0f / num_particles;
+        Transform emitter_transform;
+        emitter_transform.scale = glm::vec3(.2, .2, .2);
+        BenchmarkParticleEmitter emitter(num_particles, emitter_transform, 1);
+
+        // past the longest life span so that the emitter is in its steady state of spawns and deaths
+        for (int i = 0; i < 8; i++) {
+            emitter.update(0.5f, world_to_clip);
+        }
+
+        const float delta_time = 1.0f / 60.0f;
+        suite.run("particle_emitter_update_and_sort", "particles", num_particles, 60, [] {}, [&] {
+            emitter.update(delta_time, world_to_clip);
+            std::span<const unsigned int> sorted = emitter.get_particles_sorted_by_distance();
+            benchmark_sink = sorted.empty() ? 0 : sorted.front();
+        });
+    }
+}
+
+// ^^^ PARTICLES
+// VVV WORK STEALING SCHEDULER
+
+// the billboard matrices the scene builds for every particle, in parallel and then serially, the two have to match
+void benchmark_work_stealing_parallel_for(BenchmarkSuite &suite) {
+    if (not suite.is_selected("work_stealing_parallel_for")) {
+        return;
+    }
+
+    const std::size_t grain_size = 256;
+    WorkStealingScheduler scheduler;
+    for (std::size_t num_particles : suite.sizes({1000, 10000, 100000}, {1000, 10000})) {
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> position_dist(-5.0f, 5.0f);
+        std::vector<glm::vec3> positions(num_particles);
+        for (glm::vec3 &position : positions) {
+            position = glm::vec3(position_dist(rng), position_dist(rng), position_dist(rng));
+        }
+        glm::mat4 rotation_matrix = glm::rotate(glm::mat4(1.0f), 0.5f, glm::vec3(0, 1, 0));
+
+        std::vector<glm::mat4> transforms(num_particles);
+        auto build_transforms = [&](std::size_t chunk_begin, std::size_t chunk_end) {
+            for (std::size_t i = chunk_begin; i < chunk_end; i++) {
+                transforms[i] = glm::scale(glm::translate(glm::mat4(1.0f), positions[i]) * rotation_matrix,
+                                           glm::vec3(0.1f + 0.01f * (i % 10)));
+            }
+        };
+
+        scheduler.set_deterministic(true);
+        scheduler.parallel_for(0, num_particles, grain_size, build_transforms);
+        std::vector<glm::mat4> serial_transforms = transforms;
+
+        // the output is cleared before every checked run, otherwise a chunk that never ran would keep the
+        // deterministic result and still compare equal
+        auto clear_transforms = [&] { std::fill(transforms.begin(), transforms.end(), glm::mat4(0.0f)); };
+        auto check_transforms = [&] {
+            if (transforms != serial_transforms) {
+                throw std::runtime_error("parallel_for over " + std::to_string(num_particles) +
+                                         " particles didn't match the deterministic run");
+            }
+        };
+
+        scheduler.set_deterministic(false);
+        for (int run = 0; run < 10; run++) {
+            clear_transforms();
+            scheduler.parallel_for(0, num_particles, grain_size, build_transforms);
+            check_transforms();
+        }
+        suite.run("work_stealing_parallel_for", "particles", num_particles, 100, clear_transforms,
+                  [&] { scheduler.parallel_for(0, num_particles, grain_size, build_transforms); });
+        check_transforms();
+        benchmark_sink = transforms.back()[3][0];
+    }
+}
+
+// ^^^ WORK STEALING SCHEDULER
+// VVV BONE SOCKETS
+
+void benchmark_bone_sockets(BenchmarkSuite &suite) {
+    if (not suite.is_selected("bone_socket_evaluate")) {
+        return;
+    }
+
+    // about the size of the smoking rig
+    const unsigned int num_bones = 64;
+    std::unordered_map<std::string, unsigned int> bone_name_to_index;
+    std::vector<glm::mat4> bind_pose_transforms;
+    AnimationPose animation_pose;
+    for (unsigned int bone = 0; bone < num_bones; bone++) {
+        bone_name_to_index.emplace("bone_" + std::to_string(bone), bone);
+        bind_pose_transforms.push_back(glm::translate(glm::mat4(1.0f), glm::vec3(0, -0.1f * bone, 0)));
+        animation_pose.bone_palette.push_back(glm::mat4(1.0f));
+        glm::mat4 animated_transform = glm::translate(glm::mat4(1.0f), glm::vec3(0, 0.1f * bone, 0));
+        animation_pose.animated_transforms_upto_bone.push_back(
+            glm::rotate(animated_transform, 0.05f * bone, glm::vec3(0, 0, 1)));
+    }
+
+    for (std::size_t num_sockets : suite.sizes({1, 8, 64, 512, 4096}, {1, 64})) {
+        BoneSocketSystem bone_socket_system(bone_name_to_index, bind_pose_transforms);
+        for (std::size_t socket = 0; socket < num_sockets; socket++) {
+            Transform offset;
+            offset.position = glm::vec3(0.01f * socket, 0, 0.05f);
+            bone_socket_system.register_socket("bone_" + std::to_string(socket % num_bones), offset);
+        }
+
+        suite.run("bone_socket_evaluate", "sockets", num_sockets, 1000, [] {}, [&] {
+            bone_socket_system.evaluate(animation_pose);
+            benchmark_sink = bone_socket_system.get_socket_transform(0)[3][0];
+        });
+    }
+}
+
+// ^^^ BONE SOCKETS
+// VVV QUEUE DRAW
+
+/**
+ * the generated shader batchers need a gl context, this packs the same attributes into one contiguous set of cpu side
+ * arrays per frame the way their queue_draw does before the upload, so it measures the registry plus the packing
+ */
+class PackingShaderBatcher {
+  public:
+    void queue_draw(unsigned int object_id, const std::vector<unsigned int> &indices,
+                    const std::vector<unsigned int> &ltw_indices, const std::vector<glm::ivec4> &bone_ids,
+                    const std::vector<glm::vec4> &bone_weights, const std::vector<int> &packed_texture_indices,
+                    const std::vector<glm::vec2> &packed_texture_coordinates, const std::vector<glm::vec3> &normals,
+                    const std::vector<glm::vec3> &xyz_positions) {
+        unsigned int index_offset = packed_xyz_positions.size();
+        for (unsigned int index : indices) {
+            packed_indices.push_back(index_offset + index);
+        }
+        packed_ltw_indices.insert(packed_ltw_indices.end(), ltw_indices.begin(), ltw_indices.end());
+        packed_bone_ids.insert(packed_bone_ids.end(), bone_ids.begin(), bone_ids.end());
+        packed_bone_weights.insert(packed_bone_weights.end(), bone_weights.begin(), bone_weights.end());
+        packed_packed_texture_indices.insert(packed_packed_texture_indices.end(), packed_texture_indices.begin(),
+                                             packed_texture_indices.end());
+        packed_packed_texture_coordinates.insert(packed_packed_texture_coordinates.end(),
+                                                 packed_texture_coordinates.begin(), packed_texture_coordinates.end());
+        packed_normals.insert(packed_normals.end(), normals.begin(), normals.end());
+        packed_xyz_positions.insert(packed_xyz_positions.end(), xyz_positions.begin(), xyz_positions.end());
+    }
+
+    // what draw_everything does with the cpu side arrays once they are uploaded
+    void clear() {
+        packed_indices.clear();
+        packed_ltw_indices.clear();
+        packed_bone_ids.clear();
+        packed_bone_weights.clear();
+        packed_packed_texture_indices.clear();
+        packed_packed_texture_coordinates.clear();
+        packed_normals.clear();
+        packed_xyz_positions.clear();
+    }
+
+    std::size_t get_packed_vertex_count() const { return packed_xyz_positions.size(); }
+
+  private:
+    std::vector<unsigned int> packed_indices;
+    std::vector<unsigned int> packed_ltw_indices;
+    std::vector<glm::ivec4> packed_bone_ids;
+    std::vector<glm::vec4> packed_bone_weights;
+    std::vector<int> packed_packed_texture_indices;
+    std::vector<glm::vec2> packed_packed_texture_coordinates;
+    std::vector<glm::vec3> packed_normals;
+    std::vector<glm::vec3> packed_xyz_positions;
+};
+
+void benchmark_queue_draw(BenchmarkSuite &suite) {
+    if (not suite.is_selected("retained_mesh_queue_draw")) {
+        return;
+    }
+
+    // a particle square, which is what most of the draws in the scene are
+    std::vector<unsigned int> indices = {0, 1, 2, 0, 2, 3};
+    std::vector<glm::vec3> xyz_positions = {{-1, -1, 0}, {1, -1, 0}, {1, 1, 0}, {-1, 1, 0}};
+    std::vector<glm::vec3> normals(4, glm::vec3(0, 0, 1));
+    std::vector<glm::vec2> texture_coordinates = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+
+    for (std::size_t num_meshes : suite.sizes({100, 1000, 10000, 100000}, {100, 1000})) {
+        PackingShaderBatcher shader_batcher;
+        RetainedMeshRegistry<PackingShaderBatcher> mesh_registry(shader_batcher);
+        for (unsigned int object_id = 0; object_id < num_meshes; object_id++) {
+            mesh_registry.register_mesh(object_id, object_id, indices, xyz_positions, normals, texture_coordinates, 0);
+        }
+
+        // one operation is a whole frame worth of draws
+        suite.run("retained_mesh_queue_draw", "meshes", num_meshes, 20, [] {}, [&] {
+            shader_batcher.clear();
+            for (unsigned int object_id = 0; object_id < num_meshes; object_id++) {
+                mesh_registry.draw(object_id);
+            }
+            benchmark_sink = shader_batcher.get_packed_vertex_count();
+        });
+    }
+}
+
+// ^^^ QUEUE DRAW
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    try {
+        BenchmarkArguments arguments = parse_arguments(argc, argv);
+        BenchmarkSuite suite(arguments);
+
+        benchmark_scripted_transform(suite);
+        benchmark_scripted_transform_tracks(suite);
+        benchmark_scripted_events(suite);
+        benchmark_scripted_event_seek(suite);
+        benchmark_particles(suite);
+        benchmark_work_stealing_parallel_for(suite);
+        benchmark_bone_sockets(suite);
+        benchmark_queue_draw(suite);
+
+        suite.write_json(arguments.output_path);
+        std::cout << "wrote " << arguments.output_path << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
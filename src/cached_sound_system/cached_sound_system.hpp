@@ -0,0 +1,183 @@
+#ifndef CACHED_SOUND_SYSTEM_HPP
+#define CACHED_SOUND_SYSTEM_HPP
+
+#include "sbpt_generated_includes.hpp"
+
+#include <AL/al.h>
+#include <AL/alc.h>
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * opens an openal device and makes a context for it current, the device name is passed straight to alcOpenDevice so
+ * nullptr is the default device, and with openal soft ALSOFT_DRIVERS=null gives a device that outputs nothing
+ */
+class OpenALDevice {
+  public:
+    explicit OpenALDevice(const char *device_name = nullptr) {
+        device = alcOpenDevice(device_name);
+        if (device == nullptr) {
+            throw std::runtime_error("couldn't open openal device");
+        }
+        context = alcCreateContext(device, nullptr);
+        if (context == nullptr or not alcMakeContextCurrent(context)) {
+            if (context != nullptr) {
+                alcDestroyContext(context);
+            }
+            alcCloseDevice(device);
+            throw std::runtime_error("couldn't create an openal context");
+        }
+    }
+
+    ~OpenALDevice() {
+        alcMakeContextCurrent(nullptr);
+        alcDestroyContext(context);
+        alcCloseDevice(device);
+    }
+
+    OpenALDevice(const OpenALDevice &) = delete;
+    OpenALDevice &operator=(const OpenALDevice &) = delete;
+
+  private:
+    ALCdevice *device;
+    ALCcontext *context;
+};
+
+/**
+ * has the same queue_sound / play_all_sounds interface as SoundSystem, but the sounds come out of a SoundBufferCache
+ * so nothing is decoded up front and nothing is decoded on the calling thread. a sound queued before its decode is
+ * done starts as soon as it is, or is dropped if that takes longer than MAX_PENDING_TIME.
+ *
+ * SoundType is whatever enum the sound files are keyed by
+ */
+template <typename SoundType> class CachedSoundSystem {
+  public:
+    static constexpr std::chrono::milliseconds MAX_PENDING_TIME{250};
+
+    CachedSoundSystem(unsigned int max_concurrent_sounds,
+                      std::unordered_map<SoundType, std::string> sound_type_to_file,
+                      std::size_t memory_budget_bytes, const char *device_name = nullptr)
+        : openal_device(device_name), sound_type_to_file(std::move(sound_type_to_file)),
+          sound_buffer_cache(memory_budget_bytes) {
+        playing_sounds.resize(max_concurrent_sounds);
+        for (PlayingSound &playing_sound : playing_sounds) {
+            alGenSources(1, &playing_sound.source);
+        }
+    }
+
+    ~CachedSoundSystem() {
+        for (PlayingSound &playing_sound : playing_sounds) {
+            alSourceStop(playing_sound.source);
+            alSourcei(playing_sound.source, AL_BUFFER, 0);
+            alDeleteSources(1, &playing_sound.source);
+        }
+    }
+
+    /**
+     * starts decoding the sound in the background if it isn't loaded yet
+     */
+    void prewarm(SoundType sound_type) { sound_buffer_cache.request(get_file_path(sound_type)); }
+
+    void queue_sound(SoundType sound_type, glm::vec3 position) {
+        const std::string &file_path = get_file_path(sound_type);
+        sound_buffer_cache.request(file_path);
+        queued_sounds.push_back({file_path, position, std::chrono::steady_clock::now()});
+    }
+
+    /**
+     * call once per frame, picks up finished decodes, frees the sources of sounds that ended and starts every queued
+     * sound that is ready
+     */
+    void play_all_sounds() {
+        sound_buffer_cache.update();
+
+        for (PlayingSound &playing_sound : playing_sounds) {
+            if (playing_sound.file_path.empty()) {
+                continue;
+            }
+            ALint state;
+            alGetSourcei(playing_sound.source, AL_SOURCE_STATE, &state);
+            if (state != AL_PLAYING) {
+                alSourcei(playing_sound.source, AL_BUFFER, 0);
+                sound_buffer_cache.release(playing_sound.file_path);
+                playing_sound.file_path.clear();
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        std::vector<QueuedSound> still_pending;
+        for (QueuedSound &queued_sound : queued_sounds) {
+            ALuint buffer = sound_buffer_cache.acquire(queued_sound.file_path);
+            if (buffer == 0) {
+                // the cache already reported why
+                if (sound_buffer_cache.has_failed(queued_sound.file_path)) {
+                    continue;
+                }
+                if (now - queued_sound.queue_time < MAX_PENDING_TIME) {
+                    still_pending.push_back(std::move(queued_sound));
+                } else {
+                    std::cerr << "dropping sound " << queued_sound.file_path << ", it wasn't decoded in time"
+                              << std::endl;
+                }
+                continue;
+            }
+
+            PlayingSound *free_slot = nullptr;
+            for (PlayingSound &playing_sound : playing_sounds) {
+                if (playing_sound.file_path.empty()) {
+                    free_slot = &playing_sound;
+                    break;
+                }
+            }
+            if (free_slot == nullptr) {
+                sound_buffer_cache.release(queued_sound.file_path);
+                continue;
+            }
+
+            free_slot->file_path = queued_sound.file_path;
+            alSourcei(free_slot->source, AL_BUFFER, static_cast<ALint>(buffer));
+            alSource3f(free_slot->source, AL_POSITION, queued_sound.position.x, queued_sound.position.y,
+                       queued_sound.position.z);
+            alSourcePlay(free_slot->source);
+        }
+        queued_sounds = std::move(still_pending);
+    }
+
+    SoundBufferCache &get_sound_buffer_cache() { return sound_buffer_cache; }
+
+  private:
+    struct QueuedSound {
+        std::string file_path;
+        glm::vec3 position;
+        std::chrono::steady_clock::time_point queue_time;
+    };
+
+    struct PlayingSound {
+        ALuint source = 0;
+        std::string file_path; // empty when the source is free
+    };
+
+    const std::string &get_file_path(SoundType sound_type) const {
+        auto it = sound_type_to_file.find(sound_type);
+        if (it == sound_type_to_file.end()) {
+            throw std::runtime_error("no sound file for sound type " + std::to_string(static_cast<int>(sound_type)));
+        }
+        return it->second;
+    }
+
+    // declared first so the context outlives the buffers and sources
+    OpenALDevice openal_device;
+    std::unordered_map<SoundType, std::string> sound_type_to_file;
+    SoundBufferCache sound_buffer_cache;
+    std::vector<PlayingSound> playing_sounds;
+    std::vector<QueuedSound> queued_sounds;
+};
+
+#endif // CACHED_SOUND_SYSTEM_HPP
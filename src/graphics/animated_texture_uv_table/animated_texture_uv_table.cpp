@@ -0,0 +1,68 @@
+#include "animated_texture_uv_table.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+AnimatedTextureUVTable::AnimatedTextureUVTable(AnimatedTextureAtlas &animated_texture_atlas, double ms_per_frame,
+                                               unsigned int max_frames)
+    : ms_per_frame{ms_per_frame} {
+    if (ms_per_frame <= 0) {
+        throw std::runtime_error("ms per frame must be positive, got " + std::to_string(ms_per_frame));
+    }
+
+    // sampling in the middle of a frame keeps us away from rounding at the frame boundaries
+    auto sample_frame = [&](unsigned int frame_index) {
+        return animated_texture_atlas.get_texture_coordinates_of_current_animation_frame((frame_index + 0.5) *
+                                                                                         ms_per_frame);
+    };
+
+    std::vector<glm::vec2> first_frame = sample_frame(0);
+    if (first_frame.empty()) {
+        throw std::runtime_error("animated texture atlas has no texture coordinates for its first frame");
+    }
+    vertices_per_frame = first_frame.size();
+    texture_coordinates = first_frame;
+
+    unsigned int num_frames = 1;
+    for (;; num_frames++) {
+        if (num_frames > max_frames) {
+            throw std::runtime_error("animated texture atlas did not loop back to its first frame within " +
+                                     std::to_string(max_frames) + " frames");
+        }
+        std::vector<glm::vec2> frame = sample_frame(num_frames);
+        if (frame == first_frame) {
+            break;
+        }
+        if (frame.size() != vertices_per_frame) {
+            throw std::runtime_error("animated texture atlas frame " + std::to_string(num_frames) + " has " +
+                                     std::to_string(frame.size()) + " texture coordinates but the first frame has " +
+                                     std::to_string(vertices_per_frame));
+        }
+        texture_coordinates.insert(texture_coordinates.end(), frame.begin(), frame.end());
+    }
+
+    object_ids.reserve(num_frames);
+    for (unsigned int i = 0; i < num_frames; i++) {
+        object_ids.push_back(UniqueIDGenerator::generate());
+    }
+}
+
+unsigned int AnimatedTextureUVTable::get_frame_index(double ms_curr_time) const {
+    double frames_elapsed = std::floor(ms_curr_time / ms_per_frame);
+    double num_frames = static_cast<double>(object_ids.size());
+    return static_cast<unsigned int>(frames_elapsed - num_frames * std::floor(frames_elapsed / num_frames));
+}
+
+std::span<const glm::vec2> AnimatedTextureUVTable::get_texture_coordinates(unsigned int frame_index) const {
+    return std::span<const glm::vec2>(texture_coordinates).subspan(frame_index * vertices_per_frame,
+                                                                    vertices_per_frame);
+}
+
+unsigned int AnimatedTextureUVTable::get_object_id(unsigned int frame_index) const {
+    return object_ids.at(frame_index);
+}
+
+unsigned int AnimatedTextureUVTable::get_num_frames() const { return object_ids.size(); }
+
+unsigned int AnimatedTextureUVTable::get_vertices_per_frame() const { return vertices_per_frame; }
@@ -0,0 +1,44 @@
+#ifndef ANIMATED_TEXTURE_UV_TABLE_HPP
+#define ANIMATED_TEXTURE_UV_TABLE_HPP
+
+#include "sbpt_generated_includes.hpp"
+
+#include <glm/glm.hpp>
+
+#include <span>
+#include <vector>
+
+/**
+ * the texture coordinates of every frame of an AnimatedTextureAtlas laid out back to back, built once at load time.
+ * finding the frame for a time is a division and a modulo, and the coordinates come back as a view into the table so
+ * nothing is allocated or compared per frame.
+ *
+ * each frame also gets its own object id that never changes, so a batcher that caches geometry by object id uploads
+ * every frame once and after that just gets told which one to draw, instead of being handed a fresh id whenever the
+ * frame changes.
+ */
+class AnimatedTextureUVTable {
+  public:
+    /**
+     * samples the atlas in the middle of each frame until the animation wraps back around to the first frame, throws
+     * if it hasn't wrapped after max_frames
+     */
+    AnimatedTextureUVTable(AnimatedTextureAtlas &animated_texture_atlas, double ms_per_frame,
+                           unsigned int max_frames = 1024);
+
+    unsigned int get_frame_index(double ms_curr_time) const;
+
+    std::span<const glm::vec2> get_texture_coordinates(unsigned int frame_index) const;
+    unsigned int get_object_id(unsigned int frame_index) const;
+
+    unsigned int get_num_frames() const;
+    unsigned int get_vertices_per_frame() const;
+
+  private:
+    double ms_per_frame;
+    unsigned int vertices_per_frame;
+    std::vector<glm::vec2> texture_coordinates;
+    std::vector<unsigned int> object_ids;
+};
+
+#endif // ANIMATED_TEXTURE_UV_TABLE_HPP
@@ -0,0 +1,183 @@
+#include "compiled_scripted_path.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using json = nlohmann::json;
+
+const char COMPILED_SCRIPTED_PATH_MAGIC[4] = {'S', 'P', 'T', 'H'};
+const std::uint32_t ENDIANNESS_CHECK = 0x01020304;
+const std::uint32_t LAYOUT_SIGNATURE =
+    sizeof(ScriptedTransformKeyframe) | sizeof(glm::mat4x3) << 8 | sizeof(glm::mat4) << 16 | sizeof(ArcLengthSample) << 24;
+const std::size_t ARRAY_ALIGNMENT = 16;
+
+static_assert(std::is_trivially_copyable_v<ScriptedTransformKeyframe>);
+static_assert(std::is_trivially_copyable_v<ArcLengthSample>);
+static_assert(std::is_trivially_copyable_v<CompiledScriptedPathHeader>);
+// the arrays are written byte for byte, any padding the compiler adds would be uninitialized bytes in the file
+static_assert(sizeof(ScriptedTransformKeyframe) == 9 * sizeof(float));
+static_assert(sizeof(ArcLengthSample) == 3 * sizeof(double) + 2 * sizeof(unsigned int));
+
+static glm::vec3 parse_vec3(const json &j) { return glm::vec3(j.at(0), j.at(1), j.at(2)); }
+
+ScriptedTransform parse_scripted_path_description(const std::string &file_path) {
+    std::ifstream file(file_path);
+    if (not file.is_open()) {
+        throw std::runtime_error("couldn't open scripted path description " + file_path);
+    }
+
+    json description = json::parse(file);
+
+    std::vector<ScriptedTransformKeyframe> keyframes;
+    for (const json &keyframe : description.at("keyframes")) {
+        keyframes.push_back({parse_vec3(keyframe.at("position")), parse_vec3(keyframe.at("rotation")),
+                             parse_vec3(keyframe.value("scale", json::array({1.0, 1.0, 1.0})))});
+    }
+
+    return ScriptedTransform(keyframes, description.at("ms_start_time"), description.at("ms_end_time"),
+                             description.value("tau_position", 0.5), description.value("tau_rotation", 0.5),
+                             description.value("tau_scale", 0.5), description.value("arc_length_tolerance", 0.01),
+                             description.value("use_quaternion_rotation", false));
+}
+
+static std::uint64_t align_offset(std::uint64_t offset) {
+    return (offset + ARRAY_ALIGNMENT - 1) / ARRAY_ALIGNMENT * ARRAY_ALIGNMENT;
+}
+
+// reserves room for the array at the end of the file so far and returns where it starts
+template <typename T> static std::uint64_t reserve_array(std::span<const T> array, std::uint64_t &file_size) {
+    std::uint64_t offset = align_offset(file_size);
+    file_size = offset + array.size_bytes();
+    return offset;
+}
+
+template <typename T>
+static void write_array(std::ofstream &file, std::span<const T> array, std::uint64_t offset) {
+    // zero padding up to the aligned offset
+    static const char padding[ARRAY_ALIGNMENT] = {};
+    std::uint64_t position = file.tellp();
+    file.write(padding, offset - position);
+    file.write(reinterpret_cast<const char *>(array.data()), array.size_bytes());
+}
+
+void write_compiled_scripted_path(const std::string &file_path, const ScriptedTransform &scripted_transform) {
+    ScriptedTransformView view = scripted_transform.get_view();
+
+    CompiledScriptedPathHeader header{};
+    std::memcpy(header.magic, COMPILED_SCRIPTED_PATH_MAGIC, sizeof(header.magic));
+    header.version = COMPILED_SCRIPTED_PATH_VERSION;
+    header.endianness_check = ENDIANNESS_CHECK;
+    header.layout_signature = LAYOUT_SIGNATURE;
+    header.keyframe_count = view.keyframes.size();
+    header.segment_count = view.coef_matrices_position.size();
+    header.arc_length_sample_count = view.arc_length_samples.size();
+    header.has_rotation_quaternion = not view.coef_matrices_rotation_quaternion.empty();
+    header.ms_start_time = view.ms_start_time;
+    header.ms_end_time = view.ms_end_time;
+    header.tau_position = view.tau_position;
+    header.tau_rotation = view.tau_rotation;
+    header.tau_scale = view.tau_scale;
+
+    std::uint64_t file_size = sizeof(CompiledScriptedPathHeader);
+    header.keyframes_offset = reserve_array(view.keyframes, file_size);
+    header.coef_matrices_position_offset = reserve_array(view.coef_matrices_position, file_size);
+    header.coef_matrices_rotation_offset = reserve_array(view.coef_matrices_rotation, file_size);
+    header.coef_matrices_scale_offset = reserve_array(view.coef_matrices_scale, file_size);
+    header.coef_matrices_rotation_quaternion_offset = reserve_array(view.coef_matrices_rotation_quaternion, file_size);
+    header.cummulative_arc_lengths_position_offset = reserve_array(view.cummulative_arc_lengths_position, file_size);
+    header.arc_length_samples_offset = reserve_array(view.arc_length_samples, file_size);
+
+    std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+    if (not file.is_open()) {
+        throw std::runtime_error("couldn't open " + file_path + " for writing");
+    }
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    write_array(file, view.keyframes, header.keyframes_offset);
+    write_array(file, view.coef_matrices_position, header.coef_matrices_position_offset);
+    write_array(file, view.coef_matrices_rotation, header.coef_matrices_rotation_offset);
+    write_array(file, view.coef_matrices_scale, header.coef_matrices_scale_offset);
+    write_array(file, view.coef_matrices_rotation_quaternion, header.coef_matrices_rotation_quaternion_offset);
+    write_array(file, view.cummulative_arc_lengths_position, header.cummulative_arc_lengths_position_offset);
+    write_array(file, view.arc_length_samples, header.arc_length_samples_offset);
+
+    if (not file.good()) {
+        throw std::runtime_error("failed to write compiled scripted path " + file_path);
+    }
+}
+
+template <typename T>
+static std::span<const T> get_array(const MappedFile &mapped_file, std::uint64_t offset, std::uint64_t count) {
+    if (offset % ARRAY_ALIGNMENT != 0 or offset > mapped_file.size() or
+        count > (mapped_file.size() - offset) / sizeof(T)) {
+        throw std::runtime_error("compiled scripted path has an array outside of the file");
+    }
+    return std::span<const T>(reinterpret_cast<const T *>(mapped_file.data() + offset), count);
+}
+
+ScriptedTransform load_compiled_scripted_path(const std::string &file_path) {
+    std::shared_ptr<MappedFile> mapped_file = std::make_shared<MappedFile>(file_path);
+
+    if (mapped_file->size() < sizeof(CompiledScriptedPathHeader)) {
+        throw std::runtime_error(file_path + " is too small to be a compiled scripted path");
+    }
+
+    // mappings are page aligned so the header can be read in place
+    const CompiledScriptedPathHeader &header = *reinterpret_cast<const CompiledScriptedPathHeader *>(mapped_file->data());
+    if (std::memcmp(header.magic, COMPILED_SCRIPTED_PATH_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error(file_path + " is not a compiled scripted path");
+    }
+    if (header.version != COMPILED_SCRIPTED_PATH_VERSION or header.endianness_check != ENDIANNESS_CHECK or
+        header.layout_signature != LAYOUT_SIGNATURE) {
+        throw std::runtime_error(file_path + " was compiled for a different version or platform, recompile it");
+    }
+    // update indexes with these without checking, so a corrupt file has to be caught here
+    if (header.keyframe_count < 4 or header.segment_count != header.keyframe_count - 3 or
+        header.arc_length_sample_count == 0) {
+        throw std::runtime_error(file_path + " has inconsistent keyframe, segment or arc length sample counts");
+    }
+
+    ScriptedTransformView view;
+    view.keyframes = get_array<ScriptedTransformKeyframe>(*mapped_file, header.keyframes_offset, header.keyframe_count);
+    view.coef_matrices_position =
+        get_array<glm::mat4x3>(*mapped_file, header.coef_matrices_position_offset, header.segment_count);
+    view.coef_matrices_rotation =
+        get_array<glm::mat4x3>(*mapped_file, header.coef_matrices_rotation_offset, header.segment_count);
+    view.coef_matrices_scale =
+        get_array<glm::mat4x3>(*mapped_file, header.coef_matrices_scale_offset, header.segment_count);
+    view.coef_matrices_rotation_quaternion =
+        get_array<glm::mat4>(*mapped_file, header.coef_matrices_rotation_quaternion_offset,
+                             header.has_rotation_quaternion ? header.segment_count : 0);
+    view.cummulative_arc_lengths_position =
+        get_array<double>(*mapped_file, header.cummulative_arc_lengths_position_offset, header.segment_count + 1);
+    view.arc_length_samples =
+        get_array<ArcLengthSample>(*mapped_file, header.arc_length_samples_offset, header.arc_length_sample_count);
+    view.ms_start_time = header.ms_start_time;
+    view.ms_end_time = header.ms_end_time;
+    view.tau_position = header.tau_position;
+    view.tau_rotation = header.tau_rotation;
+    view.tau_scale = header.tau_scale;
+
+    for (std::size_t i = 0; i < view.arc_length_samples.size(); i++) {
+        const ArcLengthSample &sample = view.arc_length_samples[i];
+        if (sample.segment_index >= header.segment_count) {
+            throw std::runtime_error(file_path + " has an arc length sample on segment " +
+                                     std::to_string(sample.segment_index) + " out of " +
+                                     std::to_string(header.segment_count));
+        }
+        // the lookup is a binary search
+        if (i > 0 and not(view.arc_length_samples[i - 1].arc_length <= sample.arc_length)) {
+            throw std::runtime_error(file_path + " has arc length samples that aren't sorted");
+        }
+    }
+
+    return ScriptedTransform(view, mapped_file);
+}
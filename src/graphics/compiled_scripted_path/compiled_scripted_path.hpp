@@ -0,0 +1,56 @@
+#ifndef COMPILED_SCRIPTED_PATH_HPP
+#define COMPILED_SCRIPTED_PATH_HPP
+
+#include "sbpt_generated_includes.hpp"
+
+#include <cstdint>
+#include <string>
+
+/**
+ * a compiled scripted path is everything that a ScriptedTransform precomputes written out as is, so that loading one
+ * is a memory mapping instead of recomputing the coefficients and the arc length table
+ *
+ * the file is the header followed by the arrays it points at, every array starts at a 16 byte aligned offset and is
+ * stored in the in memory layout of the machine that compiled it, layout_signature and endianness_check catch files
+ * that were compiled somewhere with a different layout
+ */
+struct CompiledScriptedPathHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t endianness_check;
+    std::uint32_t layout_signature;
+    std::uint32_t keyframe_count;
+    std::uint32_t segment_count;
+    std::uint32_t arc_length_sample_count;
+    std::uint32_t has_rotation_quaternion;
+    double ms_start_time;
+    double ms_end_time;
+    double tau_position;
+    double tau_rotation;
+    double tau_scale;
+    std::uint64_t keyframes_offset;
+    std::uint64_t coef_matrices_position_offset;
+    std::uint64_t coef_matrices_rotation_offset;
+    std::uint64_t coef_matrices_scale_offset;
+    std::uint64_t coef_matrices_rotation_quaternion_offset;
+    std::uint64_t cummulative_arc_lengths_position_offset;
+    std::uint64_t arc_length_samples_offset;
+};
+
+const std::uint32_t COMPILED_SCRIPTED_PATH_VERSION = 1;
+
+/**
+ * reads the text description of a scripted path, a json object with the keyframes and the arguments of the
+ * ScriptedTransform constructor, see assets/scripted_paths for an example
+ */
+ScriptedTransform parse_scripted_path_description(const std::string &file_path);
+
+void write_compiled_scripted_path(const std::string &file_path, const ScriptedTransform &scripted_transform);
+
+/**
+ * memory maps the file and constructs the transform directly on top of the mapping, nothing is copied, the mapping is
+ * released once the returned transform and all of its copies are gone
+ */
+ScriptedTransform load_compiled_scripted_path(const std::string &file_path);
+
+#endif // COMPILED_SCRIPTED_PATH_HPP
@@ -0,0 +1,138 @@
+#include "incremental_depth_sorter.hpp"
+
+#include <algorithm>
+#include <array>
+
+IncrementalDepthSorter::IncrementalDepthSorter(std::size_t expected_count)
+    : num_previously_sorted{0}, num_holes{0}, insertion_sort_count{0}, radix_sort_count{0} {
+    sorted_indices.reserve(expected_count);
+    ranks.reserve(expected_count);
+}
+
+void IncrementalDepthSorter::insert(unsigned int index) {
+    if (index >= ranks.size()) {
+        ranks.resize(index + 1, REMOVED);
+    }
+    ranks[index] = sorted_indices.size();
+    sorted_indices.push_back(index);
+}
+
+void IncrementalDepthSorter::remove(unsigned int index, unsigned int moved_index) {
+    sorted_indices[ranks[index]] = REMOVED;
+    num_holes++;
+    if (moved_index != index) {
+        unsigned int moved_rank = ranks[moved_index];
+        sorted_indices[moved_rank] = index;
+        ranks[index] = moved_rank;
+    }
+    ranks[moved_index] = REMOVED;
+}
+
+std::span<const unsigned int> IncrementalDepthSorter::sort_back_to_front(std::span<const float> depths) {
+    remove_holes();
+
+    std::size_t num_indices = sorted_indices.size();
+    std::size_t num_inserted = num_indices - num_previously_sorted;
+    auto further_away = [&](unsigned int a, unsigned int b) { return depths[a] > depths[b]; };
+
+    bool coherent = num_inserted <= num_indices / 2 and try_insertion_sort(num_previously_sorted, depths);
+    if (coherent) {
+        // the new ones are few, sort them on their own and merge them in
+        auto inserted_begin = sorted_indices.begin() + num_previously_sorted;
+        std::sort(inserted_begin, sorted_indices.end(), further_away);
+        std::inplace_merge(sorted_indices.begin(), inserted_begin, sorted_indices.end(), further_away);
+        insertion_sort_count++;
+    } else {
+        radix_sort(depths);
+        radix_sort_count++;
+    }
+
+    for (std::size_t rank = 0; rank < num_indices; rank++) {
+        ranks[sorted_indices[rank]] = rank;
+    }
+    num_previously_sorted = num_indices;
+
+    return get_sorted_indices();
+}
+
+std::span<const unsigned int> IncrementalDepthSorter::get_sorted_indices() const { return sorted_indices; }
+
+std::size_t IncrementalDepthSorter::get_insertion_sort_count() const { return insertion_sort_count; }
+
+std::size_t IncrementalDepthSorter::get_radix_sort_count() const { return radix_sort_count; }
+
+void IncrementalDepthSorter::remove_holes() {
+    if (num_holes == 0) {
+        return;
+    }
+
+    std::size_t holes_before_inserted =
+        std::count(sorted_indices.begin(), sorted_indices.begin() + num_previously_sorted, REMOVED);
+    sorted_indices.erase(std::remove(sorted_indices.begin(), sorted_indices.end(), REMOVED), sorted_indices.end());
+    num_previously_sorted -= holes_before_inserted;
+    num_holes = 0;
+}
+
+bool IncrementalDepthSorter::try_insertion_sort(std::size_t end, std::span<const float> depths) {
+    std::size_t shift_budget = MAX_AVERAGE_SHIFTS * end;
+    std::size_t shifts = 0;
+
+    for (std::size_t i = 1; i < end; i++) {
+        unsigned int index = sorted_indices[i];
+        float depth = depths[index];
+        std::size_t j = i;
+        while (j > 0 and depths[sorted_indices[j - 1]] < depth) {
+            sorted_indices[j] = sorted_indices[j - 1];
+            j--;
+        }
+        sorted_indices[j] = index;
+
+        shifts += i - j;
+        if (shifts > shift_budget) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void IncrementalDepthSorter::radix_sort(std::span<const float> depths) {
+    std::size_t num_indices = sorted_indices.size();
+    if (num_indices < 2) {
+        return;
+    }
+
+    float min_depth = depths[sorted_indices[0]];
+    float max_depth = min_depth;
+    for (unsigned int index : sorted_indices) {
+        min_depth = std::min(min_depth, depths[index]);
+        max_depth = std::max(max_depth, depths[index]);
+    }
+
+    // the key grows as the depth shrinks so that an ascending sort gives back to front
+    float key_scale = max_depth > min_depth ? 65535.0f / (max_depth - min_depth) : 0.0f;
+    radix_keys.resize(num_indices);
+    for (std::size_t i = 0; i < num_indices; i++) {
+        radix_keys[i] = static_cast<std::uint16_t>((max_depth - depths[sorted_indices[i]]) * key_scale);
+    }
+
+    radix_scratch_indices.resize(num_indices);
+    radix_scratch_keys.resize(num_indices);
+
+    // two stable counting passes over the low and then the high byte
+    for (unsigned int shift = 0; shift < 16; shift += 8) {
+        std::array<std::size_t, 257> offsets{};
+        for (std::uint16_t key : radix_keys) {
+            offsets[((key >> shift) & 0xFF) + 1]++;
+        }
+        for (std::size_t bucket = 1; bucket < offsets.size(); bucket++) {
+            offsets[bucket] += offsets[bucket - 1];
+        }
+        for (std::size_t i = 0; i < num_indices; i++) {
+            std::size_t destination = offsets[(radix_keys[i] >> shift) & 0xFF]++;
+            radix_scratch_indices[destination] = sorted_indices[i];
+            radix_scratch_keys[destination] = radix_keys[i];
+        }
+        sorted_indices.swap(radix_scratch_indices);
+        radix_keys.swap(radix_scratch_keys);
+    }
+}
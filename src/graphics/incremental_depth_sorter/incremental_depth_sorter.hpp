@@ -0,0 +1,68 @@
+#ifndef INCREMENTAL_DEPTH_SORTER_HPP
+#define INCREMENTAL_DEPTH_SORTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/**
+ * keeps a list of indices ordered from the largest depth to the smallest across frames, depths of things like
+ * particles barely move from one frame to the next so the previous order is almost always nearly sorted and an
+ * insertion sort finishes it in close to linear time. when too many elements have to move the order is rebuilt with
+ * a radix sort on quantized depth instead.
+ *
+ * the indices are owned by the caller (eg slots in a particle pool), they are announced with insert and remove so
+ * that the sorter can keep their position in the order between sorts
+ */
+class IncrementalDepthSorter {
+  public:
+    explicit IncrementalDepthSorter(std::size_t expected_count = 0);
+
+    /**
+     * a new index that will be placed at the right spot on the next sort
+     */
+    void insert(unsigned int index);
+
+    /**
+     * removes index from the order, the element that was at moved_index now lives at index (swap and pop), pass the
+     * same value for both when nothing was moved
+     */
+    void remove(unsigned int index, unsigned int moved_index);
+
+    /**
+     * depths must be indexable by every index currently in the order, the returned span is valid until the next call
+     * that modifies the sorter
+     */
+    std::span<const unsigned int> sort_back_to_front(std::span<const float> depths);
+
+    std::span<const unsigned int> get_sorted_indices() const;
+
+    std::size_t get_insertion_sort_count() const;
+    std::size_t get_radix_sort_count() const;
+
+  private:
+    static constexpr unsigned int REMOVED = 0xFFFFFFFFu;
+    // insertion sort gives up once elements have moved this many places on average
+    static constexpr std::size_t MAX_AVERAGE_SHIFTS = 8;
+
+    void remove_holes();
+    bool try_insertion_sort(std::size_t end, std::span<const float> depths);
+    void radix_sort(std::span<const float> depths);
+
+    std::vector<unsigned int> sorted_indices;
+    // position of each index inside sorted_indices
+    std::vector<unsigned int> ranks;
+    // everything before this was in order after the last sort, everything from here on was inserted since
+    std::size_t num_previously_sorted;
+    std::size_t num_holes;
+
+    std::vector<unsigned int> radix_scratch_indices;
+    std::vector<std::uint16_t> radix_keys;
+    std::vector<std::uint16_t> radix_scratch_keys;
+
+    std::size_t insertion_sort_count;
+    std::size_t radix_sort_count;
+};
+
+#endif // INCREMENTAL_DEPTH_SORTER_HPP
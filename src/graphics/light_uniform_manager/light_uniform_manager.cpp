@@ -0,0 +1,147 @@
+#include "light_uniform_manager.hpp"
+
+#include <iostream>
+#include <stdexcept>
+
+LightUniformGLFunctions create_opengl_light_uniform_functions() {
+    return {
+        [](GLuint shader_program_id, const std::string &uniform_name) {
+            return glGetUniformLocation(shader_program_id, uniform_name.c_str());
+        },
+        [](GLuint shader_program_id) { glUseProgram(shader_program_id); },
+        [](GLint location, const glm::vec3 &value) { glUniform3fv(location, 1, &value[0]); },
+        [](GLint location, float value) { glUniform1f(location, value); },
+    };
+}
+
+LightUniformManager::LightUniformManager(GLuint shader_program_id, unsigned int num_point_lights,
+                                         LightUniformGLFunctions gl_functions)
+    : shader_program_id{shader_program_id}, gl_functions{std::move(gl_functions)},
+      point_light_locations(num_point_lights), view_position{0, 0, 0}, point_lights(num_point_lights),
+      view_position_dirty{true}, directional_light_dirty{true}, point_light_dirty(num_point_lights, true),
+      spot_light_dirty{true} {
+
+    auto location = [&](const std::string &uniform_name) {
+        return this->gl_functions.get_uniform_location(shader_program_id, uniform_name);
+    };
+
+    view_position_location = location("view_pos");
+    if (view_position_location == -1) {
+        std::cerr << "Warning: Uniform 'view_pos' not found!" << std::endl;
+    }
+
+    directional_light_locations = {location("dir_light.direction"), location("dir_light.ambient"),
+                                   location("dir_light.diffuse"), location("dir_light.specular")};
+
+    for (unsigned int i = 0; i < num_point_lights; i++) {
+        std::string base = "point_lights[" + std::to_string(i) + "].";
+        point_light_locations[i] = {location(base + "position"), location(base + "ambient"),
+                                    location(base + "diffuse"),  location(base + "specular"),
+                                    location(base + "constant"), location(base + "linear"),
+                                    location(base + "quadratic")};
+        // everything starts out dirty so that the first upload sends the defaults
+        dirty_point_light_indices.push_back(i);
+    }
+
+    spot_light_locations = {location("spot_light.position"), location("spot_light.direction"),
+                            location("spot_light.ambient"),  location("spot_light.diffuse"),
+                            location("spot_light.specular"), location("spot_light.constant"),
+                            location("spot_light.linear"),   location("spot_light.quadratic"),
+                            location("spot_light.cut_off"),  location("spot_light.outer_cut_off")};
+}
+
+void LightUniformManager::set_view_position(const glm::vec3 &view_position) {
+    if (this->view_position != view_position) {
+        this->view_position = view_position;
+        view_position_dirty = true;
+    }
+}
+
+void LightUniformManager::set_directional_light(const DirectionalLightAttributes &directional_light) {
+    if (not(this->directional_light == directional_light)) {
+        this->directional_light = directional_light;
+        directional_light_dirty = true;
+    }
+}
+
+void LightUniformManager::set_point_light(unsigned int point_light_index, const PointLightAttributes &point_light) {
+    if (point_light_index >= point_lights.size()) {
+        throw std::runtime_error("point light " + std::to_string(point_light_index) + " is out of range, there are " +
+                                 std::to_string(point_lights.size()));
+    }
+    if (point_lights[point_light_index] == point_light) {
+        return;
+    }
+    point_lights[point_light_index] = point_light;
+    if (not point_light_dirty[point_light_index]) {
+        point_light_dirty[point_light_index] = true;
+        dirty_point_light_indices.push_back(point_light_index);
+    }
+}
+
+void LightUniformManager::set_spot_light(const SpotLightAttributes &spot_light) {
+    if (not(this->spot_light == spot_light)) {
+        this->spot_light = spot_light;
+        spot_light_dirty = true;
+    }
+}
+
+const PointLightAttributes &LightUniformManager::get_point_light(unsigned int point_light_index) const {
+    return point_lights.at(point_light_index);
+}
+
+unsigned int LightUniformManager::get_num_point_lights() const { return point_lights.size(); }
+
+bool LightUniformManager::has_changes() const {
+    return view_position_dirty or directional_light_dirty or not dirty_point_light_indices.empty() or
+           spot_light_dirty;
+}
+
+void LightUniformManager::upload() {
+    if (not has_changes()) {
+        return;
+    }
+
+    gl_functions.use_program(shader_program_id);
+
+    if (view_position_dirty) {
+        gl_functions.set_vec3(view_position_location, view_position);
+        view_position_dirty = false;
+    }
+
+    if (directional_light_dirty) {
+        gl_functions.set_vec3(directional_light_locations.direction, directional_light.direction);
+        gl_functions.set_vec3(directional_light_locations.ambient, directional_light.ambient);
+        gl_functions.set_vec3(directional_light_locations.diffuse, directional_light.diffuse);
+        gl_functions.set_vec3(directional_light_locations.specular, directional_light.specular);
+        directional_light_dirty = false;
+    }
+
+    for (unsigned int i : dirty_point_light_indices) {
+        const PointLightLocations &locations = point_light_locations[i];
+        const PointLightAttributes &point_light = point_lights[i];
+        gl_functions.set_vec3(locations.position, point_light.position);
+        gl_functions.set_vec3(locations.ambient, point_light.ambient);
+        gl_functions.set_vec3(locations.diffuse, point_light.diffuse);
+        gl_functions.set_vec3(locations.specular, point_light.specular);
+        gl_functions.set_float(locations.constant, point_light.constant);
+        gl_functions.set_float(locations.linear, point_light.linear);
+        gl_functions.set_float(locations.quadratic, point_light.quadratic);
+        point_light_dirty[i] = false;
+    }
+    dirty_point_light_indices.clear();
+
+    if (spot_light_dirty) {
+        gl_functions.set_vec3(spot_light_locations.position, spot_light.position);
+        gl_functions.set_vec3(spot_light_locations.direction, spot_light.direction);
+        gl_functions.set_vec3(spot_light_locations.ambient, spot_light.ambient);
+        gl_functions.set_vec3(spot_light_locations.diffuse, spot_light.diffuse);
+        gl_functions.set_vec3(spot_light_locations.specular, spot_light.specular);
+        gl_functions.set_float(spot_light_locations.constant, spot_light.constant);
+        gl_functions.set_float(spot_light_locations.linear, spot_light.linear);
+        gl_functions.set_float(spot_light_locations.quadratic, spot_light.quadratic);
+        gl_functions.set_float(spot_light_locations.cut_off, spot_light.cut_off);
+        gl_functions.set_float(spot_light_locations.outer_cut_off, spot_light.outer_cut_off);
+        spot_light_dirty = false;
+    }
+}
@@ -0,0 +1,116 @@
+#ifndef LIGHT_UNIFORM_MANAGER_HPP
+#define LIGHT_UNIFORM_MANAGER_HPP
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+struct DirectionalLightAttributes {
+    glm::vec3 direction = glm::vec3(0, -1, 0);
+    glm::vec3 ambient = glm::vec3(0, 0, 0);
+    glm::vec3 diffuse = glm::vec3(0, 0, 0);
+    glm::vec3 specular = glm::vec3(0, 0, 0);
+
+    bool operator==(const DirectionalLightAttributes &other) const = default;
+};
+
+struct PointLightAttributes {
+    glm::vec3 position = glm::vec3(0, 0, 0);
+    glm::vec3 ambient = glm::vec3(0, 0, 0);
+    glm::vec3 diffuse = glm::vec3(0, 0, 0);
+    glm::vec3 specular = glm::vec3(0, 0, 0);
+    float constant = 1.0f;
+    float linear = 0.09f;
+    float quadratic = 0.032f;
+
+    bool operator==(const PointLightAttributes &other) const = default;
+};
+
+struct SpotLightAttributes {
+    glm::vec3 position = glm::vec3(0, 0, 0);
+    glm::vec3 direction = glm::vec3(0, 0, -1);
+    glm::vec3 ambient = glm::vec3(0, 0, 0);
+    glm::vec3 diffuse = glm::vec3(0, 0, 0);
+    glm::vec3 specular = glm::vec3(0, 0, 0);
+    float constant = 1.0f;
+    float linear = 0.09f;
+    float quadratic = 0.032f;
+    float cut_off = 1.0f;
+    float outer_cut_off = 1.0f;
+
+    bool operator==(const SpotLightAttributes &other) const = default;
+};
+
+/**
+ * the gl calls the light uniform manager makes, swap them out for a recording stub to check what would be sent to the
+ * driver without a context
+ */
+struct LightUniformGLFunctions {
+    std::function<GLint(GLuint shader_program_id, const std::string &uniform_name)> get_uniform_location;
+    std::function<void(GLuint shader_program_id)> use_program;
+    std::function<void(GLint location, const glm::vec3 &value)> set_vec3;
+    std::function<void(GLint location, float value)> set_float;
+};
+
+LightUniformGLFunctions create_opengl_light_uniform_functions();
+
+/**
+ * holds the light state of one shader program (view_pos, dir_light, point_lights[] and spot_light) and only talks to
+ * gl when something actually changed. every uniform location is looked up once when the manager is made, setting a
+ * light to the value it already has is free, and upload sends just the lights that changed since the last upload.
+ */
+class LightUniformManager {
+  public:
+    LightUniformManager(GLuint shader_program_id, unsigned int num_point_lights,
+                        LightUniformGLFunctions gl_functions = create_opengl_light_uniform_functions());
+
+    void set_view_position(const glm::vec3 &view_position);
+    void set_directional_light(const DirectionalLightAttributes &directional_light);
+    void set_point_light(unsigned int point_light_index, const PointLightAttributes &point_light);
+    void set_spot_light(const SpotLightAttributes &spot_light);
+
+    const PointLightAttributes &get_point_light(unsigned int point_light_index) const;
+    unsigned int get_num_point_lights() const;
+
+    bool has_changes() const;
+
+    /**
+     * binds the program and sends whatever changed, does nothing at all when nothing did
+     */
+    void upload();
+
+  private:
+    struct DirectionalLightLocations {
+        GLint direction, ambient, diffuse, specular;
+    };
+    struct PointLightLocations {
+        GLint position, ambient, diffuse, specular, constant, linear, quadratic;
+    };
+    struct SpotLightLocations {
+        GLint position, direction, ambient, diffuse, specular, constant, linear, quadratic, cut_off, outer_cut_off;
+    };
+
+    GLuint shader_program_id;
+    LightUniformGLFunctions gl_functions;
+
+    GLint view_position_location;
+    DirectionalLightLocations directional_light_locations;
+    std::vector<PointLightLocations> point_light_locations;
+    SpotLightLocations spot_light_locations;
+
+    glm::vec3 view_position;
+    DirectionalLightAttributes directional_light;
+    std::vector<PointLightAttributes> point_lights;
+    SpotLightAttributes spot_light;
+
+    bool view_position_dirty;
+    bool directional_light_dirty;
+    std::vector<unsigned int> dirty_point_light_indices;
+    std::vector<char> point_light_dirty;
+    bool spot_light_dirty;
+};
+
+#endif // LIGHT_UNIFORM_MANAGER_HPP
@@ -0,0 +1,89 @@
+#include "ltw_matrix_slots.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+LtwMatrixSlots::LtwMatrixSlots(unsigned int capacity)
+    : matrices(capacity, glm::mat4(1.0f)), allocated(capacity, false), dirty(capacity, false) {
+    // lowest slots first so that live matrices stay packed at the front and the dirty ranges stay short
+    free_slots.reserve(capacity);
+    for (unsigned int slot = capacity; slot > 0; slot--) {
+        free_slots.push_back(slot - 1);
+    }
+    dirty_slots.reserve(capacity);
+}
+
+unsigned int LtwMatrixSlots::allocate() {
+    if (free_slots.empty()) {
+        throw std::runtime_error("all " + std::to_string(matrices.size()) + " ltw matrix slots are in use");
+    }
+    unsigned int slot = free_slots.back();
+    free_slots.pop_back();
+    allocated[slot] = true;
+    return slot;
+}
+
+void LtwMatrixSlots::release(unsigned int slot) {
+    if (slot >= matrices.size() or not allocated[slot]) {
+        throw std::runtime_error("ltw matrix slot " + std::to_string(slot) + " is not allocated");
+    }
+    allocated[slot] = false;
+    // so that whoever gets it next doesn't inherit a stale transform
+    if (matrices[slot] != glm::mat4(1.0f)) {
+        matrices[slot] = glm::mat4(1.0f);
+        mark_dirty(slot);
+    }
+    free_slots.push_back(slot);
+}
+
+void LtwMatrixSlots::set(unsigned int slot, const glm::mat4 &ltw_matrix) {
+    if (slot >= matrices.size() or not allocated[slot]) {
+        throw std::runtime_error("ltw matrix slot " + std::to_string(slot) + " is not allocated");
+    }
+    matrices[slot] = ltw_matrix;
+    mark_dirty(slot);
+}
+
+const glm::mat4 &LtwMatrixSlots::get(unsigned int slot) const { return matrices.at(slot); }
+
+unsigned int LtwMatrixSlots::get_capacity() const { return matrices.size(); }
+
+unsigned int LtwMatrixSlots::get_allocated_count() const { return matrices.size() - free_slots.size(); }
+
+const glm::mat4 *LtwMatrixSlots::data() const { return matrices.data(); }
+
+bool LtwMatrixSlots::has_dirty_slots() const { return not dirty_slots.empty(); }
+
+void LtwMatrixSlots::flush_dirty_ranges(
+    const std::function<void(unsigned int first_slot, unsigned int num_slots)> &upload_range) {
+    if (dirty_slots.empty()) {
+        return;
+    }
+
+    std::sort(dirty_slots.begin(), dirty_slots.end());
+
+    unsigned int range_start = dirty_slots[0];
+    unsigned int range_end = dirty_slots[0] + 1;
+    for (std::size_t i = 1; i < dirty_slots.size(); i++) {
+        unsigned int slot = dirty_slots[i];
+        if (slot - range_end > MAX_MERGE_GAP) {
+            upload_range(range_start, range_end - range_start);
+            range_start = slot;
+        }
+        range_end = slot + 1;
+    }
+    upload_range(range_start, range_end - range_start);
+
+    for (unsigned int slot : dirty_slots) {
+        dirty[slot] = false;
+    }
+    dirty_slots.clear();
+}
+
+void LtwMatrixSlots::mark_dirty(unsigned int slot) {
+    if (not dirty[slot]) {
+        dirty[slot] = true;
+        dirty_slots.push_back(slot);
+    }
+}
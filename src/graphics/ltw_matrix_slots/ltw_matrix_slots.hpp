@@ -0,0 +1,55 @@
+#ifndef LTW_MATRIX_SLOTS_HPP
+#define LTW_MATRIX_SLOTS_HPP
+
+#include <glm/glm.hpp>
+
+#include <functional>
+#include <vector>
+
+/**
+ * the cpu side of the local to world matrix array that the shaders index with their ltw index. slots are handed out
+ * and recycled here so that nobody has to pick an index by hand, and every write is recorded so that only the ranges
+ * that changed since the last flush need to be sent to the gpu. nothing in here touches opengl.
+ */
+class LtwMatrixSlots {
+  public:
+    explicit LtwMatrixSlots(unsigned int capacity);
+
+    /**
+     * the slot starts out as an identity matrix, throws when every slot is taken
+     */
+    unsigned int allocate();
+    void release(unsigned int slot);
+
+    void set(unsigned int slot, const glm::mat4 &ltw_matrix);
+    const glm::mat4 &get(unsigned int slot) const;
+
+    unsigned int get_capacity() const;
+    unsigned int get_allocated_count() const;
+
+    // all capacity matrices, in slot order
+    const glm::mat4 *data() const;
+
+    bool has_dirty_slots() const;
+
+    /**
+     * calls upload_range for every run of slots written since the last flush, runs separated by only a few clean
+     * slots are merged because one slightly bigger upload is cheaper than two calls. the matrices are read from data()
+     */
+    void flush_dirty_ranges(const std::function<void(unsigned int first_slot, unsigned int num_slots)> &upload_range);
+
+  private:
+    // clean slots that may sit inside one merged upload
+    static constexpr unsigned int MAX_MERGE_GAP = 8;
+
+    void mark_dirty(unsigned int slot);
+
+    std::vector<glm::mat4> matrices;
+    std::vector<char> allocated;
+    // the next allocate pops from the back
+    std::vector<unsigned int> free_slots;
+    std::vector<char> dirty;
+    std::vector<unsigned int> dirty_slots;
+};
+
+#endif // LTW_MATRIX_SLOTS_HPP
@@ -0,0 +1,126 @@
+#include "ltw_matrix_uploader.hpp"
+
+#include <cstring>
+
+LtwMatrixUploader::LtwMatrixUploader(LtwMatrixSlots &ltw_matrix_slots, GLuint uniform_block_binding,
+                                     bool use_persistent_mapped_ring)
+    : ltw_matrix_slots{ltw_matrix_slots}, uniform_block_binding{uniform_block_binding}, buffer_gl_name{0},
+      matrices_size{ltw_matrix_slots.get_capacity() * sizeof(glm::mat4)}, bytes_uploaded_last_frame{0},
+      using_persistent_mapped_ring{false}, ring_region_size{0}, mapped_ring{nullptr}, current_ring_region{0},
+      ring_region_fences{} {
+
+    glGenBuffers(1, &buffer_gl_name);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer_gl_name);
+
+#ifdef GL_MAP_PERSISTENT_BIT
+    if (use_persistent_mapped_ring and glBufferStorage != nullptr) {
+        GLint offset_alignment = 256;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offset_alignment);
+        ring_region_size = (matrices_size + offset_alignment - 1) / offset_alignment * offset_alignment;
+
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_UNIFORM_BUFFER, ring_region_size * NUM_RING_REGIONS, nullptr, flags);
+        mapped_ring = static_cast<unsigned char *>(
+            glMapBufferRange(GL_UNIFORM_BUFFER, 0, ring_region_size * NUM_RING_REGIONS, flags));
+
+        if (mapped_ring != nullptr) {
+            using_persistent_mapped_ring = true;
+            for (unsigned int region = 0; region < NUM_RING_REGIONS; region++) {
+                std::memcpy(mapped_ring + region * ring_region_size, ltw_matrix_slots.data(), matrices_size);
+            }
+            glBindBufferRange(GL_UNIFORM_BUFFER, uniform_block_binding, buffer_gl_name, 0, matrices_size);
+        } else {
+            // storage is immutable once allocated, so fall back with a fresh buffer
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+            glDeleteBuffers(1, &buffer_gl_name);
+            glGenBuffers(1, &buffer_gl_name);
+            glBindBuffer(GL_UNIFORM_BUFFER, buffer_gl_name);
+        }
+    }
+#endif
+
+    if (not using_persistent_mapped_ring) {
+        glBufferData(GL_UNIFORM_BUFFER, matrices_size, ltw_matrix_slots.data(), GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, uniform_block_binding, buffer_gl_name);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    // everything up to now is already on the gpu
+    ltw_matrix_slots.flush_dirty_ranges([](unsigned int first_slot, unsigned int num_slots) {});
+}
+
+LtwMatrixUploader::~LtwMatrixUploader() {
+    for (GLsync &fence : ring_region_fences) {
+        if (fence != nullptr) {
+            glDeleteSync(fence);
+        }
+    }
+    if (using_persistent_mapped_ring) {
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer_gl_name);
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+    glDeleteBuffers(1, &buffer_gl_name);
+}
+
+void LtwMatrixUploader::upload() {
+    bytes_uploaded_last_frame = 0;
+    if (using_persistent_mapped_ring) {
+        upload_into_next_ring_region();
+    } else {
+        upload_with_buffer_sub_data();
+    }
+}
+
+bool LtwMatrixUploader::is_using_persistent_mapped_ring() const { return using_persistent_mapped_ring; }
+
+std::size_t LtwMatrixUploader::get_bytes_uploaded_last_frame() const { return bytes_uploaded_last_frame; }
+
+void LtwMatrixUploader::upload_with_buffer_sub_data() {
+    if (not ltw_matrix_slots.has_dirty_slots()) {
+        return;
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer_gl_name);
+    ltw_matrix_slots.flush_dirty_ranges([&](unsigned int first_slot, unsigned int num_slots) {
+        glBufferSubData(GL_UNIFORM_BUFFER, first_slot * sizeof(glm::mat4), num_slots * sizeof(glm::mat4),
+                        ltw_matrix_slots.data() + first_slot);
+        bytes_uploaded_last_frame += num_slots * sizeof(glm::mat4);
+    });
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void LtwMatrixUploader::upload_into_next_ring_region() {
+#ifdef GL_MAP_PERSISTENT_BIT
+    ltw_matrix_slots.flush_dirty_ranges([&](unsigned int first_slot, unsigned int num_slots) {
+        for (auto &pending_ranges : ring_region_pending_ranges) {
+            pending_ranges.emplace_back(first_slot, num_slots);
+        }
+    });
+
+    // everything drawn since the last upload read the current region
+    ring_region_fences[current_ring_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    current_ring_region = (current_ring_region + 1) % NUM_RING_REGIONS;
+
+    GLsync &fence = ring_region_fences[current_ring_region];
+    if (fence != nullptr) {
+        // with three regions the gpu is almost always done with this one already
+        while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    unsigned char *region = mapped_ring + current_ring_region * ring_region_size;
+    auto &pending_ranges = ring_region_pending_ranges[current_ring_region];
+    for (const auto &[first_slot, num_slots] : pending_ranges) {
+        std::memcpy(region + first_slot * sizeof(glm::mat4), ltw_matrix_slots.data() + first_slot,
+                    num_slots * sizeof(glm::mat4));
+        bytes_uploaded_last_frame += num_slots * sizeof(glm::mat4);
+    }
+    pending_ranges.clear();
+
+    glBindBufferRange(GL_UNIFORM_BUFFER, uniform_block_binding, buffer_gl_name,
+                      current_ring_region * ring_region_size, matrices_size);
+#endif
+}
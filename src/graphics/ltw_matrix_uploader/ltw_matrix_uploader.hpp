@@ -0,0 +1,59 @@
+#ifndef LTW_MATRIX_UPLOADER_HPP
+#define LTW_MATRIX_UPLOADER_HPP
+
+#include "sbpt_generated_includes.hpp"
+
+#include <glad/glad.h>
+
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * owns the uniform buffer behind the ltw matrices and sends it only what changed in an LtwMatrixSlots.
+ *
+ * by default every dirty range goes through glBufferSubData. when persistent mapping is asked for and the context has
+ * buffer storage (gl 4.4 or ARB_buffer_storage) the buffer is instead split into a ring of regions that stay mapped,
+ * every frame writes into the region the gpu finished with longest ago and binds that one, with a fence per region so
+ * that the cpu never writes into a region that is still being read and the driver never has to stall on an update.
+ */
+class LtwMatrixUploader {
+  public:
+    LtwMatrixUploader(LtwMatrixSlots &ltw_matrix_slots, GLuint uniform_block_binding,
+                      bool use_persistent_mapped_ring = false);
+    ~LtwMatrixUploader();
+
+    LtwMatrixUploader(const LtwMatrixUploader &) = delete;
+    LtwMatrixUploader &operator=(const LtwMatrixUploader &) = delete;
+
+    /**
+     * call once per frame after the matrices were written and before anything that reads them is drawn
+     */
+    void upload();
+
+    bool is_using_persistent_mapped_ring() const;
+    std::size_t get_bytes_uploaded_last_frame() const;
+
+  private:
+    static constexpr unsigned int NUM_RING_REGIONS = 3;
+
+    void upload_with_buffer_sub_data();
+    void upload_into_next_ring_region();
+
+    LtwMatrixSlots &ltw_matrix_slots;
+    GLuint uniform_block_binding;
+    GLuint buffer_gl_name;
+    std::size_t matrices_size;
+    std::size_t bytes_uploaded_last_frame;
+
+    bool using_persistent_mapped_ring;
+    std::size_t ring_region_size;
+    unsigned char *mapped_ring;
+    unsigned int current_ring_region;
+    std::array<GLsync, NUM_RING_REGIONS> ring_region_fences;
+    // every region has to catch up on the ranges that changed while the other regions were being written
+    std::array<std::vector<std::pair<unsigned int, unsigned int>>, NUM_RING_REGIONS> ring_region_pending_ranges;
+};
+
+#endif // LTW_MATRIX_UPLOADER_HPP
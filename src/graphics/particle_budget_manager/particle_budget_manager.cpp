@@ -0,0 +1,183 @@
+#include "particle_budget_manager.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+ParticleBudgetManager::ParticleBudgetManager(unsigned int global_particle_budget, double cpu_time_budget_sec)
+    : global_particle_budget{global_particle_budget}, cpu_time_budget_sec{cpu_time_budget_sec},
+      effective_particle_budget{global_particle_budget} {}
+
+unsigned int ParticleBudgetManager::register_emitter(const std::string &name, ParticleEmitterBudget &budget,
+                                                     float priority) {
+    emitters.push_back({name, &budget, priority, 1.0f, 0.0});
+    return emitters.size() - 1;
+}
+
+void ParticleBudgetManager::unregister_emitter(unsigned int emitter_id) {
+    RegisteredEmitter &emitter = emitters.at(emitter_id);
+    if (emitter.budget != nullptr) {
+        // hand the emitter back unthrottled
+        *emitter.budget = ParticleEmitterBudget{};
+    }
+    emitter.budget = nullptr;
+}
+
+void ParticleBudgetManager::set_priority(unsigned int emitter_id, float priority) {
+    emitters.at(emitter_id).priority = priority;
+}
+
+void ParticleBudgetManager::set_screen_importance(unsigned int emitter_id, float screen_importance) {
+    emitters.at(emitter_id).screen_importance = screen_importance;
+}
+
+void ParticleBudgetManager::set_global_particle_budget(unsigned int global_particle_budget) {
+    this->global_particle_budget = global_particle_budget;
+}
+
+void ParticleBudgetManager::set_cpu_time_budget_sec(double cpu_time_budget_sec) {
+    this->cpu_time_budget_sec = cpu_time_budget_sec;
+}
+
+void ParticleBudgetManager::rebalance() {
+    double total_cost_sec = 0;
+    unsigned int total_alive = 0;
+    float total_demand = 0;
+    for (RegisteredEmitter &emitter : emitters) {
+        if (emitter.budget == nullptr) {
+            continue;
+        }
+        emitter.average_update_cost_sec +=
+            COST_SMOOTHING * (emitter.budget->last_update_cost_sec - emitter.average_update_cost_sec);
+        total_cost_sec += emitter.average_update_cost_sec;
+        total_alive += emitter.budget->alive_particle_count;
+        total_demand += emitter.budget->particle_demand;
+    }
+
+    // the cpu budget becomes a particle count through the measured cost of a single particle
+    float particle_budget = global_particle_budget;
+    if (total_alive > 0 and total_cost_sec > 0) {
+        double cost_per_particle_sec = total_cost_sec / total_alive;
+        particle_budget = std::min<double>(particle_budget, cpu_time_budget_sec / cost_per_particle_sec);
+    }
+    effective_particle_budget = static_cast<unsigned int>(particle_budget);
+
+    bool over_budget = total_demand > particle_budget;
+    std::vector<float> allowances = compute_allowances(particle_budget);
+
+    for (std::size_t i = 0; i < emitters.size(); i++) {
+        ParticleEmitterBudget *budget = emitters[i].budget;
+        if (budget == nullptr) {
+            continue;
+        }
+
+        float target_spawn_rate_scale = 1.0f;
+        float target_life_span_scale = 1.0f;
+        unsigned int alive_particle_cap = std::numeric_limits<unsigned int>::max();
+
+        if (over_budget and budget->particle_demand > allowances[i]) {
+            // the steady state count is spawn rate times life span, so the cut is split evenly between the two
+            float fraction = allowances[i] / budget->particle_demand;
+            target_life_span_scale = std::max(MIN_LIFE_SPAN_SCALE, std::sqrt(fraction));
+            target_spawn_rate_scale = fraction / target_life_span_scale;
+            alive_particle_cap = static_cast<unsigned int>(std::ceil(allowances[i]));
+        }
+
+        budget->spawn_rate_scale += SCALE_SMOOTHING * (target_spawn_rate_scale - budget->spawn_rate_scale);
+        budget->life_span_scale += SCALE_SMOOTHING * (target_life_span_scale - budget->life_span_scale);
+        budget->alive_particle_cap = alive_particle_cap;
+    }
+}
+
+unsigned int ParticleBudgetManager::get_total_alive_particle_count() const {
+    unsigned int total_alive = 0;
+    for (const RegisteredEmitter &emitter : emitters) {
+        if (emitter.budget != nullptr) {
+            total_alive += emitter.budget->alive_particle_count;
+        }
+    }
+    return total_alive;
+}
+
+double ParticleBudgetManager::get_total_average_update_cost_sec() const {
+    double total_cost_sec = 0;
+    for (const RegisteredEmitter &emitter : emitters) {
+        if (emitter.budget != nullptr) {
+            total_cost_sec += emitter.average_update_cost_sec;
+        }
+    }
+    return total_cost_sec;
+}
+
+unsigned int ParticleBudgetManager::get_effective_particle_budget() const { return effective_particle_budget; }
+
+std::vector<ParticleEmitterStats> ParticleBudgetManager::get_emitter_stats() const {
+    std::vector<ParticleEmitterStats> stats;
+    for (const RegisteredEmitter &emitter : emitters) {
+        if (emitter.budget == nullptr) {
+            continue;
+        }
+        stats.push_back({emitter.name, emitter.priority, emitter.screen_importance, emitter.budget->particle_demand,
+                         emitter.budget->alive_particle_count, emitter.budget->alive_particle_cap,
+                         emitter.budget->spawn_rate_scale, emitter.budget->life_span_scale,
+                         emitter.average_update_cost_sec});
+    }
+    return stats;
+}
+
+std::vector<float> ParticleBudgetManager::compute_allowances(float particle_budget) const {
+    // water filling: split what is left by weight, emitters that want less than their share keep only their demand
+    // and the rest goes around again
+    std::vector<float> allowances(emitters.size(), 0.0f);
+    std::vector<bool> satisfied(emitters.size(), false);
+    float remaining_budget = particle_budget;
+
+    for (std::size_t i = 0; i < emitters.size(); i++) {
+        if (emitters[i].budget == nullptr or emitters[i].budget->particle_demand <= 0) {
+            satisfied[i] = true;
+        }
+    }
+
+    bool changed = true;
+    while (changed and remaining_budget > 0) {
+        changed = false;
+
+        float total_weight = 0;
+        for (std::size_t i = 0; i < emitters.size(); i++) {
+            if (not satisfied[i]) {
+                total_weight += std::max(emitters[i].priority * emitters[i].screen_importance, 1e-4f);
+            }
+        }
+        if (total_weight == 0) {
+            break;
+        }
+
+        float budget_this_round = remaining_budget;
+        for (std::size_t i = 0; i < emitters.size(); i++) {
+            if (satisfied[i]) {
+                continue;
+            }
+            float weight = std::max(emitters[i].priority * emitters[i].screen_importance, 1e-4f);
+            float share = budget_this_round * weight / total_weight;
+            float wanted = emitters[i].budget->particle_demand - allowances[i];
+            if (wanted <= share) {
+                allowances[i] += wanted;
+                remaining_budget -= wanted;
+                satisfied[i] = true;
+                changed = true;
+            }
+        }
+
+        if (not changed) {
+            // nobody can be fully served, split what is left by weight and stop
+            for (std::size_t i = 0; i < emitters.size(); i++) {
+                if (not satisfied[i]) {
+                    float weight = std::max(emitters[i].priority * emitters[i].screen_importance, 1e-4f);
+                    allowances[i] += remaining_budget * weight / total_weight;
+                }
+            }
+        }
+    }
+
+    return allowances;
+}
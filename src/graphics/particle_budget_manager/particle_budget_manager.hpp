@@ -0,0 +1,94 @@
+#ifndef PARTICLE_BUDGET_MANAGER_HPP
+#define PARTICLE_BUDGET_MANAGER_HPP
+
+#include <limits>
+#include <string>
+#include <vector>
+
+/**
+ * the link between one emitter and the budget manager, the emitter owns it and both sides write their half of it
+ */
+struct ParticleEmitterBudget {
+    // written by the manager, read by the emitter
+    float spawn_rate_scale = 1.0f;
+    float life_span_scale = 1.0f;
+    unsigned int alive_particle_cap = std::numeric_limits<unsigned int>::max();
+
+    // written by the emitter every update, read by the manager
+    unsigned int alive_particle_count = 0;
+    unsigned int max_particles = 0;
+    // how many particles the emitter would settle at if it was left alone, zero when it has stopped emitting
+    float particle_demand = 0.0f;
+    double last_update_cost_sec = 0.0;
+};
+
+struct ParticleEmitterStats {
+    std::string name;
+    float priority;
+    float screen_importance;
+    float particle_demand;
+    unsigned int alive_particle_count;
+    unsigned int alive_particle_cap;
+    float spawn_rate_scale;
+    float life_span_scale;
+    double average_update_cost_sec;
+};
+
+/**
+ * bounds the total number of particles and the cpu time spent updating them across every registered emitter. while
+ * the summed demand fits in the budget nothing is touched, once it doesn't the budget is handed out by priority times
+ * screen importance, and every emitter that gets less than it wants has its spawn rate and life span scaled down and
+ * its particle count capped. the scales move gradually so that a heavy moment thins the smoke out instead of popping
+ * it.
+ *
+ * call rebalance once per frame after the emitters have updated, the new scales take effect on their next update
+ */
+class ParticleBudgetManager {
+  public:
+    ParticleBudgetManager(unsigned int global_particle_budget, double cpu_time_budget_sec);
+
+    /**
+     * budget must outlive the registration, the returned id is used for the other per emitter calls
+     */
+    unsigned int register_emitter(const std::string &name, ParticleEmitterBudget &budget, float priority = 1.0f);
+    void unregister_emitter(unsigned int emitter_id);
+
+    void set_priority(unsigned int emitter_id, float priority);
+    // roughly how much of the screen the emitter covers or how close it is to the camera, 1 is fully important
+    void set_screen_importance(unsigned int emitter_id, float screen_importance);
+
+    void set_global_particle_budget(unsigned int global_particle_budget);
+    void set_cpu_time_budget_sec(double cpu_time_budget_sec);
+
+    void rebalance();
+
+    unsigned int get_total_alive_particle_count() const;
+    double get_total_average_update_cost_sec() const;
+    // the particle budget after taking the cpu time budget into account
+    unsigned int get_effective_particle_budget() const;
+    std::vector<ParticleEmitterStats> get_emitter_stats() const;
+
+  private:
+    struct RegisteredEmitter {
+        std::string name;
+        ParticleEmitterBudget *budget;
+        float priority;
+        float screen_importance;
+        double average_update_cost_sec;
+    };
+
+    // how quickly the scales and the measured costs follow their targets, per rebalance
+    static constexpr float SCALE_SMOOTHING = 0.2f;
+    static constexpr double COST_SMOOTHING = 0.1;
+    // below this the smoke stops reading as smoke, the cap does the rest
+    static constexpr float MIN_LIFE_SPAN_SCALE = 0.25f;
+
+    std::vector<float> compute_allowances(float particle_budget) const;
+
+    unsigned int global_particle_budget;
+    double cpu_time_budget_sec;
+    unsigned int effective_particle_budget;
+    std::vector<RegisteredEmitter> emitters;
+};
+
+#endif // PARTICLE_BUDGET_MANAGER_HPP
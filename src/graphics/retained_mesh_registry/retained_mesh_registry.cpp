@@ -0,0 +1 @@
+#include "retained_mesh_registry.hpp"
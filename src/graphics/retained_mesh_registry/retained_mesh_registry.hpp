@@ -0,0 +1,146 @@
+#ifndef RETAINED_MESH_REGISTRY_HPP
+#define RETAINED_MESH_REGISTRY_HPP
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * keeps the full set of per vertex attributes that a shader batcher's queue_draw wants for every registered mesh, so
+ * that they are built once at load time instead of every frame. the object id doubles as the handle, and because the
+ * same id is always submitted with the same vectors the batcher can keep what it has already uploaded for it.
+ *
+ * ShaderBatcher is one of the generated shader batchers, eg
+ * batcher.texture_packer_rigged_and_animated_cwl_v_transformation_ubos_1024_with_textures_and_multiple_lights_shader_batcher
+ */
+template <typename ShaderBatcher> class RetainedMeshRegistry {
+  public:
+    explicit RetainedMeshRegistry(ShaderBatcher &shader_batcher) : shader_batcher(shader_batcher) {}
+
+    /**
+     * registers a mesh that went through the texture packer, eg IVPNTexturePacked or IVPNTPRigged, if it has bone data
+     * that is kept as well, otherwise it gets no bone influence
+     */
+    template <typename PackedMesh> void register_mesh(const PackedMesh &mesh, unsigned int ltw_matrix_slot) {
+        std::vector<glm::ivec4> bone_ids;
+        std::vector<glm::vec4> bone_weights;
+        if constexpr (requires { mesh.bone_data; }) {
+            bone_ids.reserve(mesh.bone_data.size());
+            bone_weights.reserve(mesh.bone_data.size());
+            for (const auto &vertex_bone_data : mesh.bone_data) {
+                bone_ids.emplace_back(static_cast<int>(vertex_bone_data.indices_of_bones_that_affect_this_vertex[0]),
+                                      static_cast<int>(vertex_bone_data.indices_of_bones_that_affect_this_vertex[1]),
+                                      static_cast<int>(vertex_bone_data.indices_of_bones_that_affect_this_vertex[2]),
+                                      static_cast<int>(vertex_bone_data.indices_of_bones_that_affect_this_vertex[3]));
+                bone_weights.emplace_back(vertex_bone_data.weight_value_of_this_vertex_wrt_bone[0],
+                                          vertex_bone_data.weight_value_of_this_vertex_wrt_bone[1],
+                                          vertex_bone_data.weight_value_of_this_vertex_wrt_bone[2],
+                                          vertex_bone_data.weight_value_of_this_vertex_wrt_bone[3]);
+            }
+        }
+        register_mesh(mesh.id, ltw_matrix_slot, mesh.indices, mesh.xyz_positions, mesh.normals,
+                      mesh.packed_texture_coordinates, mesh.packed_texture_index, std::move(bone_ids),
+                      std::move(bone_weights));
+    }
+
+    /**
+     * empty bone ids and weights mean the mesh is not affected by any bone
+     */
+    void register_mesh(unsigned int object_id, unsigned int ltw_matrix_slot, std::vector<unsigned int> indices,
+                       std::vector<glm::vec3> xyz_positions, std::vector<glm::vec3> normals,
+                       std::vector<glm::vec2> packed_texture_coordinates, int packed_texture_index,
+                       std::vector<glm::ivec4> bone_ids = {}, std::vector<glm::vec4> bone_weights = {}) {
+        std::size_t num_vertices = xyz_positions.size();
+        if (normals.size() != num_vertices or packed_texture_coordinates.size() != num_vertices) {
+            throw std::runtime_error("mesh " + std::to_string(object_id) + " has mismatched vertex attribute counts");
+        }
+        if (bone_ids.empty() and bone_weights.empty()) {
+            bone_ids.assign(num_vertices, glm::ivec4(0, 0, 0, 0));
+            bone_weights.assign(num_vertices, glm::vec4(0, 0, 0, 0));
+        }
+        if (bone_ids.size() != num_vertices or bone_weights.size() != num_vertices) {
+            throw std::runtime_error("mesh " + std::to_string(object_id) + " has mismatched bone data counts");
+        }
+
+        RetainedMesh &mesh = meshes[object_id];
+        mesh.ltw_matrix_slot = ltw_matrix_slot;
+        mesh.indices = std::move(indices);
+        mesh.ltw_indices.assign(num_vertices, ltw_matrix_slot);
+        mesh.bone_ids = std::move(bone_ids);
+        mesh.bone_weights = std::move(bone_weights);
+        mesh.packed_texture_indices.assign(num_vertices, packed_texture_index);
+        mesh.packed_texture_coordinates = std::move(packed_texture_coordinates);
+        mesh.normals = std::move(normals);
+        mesh.xyz_positions = std::move(xyz_positions);
+    }
+
+    void unregister_mesh(unsigned int object_id) { meshes.erase(object_id); }
+
+    bool is_registered(unsigned int object_id) const { return meshes.find(object_id) != meshes.end(); }
+
+    /**
+     * rewrites the ltw indices in place, only needed when the mesh moves to another matrix slot
+     */
+    void set_ltw_matrix_slot(unsigned int object_id, unsigned int ltw_matrix_slot) {
+        RetainedMesh &mesh = get_mesh(object_id);
+        if (mesh.ltw_matrix_slot != ltw_matrix_slot) {
+            mesh.ltw_matrix_slot = ltw_matrix_slot;
+            std::fill(mesh.ltw_indices.begin(), mesh.ltw_indices.end(), ltw_matrix_slot);
+        }
+    }
+
+    unsigned int get_ltw_matrix_slot(unsigned int object_id) const { return get_mesh(object_id).ltw_matrix_slot; }
+
+    /**
+     * queues the mesh for this frame, nothing is allocated or rebuilt here
+     */
+    void draw(unsigned int object_id) {
+        const RetainedMesh &mesh = get_mesh(object_id);
+        ++draw_count;
+        shader_batcher.queue_draw(object_id, mesh.indices, mesh.ltw_indices, mesh.bone_ids, mesh.bone_weights,
+                                  mesh.packed_texture_indices, mesh.packed_texture_coordinates, mesh.normals,
+                                  mesh.xyz_positions);
+    }
+
+    /**
+     * how many draws were queued since the last reset, reset it once per frame to get draws per frame
+     */
+    std::size_t get_draw_count() const { return draw_count; }
+    void reset_draw_count() { draw_count = 0; }
+
+  private:
+    struct RetainedMesh {
+        unsigned int ltw_matrix_slot;
+        std::vector<unsigned int> indices;
+        std::vector<unsigned int> ltw_indices;
+        std::vector<glm::ivec4> bone_ids;
+        std::vector<glm::vec4> bone_weights;
+        std::vector<int> packed_texture_indices;
+        std::vector<glm::vec2> packed_texture_coordinates;
+        std::vector<glm::vec3> normals;
+        std::vector<glm::vec3> xyz_positions;
+    };
+
+    const RetainedMesh &get_mesh(unsigned int object_id) const {
+        auto it = meshes.find(object_id);
+        if (it == meshes.end()) {
+            throw std::runtime_error("no mesh registered with object id " + std::to_string(object_id));
+        }
+        return it->second;
+    }
+
+    RetainedMesh &get_mesh(unsigned int object_id) {
+        return const_cast<RetainedMesh &>(std::as_const(*this).get_mesh(object_id));
+    }
+
+    ShaderBatcher &shader_batcher;
+    std::unordered_map<unsigned int, RetainedMesh> meshes;
+    std::size_t draw_count = 0;
+};
+
+#endif // RETAINED_MESH_REGISTRY_HPP
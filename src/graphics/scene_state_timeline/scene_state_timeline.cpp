@@ -0,0 +1,194 @@
+#include "scene_state_timeline.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+using json = nlohmann::json;
+
+static SceneStateSlotType get_slot_type(const json &value, const std::string &key) {
+    if (value.is_boolean()) {
+        return SceneStateSlotType::BOOL;
+    }
+    if (value.is_number()) {
+        return SceneStateSlotType::NUMBER;
+    }
+    if (value.is_string()) {
+        return SceneStateSlotType::STRING;
+    }
+    throw std::runtime_error("scene state key " + key + " has a value that isn't a bool, number or string");
+}
+
+SceneStateTimeline::SceneStateTimeline(const std::string &scene_script_json_path, unsigned int snapshot_interval)
+    : key_to_slot{}, initial_state{}, deltas{}, delta_bools{}, delta_numbers{}, delta_strings{},
+      snapshot_interval{std::max(snapshot_interval, 1u)}, snapshots{}, current_state{}, delta_cursor{0},
+      ms_last_time{-std::numeric_limits<double>::infinity()}, slots_changed_by_last_advance{} {
+
+    std::ifstream file(scene_script_json_path);
+    if (not file.is_open()) {
+        throw std::runtime_error("couldn't open scene script " + scene_script_json_path);
+    }
+
+    json scene_script = json::parse(file);
+
+    for (const auto &[key, value] : scene_script.at("state").items()) {
+        SceneStateSlotType type = get_slot_type(value, key);
+        switch (type) {
+        case SceneStateSlotType::BOOL:
+            key_to_slot[key] = {type, static_cast<unsigned int>(initial_state.bools.size())};
+            initial_state.bools.push_back(value.get<bool>());
+            break;
+        case SceneStateSlotType::NUMBER:
+            key_to_slot[key] = {type, static_cast<unsigned int>(initial_state.numbers.size())};
+            initial_state.numbers.push_back(value.get<double>());
+            break;
+        case SceneStateSlotType::STRING:
+            key_to_slot[key] = {type, static_cast<unsigned int>(initial_state.strings.size())};
+            initial_state.strings.push_back(value.get<std::string>());
+            break;
+        }
+    }
+
+    for (const json &change : scene_script.at("changes")) {
+        double ms_time = change.at("time");
+        for (const auto &[key, value] : change.at("change").items()) {
+            SceneStateSlot slot = get_slot_of_type(key, get_slot_type(value, key));
+            switch (slot.type) {
+            case SceneStateSlotType::BOOL:
+                deltas.push_back({ms_time, slot, static_cast<unsigned int>(delta_bools.size())});
+                delta_bools.push_back(value.get<bool>());
+                break;
+            case SceneStateSlotType::NUMBER:
+                deltas.push_back({ms_time, slot, static_cast<unsigned int>(delta_numbers.size())});
+                delta_numbers.push_back(value.get<double>());
+                break;
+            case SceneStateSlotType::STRING:
+                deltas.push_back({ms_time, slot, static_cast<unsigned int>(delta_strings.size())});
+                delta_strings.push_back(value.get<std::string>());
+                break;
+            }
+        }
+    }
+
+    // stable so that changes listed later at the same time still win
+    std::stable_sort(deltas.begin(), deltas.end(),
+                     [](const SceneStateDelta &a, const SceneStateDelta &b) { return a.ms_time < b.ms_time; });
+
+    SceneState state = initial_state;
+    snapshots.push_back(state);
+    for (std::size_t i = 0; i < deltas.size(); i++) {
+        apply_delta(deltas[i], state);
+        if ((i + 1) % this->snapshot_interval == 0) {
+            snapshots.push_back(state);
+        }
+    }
+
+    current_state = initial_state;
+}
+
+SceneStateSlot SceneStateTimeline::get_slot(const std::string &key) const {
+    auto it = key_to_slot.find(key);
+    if (it == key_to_slot.end()) {
+        throw std::runtime_error("scene state has no key " + key);
+    }
+    return it->second;
+}
+
+SceneStateSlot SceneStateTimeline::get_slot_of_type(const std::string &key, SceneStateSlotType type) const {
+    SceneStateSlot slot = get_slot(key);
+    if (slot.type != type) {
+        throw std::runtime_error("scene state key " + key + " is used with a different type than it was declared with");
+    }
+    return slot;
+}
+
+unsigned int SceneStateTimeline::get_bool_slot(const std::string &key) const {
+    return get_slot_of_type(key, SceneStateSlotType::BOOL).index;
+}
+
+unsigned int SceneStateTimeline::get_number_slot(const std::string &key) const {
+    return get_slot_of_type(key, SceneStateSlotType::NUMBER).index;
+}
+
+unsigned int SceneStateTimeline::get_string_slot(const std::string &key) const {
+    return get_slot_of_type(key, SceneStateSlotType::STRING).index;
+}
+
+void SceneStateTimeline::advance(double ms_curr_time) {
+    slots_changed_by_last_advance.clear();
+
+    if (ms_curr_time < ms_last_time) {
+        // seeking doesn't replay the deltas in between, so the slots that changed are the ones that differ now
+        SceneState previous_state = current_state;
+        seek(ms_curr_time);
+        for (unsigned int i = 0; i < current_state.bools.size(); i++) {
+            if (current_state.bools[i] != previous_state.bools[i]) {
+                slots_changed_by_last_advance.push_back({SceneStateSlotType::BOOL, i});
+            }
+        }
+        for (unsigned int i = 0; i < current_state.numbers.size(); i++) {
+            if (current_state.numbers[i] != previous_state.numbers[i]) {
+                slots_changed_by_last_advance.push_back({SceneStateSlotType::NUMBER, i});
+            }
+        }
+        for (unsigned int i = 0; i < current_state.strings.size(); i++) {
+            if (current_state.strings[i] != previous_state.strings[i]) {
+                slots_changed_by_last_advance.push_back({SceneStateSlotType::STRING, i});
+            }
+        }
+        return;
+    }
+    ms_last_time = ms_curr_time;
+
+    while (delta_cursor < deltas.size() and deltas[delta_cursor].ms_time <= ms_curr_time) {
+        apply_delta(deltas[delta_cursor], current_state);
+        slots_changed_by_last_advance.push_back(deltas[delta_cursor].slot);
+        delta_cursor++;
+    }
+}
+
+void SceneStateTimeline::seek(double ms_time) {
+    current_state = get_state_at(ms_time);
+    delta_cursor = count_deltas_until(ms_time);
+    ms_last_time = ms_time;
+}
+
+const SceneState &SceneStateTimeline::get_current_state() const { return current_state; }
+
+const std::vector<SceneStateSlot> &SceneStateTimeline::get_slots_changed_by_last_advance() const {
+    return slots_changed_by_last_advance;
+}
+
+SceneState SceneStateTimeline::get_state_at(double ms_time) const {
+    std::size_t delta_count = count_deltas_until(ms_time);
+    std::size_t snapshot_index = delta_count / snapshot_interval;
+
+    SceneState state = snapshots[snapshot_index];
+    for (std::size_t i = snapshot_index * snapshot_interval; i < delta_count; i++) {
+        apply_delta(deltas[i], state);
+    }
+    return state;
+}
+
+std::size_t SceneStateTimeline::count_deltas_until(double ms_time) const {
+    auto it = std::upper_bound(deltas.begin(), deltas.end(), ms_time,
+                               [](double value, const SceneStateDelta &delta) { return value < delta.ms_time; });
+    return it - deltas.begin();
+}
+
+void SceneStateTimeline::apply_delta(const SceneStateDelta &delta, SceneState &state) const {
+    switch (delta.slot.type) {
+    case SceneStateSlotType::BOOL:
+        state.bools[delta.slot.index] = delta_bools[delta.value_index];
+        break;
+    case SceneStateSlotType::NUMBER:
+        state.numbers[delta.slot.index] = delta_numbers[delta.value_index];
+        break;
+    case SceneStateSlotType::STRING:
+        state.strings[delta.slot.index] = delta_strings[delta.value_index];
+        break;
+    }
+}
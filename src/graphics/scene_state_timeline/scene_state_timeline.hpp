@@ -0,0 +1,93 @@
+#ifndef SCENE_STATE_TIMELINE_HPP
+#define SCENE_STATE_TIMELINE_HPP
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class SceneStateSlotType {
+    BOOL,
+    NUMBER,
+    STRING,
+};
+
+/**
+ * a key of the state, index is the position of its value in the array of its type in SceneState
+ */
+struct SceneStateSlot {
+    SceneStateSlotType type;
+    unsigned int index;
+};
+
+/**
+ * the value of every key at one point in time, stored densely per type, index with the slots from the timeline
+ */
+struct SceneState {
+    std::vector<char> bools; // char instead of bool so that elements are addressable
+    std::vector<double> numbers;
+    std::vector<std::string> strings;
+};
+
+struct SceneStateDelta {
+    double ms_time;
+    SceneStateSlot slot;
+    unsigned int value_index; // into the delta value array of the slot's type
+};
+
+/**
+ * compiles a scene script, an initial "state" map plus a time ordered list of "changes" (see assets/scene_script.json),
+ * into typed slots and a flat array of deltas
+ *
+ * advance applies deltas with a forward cursor for regular playback, get_state_at reconstructs the state at any time
+ * from the closest snapshot (taken every snapshot_interval deltas) so scrubbing never replays from the start
+ */
+class SceneStateTimeline {
+  public:
+    explicit SceneStateTimeline(const std::string &scene_script_json_path, unsigned int snapshot_interval = 64);
+
+    SceneStateSlot get_slot(const std::string &key) const;
+    unsigned int get_bool_slot(const std::string &key) const;
+    unsigned int get_number_slot(const std::string &key) const;
+    unsigned int get_string_slot(const std::string &key) const;
+
+    /**
+     * applies every delta up to and including ms_curr_time, going backwards in time seeks instead and reports the
+     * slots whose value differs from before the seek as changed
+     */
+    void advance(double ms_curr_time);
+
+    /**
+     * sets the current state to the state at ms_time, O(log n + snapshot_interval)
+     */
+    void seek(double ms_time);
+
+    const SceneState &get_current_state() const;
+    const std::vector<SceneStateSlot> &get_slots_changed_by_last_advance() const;
+
+    SceneState get_state_at(double ms_time) const;
+
+  private:
+    SceneStateSlot get_slot_of_type(const std::string &key, SceneStateSlotType type) const;
+    // returns the number of deltas whose time is at or before ms_time
+    std::size_t count_deltas_until(double ms_time) const;
+    void apply_delta(const SceneStateDelta &delta, SceneState &state) const;
+
+    std::unordered_map<std::string, SceneStateSlot> key_to_slot;
+    SceneState initial_state;
+
+    std::vector<SceneStateDelta> deltas; // sorted by time
+    std::vector<char> delta_bools;
+    std::vector<double> delta_numbers;
+    std::vector<std::string> delta_strings;
+
+    unsigned int snapshot_interval;
+    std::vector<SceneState> snapshots; // snapshots[i] is the state after the first i * snapshot_interval deltas
+
+    SceneState current_state;
+    std::size_t delta_cursor; // first delta that hasn't been applied to current_state
+    double ms_last_time;
+    std::vector<SceneStateSlot> slots_changed_by_last_advance;
+};
+
+#endif // SCENE_STATE_TIMELINE_HPP
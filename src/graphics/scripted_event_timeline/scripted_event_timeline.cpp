@@ -0,0 +1,234 @@
+#include "scripted_event_timeline.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+using json = nlohmann::json;
+
+ScriptedEventTimeline::ScriptedEventTimeline(const std::string &scripted_events_json_path)
+    : event_name_to_id{}, event_names{}, callbacks{}, edges{}, edge_cursor{0}, active_counts{} {
+
+    std::ifstream file(scripted_events_json_path);
+    if (not file.is_open()) {
+        throw std::runtime_error("couldn't open scripted events " + scripted_events_json_path);
+    }
+
+    json scripted_events = json::parse(file);
+
+    for (const json &scripted_event : scripted_events.at("events")) {
+        unsigned int event_id = intern_event_name(scripted_event.at("name"));
+        std::string type = scripted_event.at("type");
+
+        if (type == "playthrough") {
+            edges.push_back({scripted_event.at("time"), event_id, ScriptedEventEdgeType::INSTANT});
+        } else if (type == "toggle") {
+            double start_time_sec = scripted_event.at("start_time");
+            double end_time_sec = scripted_event.at("end_time");
+            if (end_time_sec <= start_time_sec) {
+                edges.push_back({start_time_sec, event_id, ScriptedEventEdgeType::INSTANT});
+            } else {
+                edges.push_back({start_time_sec, event_id, ScriptedEventEdgeType::START});
+                edges.push_back({end_time_sec, event_id, ScriptedEventEdgeType::END});
+            }
+        } else {
+            throw std::runtime_error("unknown scripted event type " + type + " in " + scripted_events_json_path);
+        }
+    }
+
+    // at equal times toggles end before others start, so back to back toggles of the same event stay consistent
+    std::stable_sort(edges.begin(), edges.end(), [](const ScriptedEventEdge &a, const ScriptedEventEdge &b) {
+        if (a.time_sec != b.time_sec) {
+            return a.time_sec < b.time_sec;
+        }
+        return a.type < b.type;
+    });
+
+    build_active_toggle_checkpoints();
+}
+
+unsigned int ScriptedEventTimeline::intern_event_name(const std::string &event_name) {
+    auto it = event_name_to_id.find(event_name);
+    if (it != event_name_to_id.end()) {
+        return it->second;
+    }
+
+    unsigned int event_id = event_names.size();
+    event_name_to_id.emplace(event_name, event_id);
+    event_names.push_back(event_name);
+    callbacks.emplace_back();
+    active_counts.push_back(0);
+    return event_id;
+}
+
+const std::string &ScriptedEventTimeline::get_event_name(unsigned int event_id) const { return event_names[event_id]; }
+
+std::size_t ScriptedEventTimeline::get_event_count() const { return event_names.size(); }
+
+std::vector<unsigned int> ScriptedEventTimeline::get_event_ids_in_firing_order() const {
+    std::vector<bool> seen(event_names.size(), false);
+    std::vector<unsigned int> event_ids;
+    for (const ScriptedEventEdge &edge : edges) {
+        if (not seen[edge.event_id]) {
+            seen[edge.event_id] = true;
+            event_ids.push_back(edge.event_id);
+        }
+    }
+    return event_ids;
+}
+
+double ScriptedEventTimeline::get_end_time_sec() const { return edges.empty() ? 0.0 : edges.back().time_sec; }
+
+void ScriptedEventTimeline::bind_callback(unsigned int event_id, std::function<void(bool, bool)> callback) {
+    callbacks[event_id] = callback;
+}
+
+void ScriptedEventTimeline::bind_callbacks(
+    const std::unordered_map<std::string, std::function<void(bool, bool)>> &event_callbacks) {
+    for (const auto &[event_name, callback] : event_callbacks) {
+        bind_callback(intern_event_name(event_name), callback);
+    }
+}
+
+void ScriptedEventTimeline::run_scripted_events(double curr_time_sec) {
+    while (edge_cursor < edges.size() and edges[edge_cursor].time_sec <= curr_time_sec) {
+        const ScriptedEventEdge &edge = edges[edge_cursor];
+        edge_cursor++;
+
+        // an overlapped toggle is already on, so only the first start and the last end reach the callback
+        bool turns_on_or_off = true;
+        if (edge.type == ScriptedEventEdgeType::START) {
+            turns_on_or_off = active_counts[edge.event_id]++ == 0;
+        } else if (edge.type == ScriptedEventEdgeType::END) {
+            turns_on_or_off = --active_counts[edge.event_id] == 0;
+        }
+        if (turns_on_or_off) {
+            fire_edge(edge);
+        }
+    }
+}
+
+void ScriptedEventTimeline::seek(double target_time_sec) {
+    // the first edge at or after the target, everything before it counts as fired
+    auto target_edge = std::lower_bound(
+        edges.begin(), edges.end(), target_time_sec,
+        [](const ScriptedEventEdge &edge, double time_sec) { return edge.time_sec < time_sec; });
+    std::size_t target_edge_cursor = target_edge - edges.begin();
+
+    std::vector<ActiveToggle> active_now = get_active_toggles_before_edge(edge_cursor);
+    std::vector<ActiveToggle> active_at_target = get_active_toggles_before_edge(target_edge_cursor);
+    edge_cursor = target_edge_cursor;
+    for (const ActiveToggle &active_toggle : active_now) {
+        active_counts[active_toggle.event_id] = 0;
+    }
+    for (const ActiveToggle &active_toggle : active_at_target) {
+        active_counts[active_toggle.event_id] = active_toggle.count;
+    }
+
+    // both are sorted by event id, so the differences fall out of one merge
+    std::vector<unsigned int> entering_event_ids;
+    auto now_it = active_now.begin();
+    auto target_it = active_at_target.begin();
+    while (now_it != active_now.end() or target_it != active_at_target.end()) {
+        if (target_it == active_at_target.end() or
+            (now_it != active_now.end() and now_it->event_id < target_it->event_id)) {
+            fire_edge({target_time_sec, now_it->event_id, ScriptedEventEdgeType::END});
+            ++now_it;
+        } else if (now_it == active_now.end() or target_it->event_id < now_it->event_id) {
+            entering_event_ids.push_back(target_it->event_id);
+            ++target_it;
+        } else {
+            ++now_it;
+            ++target_it;
+        }
+    }
+
+    // exits go first, the same as toggles that end and start at the same time
+    for (unsigned int event_id : entering_event_ids) {
+        fire_edge({target_time_sec, event_id, ScriptedEventEdgeType::START});
+    }
+}
+
+std::vector<ActiveToggle> ScriptedEventTimeline::get_active_toggles() const {
+    return get_active_toggles_before_edge(edge_cursor);
+}
+
+void ScriptedEventTimeline::build_active_toggle_checkpoints() {
+    active_toggle_checkpoint_entries.clear();
+    active_toggle_checkpoint_offsets.clear();
+
+    std::vector<unsigned int> active_counts(event_names.size(), 0);
+    std::vector<unsigned int> active_event_ids;
+    for (std::size_t edge_index = 0; edge_index < edges.size(); edge_index++) {
+        if (edge_index % ACTIVE_TOGGLE_CHECKPOINT_INTERVAL == 0) {
+            std::sort(active_event_ids.begin(), active_event_ids.end());
+            active_toggle_checkpoint_offsets.push_back(active_toggle_checkpoint_entries.size());
+            for (unsigned int event_id : active_event_ids) {
+                active_toggle_checkpoint_entries.push_back({event_id, active_counts[event_id]});
+            }
+        }
+
+        const ScriptedEventEdge &edge = edges[edge_index];
+        if (edge.type == ScriptedEventEdgeType::START and active_counts[edge.event_id]++ == 0) {
+            active_event_ids.push_back(edge.event_id);
+        } else if (edge.type == ScriptedEventEdgeType::END and --active_counts[edge.event_id] == 0) {
+            active_event_ids.erase(std::find(active_event_ids.begin(), active_event_ids.end(), edge.event_id));
+        }
+    }
+    active_toggle_checkpoint_offsets.push_back(active_toggle_checkpoint_entries.size());
+}
+
+std::vector<ActiveToggle> ScriptedEventTimeline::get_active_toggles_before_edge(std::size_t edge_index) const {
+    if (edges.empty()) {
+        return {};
+    }
+
+    std::size_t checkpoint = std::min(edge_index / ACTIVE_TOGGLE_CHECKPOINT_INTERVAL,
+                                      active_toggle_checkpoint_offsets.size() - 2);
+    std::vector<ActiveToggle> active_toggles(
+        active_toggle_checkpoint_entries.begin() + active_toggle_checkpoint_offsets[checkpoint],
+        active_toggle_checkpoint_entries.begin() + active_toggle_checkpoint_offsets[checkpoint + 1]);
+
+    // replay the few edges between the checkpoint and edge_index
+    for (std::size_t i = checkpoint * ACTIVE_TOGGLE_CHECKPOINT_INTERVAL; i < edge_index; i++) {
+        const ScriptedEventEdge &edge = edges[i];
+        if (edge.type == ScriptedEventEdgeType::INSTANT) {
+            continue;
+        }
+        auto it = std::lower_bound(
+            active_toggles.begin(), active_toggles.end(), edge.event_id,
+            [](const ActiveToggle &active_toggle, unsigned int event_id) { return active_toggle.event_id < event_id; });
+        bool found = it != active_toggles.end() and it->event_id == edge.event_id;
+        if (edge.type == ScriptedEventEdgeType::START) {
+            if (found) {
+                it->count++;
+            } else {
+                active_toggles.insert(it, {edge.event_id, 1});
+            }
+        } else if (found and --it->count == 0) {
+            active_toggles.erase(it);
+        }
+    }
+    return active_toggles;
+}
+
+void ScriptedEventTimeline::fire_edge(const ScriptedEventEdge &edge) {
+    const std::function<void(bool, bool)> &callback = callbacks[edge.event_id];
+    if (not callback) {
+        return;
+    }
+
+    switch (edge.type) {
+    case ScriptedEventEdgeType::START:
+        callback(true, false);
+        break;
+    case ScriptedEventEdgeType::END:
+        callback(false, true);
+        break;
+    case ScriptedEventEdgeType::INSTANT:
+        callback(true, true);
+        break;
+    }
+}
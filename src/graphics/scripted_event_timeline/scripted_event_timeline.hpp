@@ -0,0 +1,106 @@
+#ifndef SCRIPTED_EVENT_TIMELINE_HPP
+#define SCRIPTED_EVENT_TIMELINE_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class ScriptedEventEdgeType {
+    END,     // last call of a toggle event
+    START,   // first call of a toggle event
+    INSTANT, // a playthrough event, first and last call at once
+};
+
+struct ScriptedEventEdge {
+    double time_sec;
+    unsigned int event_id;
+    ScriptedEventEdgeType type;
+};
+
+/**
+ * a toggle event that is on, count is how many of its toggles overlap at that point
+ */
+struct ActiveToggle {
+    unsigned int event_id;
+    unsigned int count;
+};
+
+/**
+ * loads the same scripted events json as ScriptedEvent, but compiles it into a single time sorted array of edges with
+ * event names interned to dense ids, callbacks are bound once by id and every call of run_scripted_events only touches
+ * the edges that fire
+ *
+ * a toggle event calls its callback with first_call = true when it starts and with last_call = true when it ends, a
+ * playthrough event calls it once with both set. toggles of the same event can overlap, they are counted so the
+ * callback only sees the first start and the last end, both when playing forward and when seeking
+ */
+class ScriptedEventTimeline {
+  public:
+    explicit ScriptedEventTimeline(const std::string &scripted_events_json_path);
+
+    /**
+     * returns the id of the event with this name, names that don't appear in the timeline get an id too so that
+     * callbacks for them can still be bound
+     */
+    unsigned int intern_event_name(const std::string &event_name);
+    const std::string &get_event_name(unsigned int event_id) const;
+    std::size_t get_event_count() const;
+
+    /**
+     * every event that appears in the timeline once, ordered by when it first fires, good for loading whatever the
+     * events need in the order it will be needed
+     */
+    std::vector<unsigned int> get_event_ids_in_firing_order() const;
+
+    /**
+     * the time of the last edge, 0 for an empty timeline
+     */
+    double get_end_time_sec() const;
+
+    void bind_callback(unsigned int event_id, std::function<void(bool, bool)> callback);
+    void bind_callbacks(const std::unordered_map<std::string, std::function<void(bool, bool)>> &event_callbacks);
+
+    /**
+     * fires every edge that happened since the last call, time only moves forward here
+     */
+    void run_scripted_events(double curr_time_sec);
+
+    /**
+     * jumps to target_time_sec in either direction without replaying what is in between. toggles that are on now but
+     * not at the target get callback(false, true), then the ones that are on at the target but not now get
+     * callback(true, false), playthrough events in between are skipped. edges at exactly target_time_sec are left
+     * unfired so that run_scripted_events(target_time_sec) right after fires them, eg to preview a playthrough.
+     *
+     * this is a binary search plus a replay from the nearest checkpoint, so it doesn't depend on how far the jump is
+     */
+    void seek(double target_time_sec);
+
+    /**
+     * the toggles that are on as of the edges that have fired so far, sorted by event id
+     */
+    std::vector<ActiveToggle> get_active_toggles() const;
+
+  private:
+    void fire_edge(const ScriptedEventEdge &edge);
+    void build_active_toggle_checkpoints();
+    std::vector<ActiveToggle> get_active_toggles_before_edge(std::size_t edge_index) const;
+
+    // a checkpoint of the active toggles is stored every this many edges
+    static constexpr std::size_t ACTIVE_TOGGLE_CHECKPOINT_INTERVAL = 64;
+
+    std::unordered_map<std::string, unsigned int> event_name_to_id;
+    std::vector<std::string> event_names;
+    std::vector<std::function<void(bool, bool)>> callbacks; // indexed by event id
+    std::vector<ScriptedEventEdge> edges;                   // sorted by time
+    std::size_t edge_cursor;                                // first edge that hasn't fired yet
+    std::vector<unsigned int> active_counts;                // indexed by event id, toggles on before edge_cursor
+
+    // checkpoint i holds the toggles that are on before edge i * ACTIVE_TOGGLE_CHECKPOINT_INTERVAL fires, its entries
+    // are active_toggle_checkpoint_entries[active_toggle_checkpoint_offsets[i], active_toggle_checkpoint_offsets[i + 1])
+    std::vector<ActiveToggle> active_toggle_checkpoint_entries;
+    std::vector<std::size_t> active_toggle_checkpoint_offsets;
+};
+
+#endif // SCRIPTED_EVENT_TIMELINE_HPP
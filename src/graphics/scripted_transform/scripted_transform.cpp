@@ -1,15 +1,94 @@
 #include "scripted_transform.hpp"
 
+#include <algorithm>
+#include <cmath>
+
+// past this depth a sample is accepted regardless of its error, this only happens on degenerate segments
+const int MAX_ARC_LENGTH_SUBDIVISION_DEPTH = 12;
+
+// what the regular constructor computes, the transform itself only sees it through spans
+struct OwnedScriptedTransformData {
+    std::vector<ScriptedTransformKeyframe> keyframes;
+    std::vector<glm::mat4x3> coef_matrices_position;
+    std::vector<glm::mat4x3> coef_matrices_rotation;
+    std::vector<glm::mat4x3> coef_matrices_scale;
+    std::vector<glm::mat4> coef_matrices_rotation_quaternion;
+    std::vector<double> cummulative_arc_lengths_position;
+    std::vector<ArcLengthSample> arc_length_samples;
+};
+
+static double compute_speed(const glm::mat4x3 &coef_matrix, double t) {
+    // derivative of coef_matrix * (1, t, t^2, t^3)
+    double dxdt = coef_matrix[1][0] + 2 * coef_matrix[2][0] * t + 3 * coef_matrix[3][0] * t * t;
+    double dydt = coef_matrix[1][1] + 2 * coef_matrix[2][1] * t + 3 * coef_matrix[3][1] * t * t;
+    double dzdt = coef_matrix[1][2] + 2 * coef_matrix[2][2] * t + 3 * coef_matrix[3][2] * t * t;
+    return std::sqrt(dxdt * dxdt + dydt * dydt + dzdt * dzdt);
+}
+
+static glm::vec4 compute_rotation_quaternion(const glm::vec3 &rotation) {
+    // going through Transform makes the quaternion agree with however it interprets the euler angles
+    Transform rotation_only_transform;
+    rotation_only_transform.position = glm::vec3(0);
+    rotation_only_transform.rotation = rotation;
+    rotation_only_transform.scale = glm::vec3(1);
+    glm::quat quaternion = glm::normalize(glm::quat_cast(glm::mat3(rotation_only_transform.get_transform_matrix())));
+    return glm::vec4(quaternion.x, quaternion.y, quaternion.z, quaternion.w);
+}
+
+/**
+ * adaptive simpson quadrature over [t_start, t_end] of the segment, an interval is accepted as a single sample of the
+ * inverse arc length table once its length estimate is accurate and the speed over it is close enough to constant that
+ * mapping arc length linearly onto t inside of it keeps the speed within arc_length_tolerance of the true speed
+ */
+static void append_arc_length_samples(const glm::mat4x3 &coef_matrix, unsigned int segment_index, double t_start,
+                                      double t_end, double speed_start, double speed_mid, double speed_end,
+                                      double length_estimate, double arc_length_tolerance, int depth,
+                                      double &cummulative_arc_length,
+                                      std::vector<ArcLengthSample> &arc_length_samples) {
+    double t_mid = (t_start + t_end) / 2.0;
+    double speed_left_mid = compute_speed(coef_matrix, (t_start + t_mid) / 2.0);
+    double speed_right_mid = compute_speed(coef_matrix, (t_mid + t_end) / 2.0);
+
+    double left_length = (t_mid - t_start) * (speed_start + 4 * speed_left_mid + speed_mid) / 6.0;
+    double right_length = (t_end - t_mid) * (speed_mid + 4 * speed_right_mid + speed_end) / 6.0;
+    double refined_length = left_length + right_length;
+
+    double length_error = std::abs(refined_length - length_estimate) / 15.0;
+    double mean_speed = refined_length / (t_end - t_start);
+    double max_speed_deviation = std::max({std::abs(speed_start - mean_speed), std::abs(speed_left_mid - mean_speed),
+                                           std::abs(speed_mid - mean_speed), std::abs(speed_right_mid - mean_speed),
+                                           std::abs(speed_end - mean_speed)});
+
+    bool accurate_enough = length_error <= arc_length_tolerance * refined_length and
+                           max_speed_deviation <= arc_length_tolerance * mean_speed;
+
+    if (accurate_enough or depth >= MAX_ARC_LENGTH_SUBDIVISION_DEPTH or refined_length <= 0.0) {
+        cummulative_arc_length += refined_length + (refined_length - length_estimate) / 15.0;
+        arc_length_samples.push_back({cummulative_arc_length, t_start, t_end, segment_index});
+        return;
+    }
+
+    append_arc_length_samples(coef_matrix, segment_index, t_start, t_mid, speed_start, speed_left_mid, speed_mid,
+                              left_length, arc_length_tolerance, depth + 1, cummulative_arc_length,
+                              arc_length_samples);
+    append_arc_length_samples(coef_matrix, segment_index, t_mid, t_end, speed_mid, speed_right_mid, speed_end,
+                              right_length, arc_length_tolerance, depth + 1, cummulative_arc_length,
+                              arc_length_samples);
+}
+
 ScriptedTransform::ScriptedTransform(std::vector<ScriptedTransformKeyframe> keyframes, double ms_start_time,
-                                     double ms_end_time, double tau_position, double tau_rotation, double tau_scale)
-    : transform{}, keyframes{keyframes}, coef_matrices_position{}, coef_matrices_rotation{}, coef_matrices_scale{},
-      cummulative_arc_lengths_position{}, cummulative_arc_lengths_rotation{}, cummulative_arc_lengths_scale{},
-      ms_start_time{ms_start_time}, ms_end_time{ms_end_time} {
+                                     double ms_end_time, double tau_position, double tau_rotation, double tau_scale,
+                                     double arc_length_tolerance, bool use_quaternion_rotation)
+    : transform{}, storage{}, ms_start_time{ms_start_time}, ms_end_time{ms_end_time}, tau_position{tau_position},
+      tau_rotation{tau_rotation}, tau_scale{tau_scale}, arc_length_sample_cursor{0} {
 
     if (keyframes.size() < 4) {
         throw std::runtime_error("ScriptedTransform needs at least 4 control points!");
     }
 
+    std::shared_ptr<OwnedScriptedTransformData> data = std::make_shared<OwnedScriptedTransformData>();
+    data->keyframes = keyframes;
+
     // clang-format off
     glm::mat4 basis_matrix_position = glm::mat4(               0,                1,                    0,             0,
                                                    -tau_position,                0,         tau_position,             0,
@@ -26,11 +105,19 @@ ScriptedTransform::ScriptedTransform(std::vector<ScriptedTransformKeyframe> keyf
     // clang-format on
 
     double cummulative_arc_length_position = 0.0;
-    double cummulative_arc_length_rotation = 0.0;
-    double cummulative_arc_length_scale = 0.0;
-    cummulative_arc_lengths_position.push_back(cummulative_arc_length_position);
-    cummulative_arc_lengths_rotation.push_back(cummulative_arc_length_rotation);
-    cummulative_arc_lengths_scale.push_back(cummulative_arc_length_scale);
+    data->cummulative_arc_lengths_position.push_back(cummulative_arc_length_position);
+
+    std::vector<glm::vec4> rotation_quaternions;
+    if (use_quaternion_rotation) {
+        for (const ScriptedTransformKeyframe &keyframe : keyframes) {
+            glm::vec4 quaternion = compute_rotation_quaternion(keyframe.rotation);
+            // q and -q are the same rotation, keep neighbours in the same hemisphere so we take the short way around
+            if (not rotation_quaternions.empty() and glm::dot(quaternion, rotation_quaternions.back()) < 0) {
+                quaternion = -quaternion;
+            }
+            rotation_quaternions.push_back(quaternion);
+        }
+    }
 
     for (int i = 1; i < keyframes.size() - 2; i++) {
         // clang-format off
@@ -51,26 +138,77 @@ ScriptedTransform::ScriptedTransform(std::vector<ScriptedTransformKeyframe> keyf
         glm::mat4x3 coef_matrix_position = control_matrix_position * basis_matrix_position;
         glm::mat4x3 coef_matrix_rotation = control_matrix_rotation * basis_matrix_rotation;
         glm::mat4x3 coef_matrix_scale = control_matrix_scale * basis_matrix_scale;
-        coef_matrices_position.push_back(coef_matrix_position);
-        coef_matrices_rotation.push_back(coef_matrix_rotation);
-        coef_matrices_scale.push_back(coef_matrix_scale);
+        data->coef_matrices_position.push_back(coef_matrix_position);
+        data->coef_matrices_rotation.push_back(coef_matrix_rotation);
+        data->coef_matrices_scale.push_back(coef_matrix_scale);
+
+        if (use_quaternion_rotation) {
+            glm::mat4 control_matrix_rotation_quaternion =
+                glm::mat4(rotation_quaternions[i - 1], rotation_quaternions[i + 0], rotation_quaternions[i + 1],
+                          rotation_quaternions[i + 2]);
+            data->coef_matrices_rotation_quaternion.push_back(control_matrix_rotation_quaternion * basis_matrix_rotation);
+        }
 
-        double t = 0.0;
-        double dt = 0.01;
-        while (t < 1.0) {
-            double dxdt = 3 * coef_matrix_position[0][3] * t * t + 2 * coef_matrix_position[0][2] * t + coef_matrix_position[0][1];
-            double dydt = 3 * coef_matrix_position[1][3] * t * t + 2 * coef_matrix_position[1][2] * t + coef_matrix_position[1][1];
-            double dzdt = 3 * coef_matrix_position[2][3] * t * t + 2 * coef_matrix_position[2][2] * t + coef_matrix_position[2][1];
+        double speed_start = compute_speed(coef_matrix_position, 0.0);
+        double speed_mid = compute_speed(coef_matrix_position, 0.5);
+        double speed_end = compute_speed(coef_matrix_position, 1.0);
+        double length_estimate = (speed_start + 4 * speed_mid + speed_end) / 6.0;
+        append_arc_length_samples(coef_matrix_position, i - 1, 0.0, 1.0, speed_start, speed_mid, speed_end,
+                                  length_estimate, arc_length_tolerance, 0, cummulative_arc_length_position,
+                                  data->arc_length_samples);
 
-            cummulative_arc_length_position += glm::sqrt(dxdt * dxdt + dydt * dydt + dzdt * dzdt) * dt;
+        data->cummulative_arc_lengths_position.push_back(cummulative_arc_length_position);
+    }
 
-            t += dt;
-        }
+    // the parameter shadows the member
+    this->keyframes = data->keyframes;
+    coef_matrices_position = data->coef_matrices_position;
+    coef_matrices_rotation = data->coef_matrices_rotation;
+    coef_matrices_scale = data->coef_matrices_scale;
+    coef_matrices_rotation_quaternion = data->coef_matrices_rotation_quaternion;
+    cummulative_arc_lengths_position = data->cummulative_arc_lengths_position;
+    arc_length_samples = data->arc_length_samples;
+    storage = data;
+}
 
-        cummulative_arc_lengths_position.push_back(cummulative_arc_length_position);
+ScriptedTransform::ScriptedTransform(const ScriptedTransformView &view, std::shared_ptr<const void> storage)
+    : transform{}, storage{storage}, keyframes{view.keyframes}, coef_matrices_position{view.coef_matrices_position},
+      coef_matrices_rotation{view.coef_matrices_rotation}, coef_matrices_scale{view.coef_matrices_scale},
+      coef_matrices_rotation_quaternion{view.coef_matrices_rotation_quaternion},
+      cummulative_arc_lengths_position{view.cummulative_arc_lengths_position},
+      arc_length_samples{view.arc_length_samples}, ms_start_time{view.ms_start_time}, ms_end_time{view.ms_end_time},
+      tau_position{view.tau_position}, tau_rotation{view.tau_rotation}, tau_scale{view.tau_scale},
+      arc_length_sample_cursor{0} {
+
+    if (keyframes.size() < 4) {
+        throw std::runtime_error("ScriptedTransform needs at least 4 control points!");
+    }
+
+    std::size_t segment_count = keyframes.size() - 3;
+    bool valid_rotation_quaternion =
+        coef_matrices_rotation_quaternion.empty() or coef_matrices_rotation_quaternion.size() == segment_count;
+    if (coef_matrices_position.size() != segment_count or coef_matrices_rotation.size() != segment_count or
+        coef_matrices_scale.size() != segment_count or not valid_rotation_quaternion or
+        cummulative_arc_lengths_position.size() != segment_count + 1 or arc_length_samples.empty()) {
+        throw std::runtime_error("ScriptedTransform was given inconsistent precomputed data!");
     }
 }
 
+ScriptedTransformView ScriptedTransform::get_view() const {
+    return {keyframes,
+            coef_matrices_position,
+            coef_matrices_rotation,
+            coef_matrices_scale,
+            coef_matrices_rotation_quaternion,
+            cummulative_arc_lengths_position,
+            arc_length_samples,
+            ms_start_time,
+            ms_end_time,
+            tau_position,
+            tau_rotation,
+            tau_scale};
+}
+
 void ScriptedTransform::update(double ms_curr_time) {
     if (ms_curr_time <= ms_start_time) {
         transform.position = keyframes[1].position;
@@ -86,17 +224,94 @@ void ScriptedTransform::update(double ms_curr_time) {
         return;
     }
 
+    std::size_t i;
+    float t;
+    find_segment_and_t(ms_curr_time, i, t);
+
+    transform.position = coef_matrices_position[i] * glm::vec4(1, t, t * t, t * t * t);
+    transform.rotation = coef_matrices_rotation[i] * glm::vec4(1, t, t * t, t * t * t); // keyframes[i + 1].rotation + t * (keyframes[i + 2].rotation - keyframes[i + 1].rotation);
+    transform.scale = coef_matrices_scale[i] * glm::vec4(1, t, t * t, t * t * t); // keyframes[i + 1].scale + t * (keyframes[i + 2].scale - keyframes[i + 1].scale);
+}
+
+void ScriptedTransform::update(double ms_curr_time, glm::mat4 &transform_matrix) {
+    if (coef_matrices_rotation_quaternion.empty()) {
+        throw std::runtime_error("ScriptedTransform needs use_quaternion_rotation to produce matrices!");
+    }
+
+    std::size_t i;
+    float t;
+    find_segment_and_t(ms_curr_time, i, t);
+
+    glm::vec4 powers_of_t = glm::vec4(1, t, t * t, t * t * t);
+    glm::vec3 position = coef_matrices_position[i] * powers_of_t;
+    glm::vec3 scale = coef_matrices_scale[i] * powers_of_t;
+    // outside of the path the keyframes are used as they are, the same as the other update does
+    if (ms_curr_time <= ms_start_time) {
+        position = keyframes[1].position;
+        scale = keyframes[1].scale;
+    } else if (ms_curr_time >= ms_end_time) {
+        position = keyframes[keyframes.size() - 2].position;
+        scale = keyframes[keyframes.size() - 2].scale;
+    }
+    glm::vec4 quaternion = glm::normalize(coef_matrices_rotation_quaternion[i] * powers_of_t);
+    glm::mat3 rotation = glm::mat3_cast(glm::quat(quaternion.w, quaternion.x, quaternion.y, quaternion.z));
+
+    // translation * rotation * scale
+    transform_matrix = glm::mat4(glm::vec4(rotation[0] * scale.x, 0), glm::vec4(rotation[1] * scale.y, 0),
+                                 glm::vec4(rotation[2] * scale.z, 0), glm::vec4(position, 1));
+}
+
+void ScriptedTransform::find_segment_and_t(double ms_curr_time, std::size_t &segment_index, float &t) {
+    if (ms_curr_time <= ms_start_time) {
+        segment_index = 0;
+        t = 0;
+        return;
+    }
+
+    if (ms_curr_time >= ms_end_time) {
+        segment_index = coef_matrices_position.size() - 1;
+        t = 1;
+        return;
+    }
+
     double total_arc_length = cummulative_arc_lengths_position[cummulative_arc_lengths_position.size() - 1];
     double curr_arc_length = total_arc_length * (ms_curr_time - ms_start_time) / (ms_end_time - ms_start_time);
 
-    int i = 0;
-    while (cummulative_arc_lengths_position[i + 1] < curr_arc_length)
-        i++;
+    std::size_t sample_index = advance_arc_length_sample_cursor(curr_arc_length);
+    const ArcLengthSample &sample = arc_length_samples[sample_index];
+    double sample_start_arc_length = sample_index == 0 ? 0.0 : arc_length_samples[sample_index - 1].arc_length;
+    double sample_arc_length = sample.arc_length - sample_start_arc_length;
+    double sample_percentage = sample_arc_length > 0.0 ? (curr_arc_length - sample_start_arc_length) / sample_arc_length : 0.0;
 
-    float t =
-        (curr_arc_length - cummulative_arc_lengths_position[i]) / (cummulative_arc_lengths_position[i + 1] - cummulative_arc_lengths_position[i]);
+    segment_index = sample.segment_index;
+    t = sample.t_start + sample_percentage * (sample.t_end - sample.t_start);
+}
 
-    transform.position = coef_matrices_position[i] * glm::vec4(1, t, t * t, t * t * t);
-    transform.rotation = coef_matrices_rotation[i] * glm::vec4(1, t, t * t, t * t * t); // keyframes[i + 1].rotation + t * (keyframes[i + 2].rotation - keyframes[i + 1].rotation);
-    transform.scale = coef_matrices_scale[i] * glm::vec4(1, t, t * t, t * t * t); // keyframes[i + 1].scale + t * (keyframes[i + 2].scale - keyframes[i + 1].scale);
+std::size_t ScriptedTransform::find_arc_length_sample_index(double arc_length) const {
+    // the first sample whose end is at or past the given arc length
+    auto it = std::lower_bound(arc_length_samples.begin(), arc_length_samples.end(), arc_length,
+                               [](const ArcLengthSample &sample, double value) { return sample.arc_length < value; });
+    std::size_t sample_index = it - arc_length_samples.begin();
+    return std::min(sample_index, arc_length_samples.size() - 1);
+}
+
+bool ScriptedTransform::arc_length_sample_contains_arc_length(std::size_t sample_index, double arc_length) const {
+    return arc_length_samples[sample_index].arc_length >= arc_length and
+           (sample_index == 0 or arc_length_samples[sample_index - 1].arc_length < arc_length);
+}
+
+std::size_t ScriptedTransform::advance_arc_length_sample_cursor(double arc_length) {
+    // during regular playback we are either still in the same sample or have just moved into the next one
+    if (arc_length_sample_contains_arc_length(arc_length_sample_cursor, arc_length)) {
+        return arc_length_sample_cursor;
+    }
+
+    if (arc_length_sample_cursor + 1 < arc_length_samples.size() and
+        arc_length_sample_contains_arc_length(arc_length_sample_cursor + 1, arc_length)) {
+        arc_length_sample_cursor += 1;
+        return arc_length_sample_cursor;
+    }
+
+    arc_length_sample_cursor = find_arc_length_sample_index(arc_length);
+    return arc_length_sample_cursor;
 }
@@ -5,7 +5,11 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstddef>
 #include <iostream>
+#include <memory>
+#include <span>
 #include <vector>
 
 struct ScriptedTransformKeyframe {
@@ -14,10 +18,51 @@ struct ScriptedTransformKeyframe {
     glm::vec3 scale;
 };
 
+/**
+ * one entry of the inverse arc length table, it covers the arc length from the end of the previous sample up to
+ * arc_length, over which the local parameter of the segment goes linearly from t_start to t_end
+ */
+struct ArcLengthSample {
+    double arc_length; // arc length traversed until the end of this sample
+    double t_start;
+    double t_end;
+    unsigned int segment_index;
+    // spelled out so that compiled scripted paths don't contain uninitialized tail padding
+    unsigned int padding = 0;
+};
+
+/**
+ * everything a ScriptedTransform precomputes, as views so that it can point into memory that the transform does not own
+ * such as a memory mapped compiled scripted path
+ */
+struct ScriptedTransformView {
+    std::span<const ScriptedTransformKeyframe> keyframes;
+    std::span<const glm::mat4x3> coef_matrices_position;
+    std::span<const glm::mat4x3> coef_matrices_rotation;
+    std::span<const glm::mat4x3> coef_matrices_scale;
+    std::span<const glm::mat4> coef_matrices_rotation_quaternion;
+    std::span<const double> cummulative_arc_lengths_position;
+    std::span<const ArcLengthSample> arc_length_samples;
+    double ms_start_time;
+    double ms_end_time;
+    double tau_position;
+    double tau_rotation;
+    double tau_scale;
+};
+
 class ScriptedTransform {
   public:
     ScriptedTransform(std::vector<ScriptedTransformKeyframe> keyframes, double ms_start_time, double ms_end_time,
-                      double tau_position = 0.5, double tau_rotation = 0.5, double tau_scale = 0.5);
+                      double tau_position = 0.5, double tau_rotation = 0.5, double tau_scale = 0.5,
+                      double arc_length_tolerance = 0.01, bool use_quaternion_rotation = false);
+
+    /**
+     * uses already precomputed data without copying it, storage is kept alive for as long as any transform refers to
+     * it and has to own the memory that the view points into
+     */
+    ScriptedTransform(const ScriptedTransformView &view, std::shared_ptr<const void> storage);
+
+    ScriptedTransformView get_view() const;
 
     /**
      * transform.position: Catmull-Rom interpolation
@@ -26,18 +71,44 @@ class ScriptedTransform {
      */
     void update(double ms_curr_time);
 
+    /**
+     * writes translation * rotation * scale into transform_matrix without going through euler angles, the rotation is
+     * a normalized Catmull-Rom interpolation of the keyframe rotations as quaternions, requires that the transform was
+     * constructed with use_quaternion_rotation, transform is not touched
+     */
+    void update(double ms_curr_time, glm::mat4 &transform_matrix);
+
+    /**
+     * returns the index of the arc length sample that the given arc length falls into, this is a binary search so it
+     * is suitable for random access, update uses a cursor on top of this so that forward playback is amortized O(1)
+     */
+    std::size_t find_arc_length_sample_index(double arc_length) const;
+
     Transform transform;
 
   private:
-    std::vector<ScriptedTransformKeyframe> keyframes;
-    std::vector<glm::mat4x3> coef_matrices_position;
-    std::vector<glm::mat4x3> coef_matrices_rotation;
-    std::vector<glm::mat4x3> coef_matrices_scale;
-    std::vector<double> cummulative_arc_lengths_position; // arc length traversed until i-th control point
-    std::vector<double> cummulative_arc_lengths_rotation; // arc length traversed until i-th control point
-    std::vector<double> cummulative_arc_lengths_scale;    // arc length traversed until i-th control point
+    // copies the precomputed coefficients and arc length table into its own arrays
+    friend class ScriptedTransformSystem;
+
+    void find_segment_and_t(double ms_curr_time, std::size_t &segment_index, float &t);
+    bool arc_length_sample_contains_arc_length(std::size_t sample_index, double arc_length) const;
+    std::size_t advance_arc_length_sample_cursor(double arc_length);
+
+    // the precomputed data is immutable, so copies of a transform share it
+    std::shared_ptr<const void> storage;
+    std::span<const ScriptedTransformKeyframe> keyframes;
+    std::span<const glm::mat4x3> coef_matrices_position;
+    std::span<const glm::mat4x3> coef_matrices_rotation;
+    std::span<const glm::mat4x3> coef_matrices_scale;
+    std::span<const glm::mat4> coef_matrices_rotation_quaternion; // empty unless use_quaternion_rotation, rows are xyzw
+    std::span<const double> cummulative_arc_lengths_position;     // arc length traversed until i-th control point
+    std::span<const ArcLengthSample> arc_length_samples;          // inverse arc length table of the position track
     double ms_start_time;
     double ms_end_time;
+    double tau_position;
+    double tau_rotation;
+    double tau_scale;
+    std::size_t arc_length_sample_cursor; // sample used by the last call to update
 };
 
 #endif // SCRIPTED_TRANSFORM_HPP
@@ -0,0 +1,208 @@
+#include "scripted_transform_system.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+unsigned int ScriptedTransformSystem::add_track(const ScriptedTransform &scripted_transform) {
+    // every track has at least one sample, the lookup relies on it
+    if (scripted_transform.arc_length_samples.empty()) {
+        throw std::runtime_error("ScriptedTransformSystem was given a track without arc length samples!");
+    }
+
+    unsigned int track_index = ms_start_times.size();
+    int first_segment_index = coefficients.size() / COEFFICIENTS_PER_SEGMENT;
+
+    std::span<const glm::mat4x3> coef_matrices[3] = {scripted_transform.coef_matrices_position,
+                                                     scripted_transform.coef_matrices_rotation,
+                                                     scripted_transform.coef_matrices_scale};
+
+    for (std::size_t segment_index = 0; segment_index < scripted_transform.coef_matrices_position.size();
+         segment_index++) {
+        // pushed in channel order, channel = component * 3 + axis
+        for (int component = 0; component < 3; component++) {
+            const glm::mat4x3 &coef_matrix = coef_matrices[component][segment_index];
+            for (int axis = 0; axis < 3; axis++) {
+                for (int power = 0; power < 4; power++) {
+                    coefficients.push_back(coef_matrix[power][axis]);
+                }
+            }
+        }
+    }
+
+    first_sample_indices.push_back(sample_arc_lengths.size());
+    sample_counts.push_back(scripted_transform.arc_length_samples.size());
+    arc_length_sample_cursors.push_back(0);
+    for (const ArcLengthSample &sample : scripted_transform.arc_length_samples) {
+        sample_arc_lengths.push_back(sample.arc_length);
+        sample_t_starts.push_back(sample.t_start);
+        sample_t_ends.push_back(sample.t_end);
+        sample_segment_indices.push_back(first_segment_index + sample.segment_index);
+    }
+
+    ms_start_times.push_back(scripted_transform.ms_start_time);
+    ms_end_times.push_back(scripted_transform.ms_end_time);
+
+    active_segment_indices.resize(ms_start_times.size());
+    active_ts.resize(ms_start_times.size());
+    for (std::vector<float> &evaluated_channel : evaluated_channels) {
+        evaluated_channel.resize(ms_start_times.size());
+    }
+
+    return track_index;
+}
+
+std::size_t ScriptedTransformSystem::get_track_count() const { return ms_start_times.size(); }
+
+void ScriptedTransformSystem::update(double ms_curr_time, Transform *transforms) {
+    select_active_segments(ms_curr_time);
+    evaluate_active_segments();
+
+    for (std::size_t track_index = 0; track_index < get_track_count(); track_index++) {
+        transforms[track_index].position = glm::vec3(
+            evaluated_channels[0][track_index], evaluated_channels[1][track_index], evaluated_channels[2][track_index]);
+        transforms[track_index].rotation = glm::vec3(
+            evaluated_channels[3][track_index], evaluated_channels[4][track_index], evaluated_channels[5][track_index]);
+        transforms[track_index].scale = glm::vec3(
+            evaluated_channels[6][track_index], evaluated_channels[7][track_index], evaluated_channels[8][track_index]);
+    }
+}
+
+std::size_t ScriptedTransformSystem::find_arc_length_sample_index(unsigned int track_index, double arc_length) const {
+    auto samples_begin = sample_arc_lengths.begin() + first_sample_indices[track_index];
+    auto samples_end = samples_begin + sample_counts[track_index];
+    std::size_t sample_index = std::lower_bound(samples_begin, samples_end, arc_length) - samples_begin;
+    return std::min<std::size_t>(sample_index, sample_counts[track_index] - 1);
+}
+
+bool ScriptedTransformSystem::arc_length_sample_contains_arc_length(unsigned int track_index,
+                                                                    std::size_t sample_index,
+                                                                    double arc_length) const {
+    const double *track_arc_lengths = &sample_arc_lengths[first_sample_indices[track_index]];
+    return track_arc_lengths[sample_index] >= arc_length and
+           (sample_index == 0 or track_arc_lengths[sample_index - 1] < arc_length);
+}
+
+/**
+ * the same lookup that ScriptedTransform::update does, the start and end of the path are expressed as t = 0 on the
+ * first segment and t = 1 on the last segment so that every track goes through the same evaluation afterwards
+ */
+void ScriptedTransformSystem::select_active_segments(double ms_curr_time) {
+    for (unsigned int track_index = 0; track_index < get_track_count(); track_index++) {
+        unsigned int first_sample_index = first_sample_indices[track_index];
+        unsigned int last_sample_index = first_sample_index + sample_counts[track_index] - 1;
+
+        if (ms_curr_time <= ms_start_times[track_index]) {
+            active_segment_indices[track_index] = sample_segment_indices[first_sample_index];
+            active_ts[track_index] = 0.0f;
+            continue;
+        }
+
+        if (ms_curr_time >= ms_end_times[track_index]) {
+            active_segment_indices[track_index] = sample_segment_indices[last_sample_index];
+            active_ts[track_index] = 1.0f;
+            continue;
+        }
+
+        double total_arc_length = sample_arc_lengths[last_sample_index];
+        double curr_arc_length = total_arc_length * (ms_curr_time - ms_start_times[track_index]) /
+                                 (ms_end_times[track_index] - ms_start_times[track_index]);
+
+        std::size_t sample_index = arc_length_sample_cursors[track_index];
+        if (not arc_length_sample_contains_arc_length(track_index, sample_index, curr_arc_length)) {
+            if (sample_index + 1 < sample_counts[track_index] and
+                arc_length_sample_contains_arc_length(track_index, sample_index + 1, curr_arc_length)) {
+                sample_index += 1;
+            } else {
+                sample_index = find_arc_length_sample_index(track_index, curr_arc_length);
+            }
+            arc_length_sample_cursors[track_index] = sample_index;
+        }
+
+        std::size_t global_sample_index = first_sample_index + sample_index;
+        double sample_start_arc_length = sample_index == 0 ? 0.0 : sample_arc_lengths[global_sample_index - 1];
+        double sample_arc_length = sample_arc_lengths[global_sample_index] - sample_start_arc_length;
+        double sample_percentage =
+            sample_arc_length > 0.0 ? (curr_arc_length - sample_start_arc_length) / sample_arc_length : 0.0;
+
+        active_segment_indices[track_index] = sample_segment_indices[global_sample_index];
+        active_ts[track_index] = sample_t_starts[global_sample_index] +
+                                 sample_percentage * (sample_t_ends[global_sample_index] -
+                                                      sample_t_starts[global_sample_index]);
+    }
+}
+
+/**
+ * evaluates the cubic of every channel of every track with horner's method, lanes are tracks
+ */
+void ScriptedTransformSystem::evaluate_active_segments() {
+    std::size_t track_count = get_track_count();
+    std::size_t track_index = 0;
+
+#if defined(__AVX2__)
+    for (; track_index + 8 <= track_count; track_index += 8) {
+        __m256i segment_indices =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&active_segment_indices[track_index]));
+        __m256i segment_offsets = _mm256_mullo_epi32(segment_indices, _mm256_set1_epi32(COEFFICIENTS_PER_SEGMENT));
+        __m256 t = _mm256_loadu_ps(&active_ts[track_index]);
+
+        for (int channel = 0; channel < NUM_CHANNELS; channel++) {
+            const float *channel_coefficients = coefficients.data() + channel * 4;
+            __m256 result = _mm256_i32gather_ps(channel_coefficients + 3, segment_offsets, 4);
+            for (int power = 2; power >= 0; power--) {
+                __m256 coefficient = _mm256_i32gather_ps(channel_coefficients + power, segment_offsets, 4);
+#if defined(__FMA__)
+                result = _mm256_fmadd_ps(result, t, coefficient);
+#else
+                result = _mm256_add_ps(_mm256_mul_ps(result, t), coefficient);
+#endif
+            }
+            _mm256_storeu_ps(&evaluated_channels[channel][track_index], result);
+        }
+    }
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+    for (; track_index + 4 <= track_count; track_index += 4) {
+        const float *segment_coefficients[4];
+        for (int lane = 0; lane < 4; lane++) {
+            segment_coefficients[lane] =
+                coefficients.data() + active_segment_indices[track_index + lane] * COEFFICIENTS_PER_SEGMENT;
+        }
+        __m128 t = _mm_loadu_ps(&active_ts[track_index]);
+
+        for (int channel = 0; channel < NUM_CHANNELS; channel++) {
+            // one row per track holding its powers 0 to 3, after the transpose one row per power holding the tracks
+            __m128 power_0 = _mm_loadu_ps(segment_coefficients[0] + channel * 4);
+            __m128 power_1 = _mm_loadu_ps(segment_coefficients[1] + channel * 4);
+            __m128 power_2 = _mm_loadu_ps(segment_coefficients[2] + channel * 4);
+            __m128 power_3 = _mm_loadu_ps(segment_coefficients[3] + channel * 4);
+            _MM_TRANSPOSE4_PS(power_0, power_1, power_2, power_3);
+
+            __m128 result = power_3;
+            result = _mm_add_ps(_mm_mul_ps(result, t), power_2);
+            result = _mm_add_ps(_mm_mul_ps(result, t), power_1);
+            result = _mm_add_ps(_mm_mul_ps(result, t), power_0);
+            _mm_storeu_ps(&evaluated_channels[channel][track_index], result);
+        }
+    }
+#endif
+
+    for (; track_index < track_count; track_index++) {
+        const float *segment_coefficients =
+            coefficients.data() + active_segment_indices[track_index] * COEFFICIENTS_PER_SEGMENT;
+        float t = active_ts[track_index];
+
+        for (int channel = 0; channel < NUM_CHANNELS; channel++) {
+            const float *channel_coefficients = segment_coefficients + channel * 4;
+            float result = channel_coefficients[3];
+            for (int power = 2; power >= 0; power--) {
+                result = result * t + channel_coefficients[power];
+            }
+            evaluated_channels[channel][track_index] = result;
+        }
+    }
+}
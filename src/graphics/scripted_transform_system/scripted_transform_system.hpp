@@ -0,0 +1,68 @@
+#ifndef SCRIPTED_TRANSFORM_SYSTEM_HPP
+#define SCRIPTED_TRANSFORM_SYSTEM_HPP
+
+#include "sbpt_generated_includes.hpp"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+/**
+ * evaluates many scripted transforms at once, the tracks are stored as structure of arrays so that a single timestamp
+ * can be evaluated for all tracks in one vectorized pass where every lane is a track
+ *
+ * the pass uses avx2 or sse when the translation unit is compiled with them (see SCRIPTED_TRANSFORM_SYSTEM_AVX2 in
+ * the CMakeLists.txt) and falls back to plain scalar code otherwise. the 36 coefficients of a segment sit next to each
+ * other, with avx2 they are gathered with one instruction per power, sse has no gather so there the 4 coefficients of
+ * a channel are loaded as one vector per track and transposed into one vector per power
+ */
+class ScriptedTransformSystem {
+  public:
+    /**
+     * copies the precomputed data out of the scripted transform, the returned index is where the result of this track
+     * is written to in the output buffer of update. throws if the transform has no arc length samples
+     */
+    unsigned int add_track(const ScriptedTransform &scripted_transform);
+
+    std::size_t get_track_count() const;
+
+    /**
+     * evaluates every track at the given time, transforms has to hold get_track_count() entries
+     */
+    void update(double ms_curr_time, Transform *transforms);
+
+  private:
+    // position xyz, rotation xyz, scale xyz
+    static const int NUM_CHANNELS = 9;
+    static const int COEFFICIENTS_PER_SEGMENT = NUM_CHANNELS * 4;
+
+    std::size_t find_arc_length_sample_index(unsigned int track_index, double arc_length) const;
+    bool arc_length_sample_contains_arc_length(unsigned int track_index, std::size_t sample_index,
+                                               double arc_length) const;
+    void select_active_segments(double ms_curr_time);
+    void evaluate_active_segments();
+
+    // per track
+    std::vector<double> ms_start_times;
+    std::vector<double> ms_end_times;
+    std::vector<unsigned int> first_sample_indices;
+    std::vector<unsigned int> sample_counts;
+    std::vector<unsigned int> arc_length_sample_cursors; // relative to the first sample of the track
+
+    // per arc length sample, the samples of all tracks are stored back to back
+    std::vector<double> sample_arc_lengths;
+    std::vector<float> sample_t_starts;
+    std::vector<float> sample_t_ends;
+    std::vector<int> sample_segment_indices; // segment of all tracks, see coefficients
+
+    // per segment, coefficients[segment * COEFFICIENTS_PER_SEGMENT + channel * 4 + power] holds the coefficient of
+    // t^power of that channel
+    std::vector<float> coefficients;
+
+    // per track, filled by the scalar lookup and consumed by the vectorized pass
+    std::vector<int> active_segment_indices;
+    std::vector<float> active_ts;
+    std::array<std::vector<float>, NUM_CHANNELS> evaluated_channels;
+};
+
+#endif // SCRIPTED_TRANSFORM_SYSTEM_HPP
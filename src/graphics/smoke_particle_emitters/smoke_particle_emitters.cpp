@@ -0,0 +1 @@
+#include "smoke_particle_emitters.hpp"
@@ -0,0 +1,63 @@
+#ifndef SMOKE_PARTICLE_EMITTERS_HPP
+#define SMOKE_PARTICLE_EMITTERS_HPP
+
+#include "sbpt_generated_includes.hpp"
+
+struct SmokeLifeSpan {
+    static float sample(ParticleRandomGenerator &random) { return random.uniform(1.0f, 3.0f); }
+};
+
+struct BlowingSmokeInitialVelocity {
+    static glm::vec3 sample(ParticleRandomGenerator &random) {
+        // Initial upward push with slight lateral drift
+        float dx = random.uniform(0.05f, 0.1f); // minor variance
+        float dy = random.uniform(0.5f, 0.1f);  // upward push
+        float dz = random.uniform(0.3f, 0.5f);  // blowing
+        return glm::vec3(dx, dy, dz);
+    }
+};
+
+struct CigaretteSmokeInitialVelocity {
+    static glm::vec3 sample(ParticleRandomGenerator &random) {
+        // Initial upward push with slight lateral drift, upward used to be 0.75 to 0.9
+        float dx = random.uniform(-0.10f, 0.10f);
+        float dy = random.uniform(0.1f, 0.2f);
+        float dz = random.uniform(-0.10f, 0.10f);
+        return glm::vec3(dx, dy, dz);
+    }
+};
+
+struct SmokeVelocityChange {
+    static glm::vec3 compute(float life_percentage, float delta_time, ParticleRandomGenerator &random) {
+        // Small lateral variance, there is no vertical acceleration
+        float accel_x = random.uniform(-0.0025f, 0.0025f);
+        float accel_z = random.uniform(-0.0025f, 0.0025f);
+        glm::vec3 smoke_push_down = -glm::vec3(accel_x, 0, accel_z) * delta_time;
+        return smoke_push_down;
+    }
+};
+
+struct SmokeScaling {
+    static float compute(float life_percentage) { return life_percentage * 0.1f; }
+};
+
+struct SmokeRotation {
+    static float compute(float life_percentage) { return life_percentage / 5.0f; }
+};
+
+struct BlowingSmokeSpawnDelay {
+    static float sample(ParticleRandomGenerator &random) { return 0.05f; }
+};
+
+struct CigaretteSmokeSpawnDelay {
+    static float sample(ParticleRandomGenerator &random) { return 0.10f; }
+};
+
+using BlowingSmokeParticleEmitter = SoAParticleEmitter<SmokeLifeSpan, BlowingSmokeInitialVelocity, SmokeVelocityChange,
+                                                       SmokeScaling, SmokeRotation, BlowingSmokeSpawnDelay>;
+
+using CigaretteSmokeParticleEmitter =
+    SoAParticleEmitter<SmokeLifeSpan, CigaretteSmokeInitialVelocity, SmokeVelocityChange, SmokeScaling, SmokeRotation,
+                       CigaretteSmokeSpawnDelay>;
+
+#endif // SMOKE_PARTICLE_EMITTERS_HPP
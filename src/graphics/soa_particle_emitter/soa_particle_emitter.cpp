@@ -0,0 +1,27 @@
+#include "soa_particle_emitter.hpp"
+
+ParticleRandomGenerator::ParticleRandomGenerator(std::uint32_t seed) : lanes{}, batch{}, batch_index{BATCH_SIZE} {
+    // splitmix style scrambling so that neighbouring seeds give unrelated lanes, xorshift state must not be zero
+    for (std::size_t lane = 0; lane < NUM_LANES; lane++) {
+        std::uint32_t z = seed + 0x9e3779b9u * static_cast<std::uint32_t>(lane + 1);
+        z = (z ^ (z >> 16)) * 0x85ebca6bu;
+        z = (z ^ (z >> 13)) * 0xc2b2ae35u;
+        z = z ^ (z >> 16);
+        lanes[lane] = z == 0 ? 0x6d2b79f5u : z;
+    }
+}
+
+void ParticleRandomGenerator::refill_batch() {
+    for (std::size_t i = 0; i < BATCH_SIZE; i += NUM_LANES) {
+        for (std::size_t lane = 0; lane < NUM_LANES; lane++) {
+            std::uint32_t x = lanes[lane];
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            lanes[lane] = x;
+            // the top 24 bits fit exactly into a float mantissa
+            batch[i + lane] = (x >> 8) * (1.0f / 16777216.0f);
+        }
+    }
+    batch_index = 0;
+}
@@ -0,0 +1,278 @@
+#ifndef SOA_PARTICLE_EMITTER_HPP
+#define SOA_PARTICLE_EMITTER_HPP
+
+#include "sbpt_generated_includes.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+/**
+ * a small per emitter random number generator that produces uniform floats in batches, the state is four independent
+ * xorshift lanes so that refilling a batch vectorizes, it is not meant for anything but visual noise
+ */
+class ParticleRandomGenerator {
+  public:
+    explicit ParticleRandomGenerator(std::uint32_t seed);
+
+    // uniform in [0, 1)
+    float next_float() {
+        if (batch_index == BATCH_SIZE) {
+            refill_batch();
+        }
+        return batch[batch_index++];
+    }
+
+    // uniform between a and b, works for a > b too
+    float uniform(float a, float b) { return a + (b - a) * next_float(); }
+
+  private:
+    static const std::size_t BATCH_SIZE = 256;
+    static const std::size_t NUM_LANES = 4;
+
+    void refill_batch();
+
+    std::array<std::uint32_t, NUM_LANES> lanes;
+    std::array<float, BATCH_SIZE> batch;
+    std::size_t batch_index;
+};
+
+/**
+ * a particle emitter that stores its particles as structure of arrays and takes its behaviour as policy types, each
+ * policy is a struct with a static function so that the compiler can inline it into the update loop:
+ *
+ *   LifeSpanPolicy::sample(ParticleRandomGenerator &) -> float
+ *   InitialVelocityPolicy::sample(ParticleRandomGenerator &) -> glm::vec3
+ *   VelocityChangePolicy::compute(float life_percentage, float delta_time, ParticleRandomGenerator &) -> glm::vec3
+ *   ScalingPolicy::compute(float life_percentage) -> float
+ *   RotationPolicy::compute(float life_percentage) -> float
+ *   SpawnDelayPolicy::sample(ParticleRandomGenerator &) -> float
+ *
+ * alive particles are kept densely packed at the front of the arrays, index i refers to the i-th alive particle and
+ * is only valid until the next update, every particle slot owns a unique id that moves along with the particle
+ */
+template <typename LifeSpanPolicy, typename InitialVelocityPolicy, typename VelocityChangePolicy,
+          typename ScalingPolicy, typename RotationPolicy, typename SpawnDelayPolicy>
+class SoAParticleEmitter {
+  public:
+    SoAParticleEmitter(unsigned int max_particles, Transform initial_transform,
+                       std::uint32_t random_seed = std::random_device{}());
+
+    /**
+     * ages, kills, moves and spawns particles, world_to_clip is used to compute the depth that particles are sorted by
+     */
+    void update(float delta_time, const glm::mat4 &world_to_clip);
+
+    void stop_emitting_particles();
+    void resume_emitting_particles();
+
+    std::size_t get_alive_particle_count() const { return alive_particle_count; }
+
+    /**
+     * indices of the alive particles ordered from furthest to closest, which is the order to draw them in, the order
+     * is kept between frames and only repaired so this is valid until the next update
+     */
+    std::span<const unsigned int> get_particles_sorted_by_distance() const {
+        return depth_sorter.get_sorted_indices();
+    }
+
+    glm::vec3 get_position(std::size_t i) const { return glm::vec3(positions_x[i], positions_y[i], positions_z[i]); }
+    float get_scale(std::size_t i) const { return scales[i]; }
+    float get_rotation(std::size_t i) const { return rotations[i]; }
+    float get_life_percentage(std::size_t i) const { return ages[i] / life_spans[i]; }
+    const glm::vec3 &get_emitter_scale(std::size_t i) const { return emitter_scales[i]; }
+    unsigned int get_id(std::size_t i) const { return ids[i]; }
+
+    // the ids of every slot alive or not, particles swap ids around but the set never changes
+    std::span<const unsigned int> get_all_particle_ids() const { return ids; }
+
+    // particles spawn at the position of this transform and keep its scale
+    Transform transform;
+
+    // register this with a ParticleBudgetManager to have the spawn rate and life spans throttled under load
+    ParticleEmitterBudget budget;
+
+  private:
+    void spawn_particle();
+    void kill_particle(std::size_t i);
+    void sort_particles_by_distance(const glm::mat4 &world_to_clip);
+
+    unsigned int max_particles;
+    std::size_t alive_particle_count;
+    bool emitting;
+    float time_since_last_spawn;
+    float spawn_delay;
+    // running averages of the unscaled policy samples, used to estimate the particle demand
+    float mean_spawn_delay;
+    float mean_life_span;
+    ParticleRandomGenerator random;
+
+    std::vector<float> positions_x;
+    std::vector<float> positions_y;
+    std::vector<float> positions_z;
+    std::vector<float> velocities_x;
+    std::vector<float> velocities_y;
+    std::vector<float> velocities_z;
+    std::vector<float> ages;
+    std::vector<float> life_spans;
+    std::vector<float> scales;
+    std::vector<float> rotations;
+    std::vector<glm::vec3> emitter_scales;
+    std::vector<unsigned int> ids;
+
+    std::vector<float> depths;
+    IncrementalDepthSorter depth_sorter;
+};
+
+template <typename LSP, typename IVP, typename VCP, typename SP, typename RP, typename SDP>
+SoAParticleEmitter<LSP, IVP, VCP, SP, RP, SDP>::SoAParticleEmitter(unsigned int max_particles,
+                                                                   Transform initial_transform,
+                                                                   std::uint32_t random_seed)
+    : transform{initial_transform}, max_particles{max_particles}, alive_particle_count{0}, emitting{true},
+      time_since_last_spawn{0}, spawn_delay{0}, mean_spawn_delay{0}, mean_life_span{0}, random{random_seed},
+      positions_x(max_particles), positions_y(max_particles), positions_z(max_particles), velocities_x(max_particles),
+      velocities_y(max_particles), velocities_z(max_particles), ages(max_particles), life_spans(max_particles),
+      scales(max_particles), rotations(max_particles), emitter_scales(max_particles), ids(max_particles),
+      depths(max_particles), depth_sorter(max_particles) {
+    for (unsigned int &id : ids) {
+        id = UniqueIDGenerator::generate();
+    }
+    spawn_delay = SDP::sample(random);
+    mean_spawn_delay = spawn_delay;
+    mean_life_span = LSP::sample(random);
+    budget.max_particles = max_particles;
+}
+
+template <typename LSP, typename IVP, typename VCP, typename SP, typename RP, typename SDP>
+void SoAParticleEmitter<LSP, IVP, VCP, SP, RP, SDP>::update(float delta_time, const glm::mat4 &world_to_clip) {
+    auto update_start = std::chrono::steady_clock::now();
+
+    // ageing and killing first so that dead particles never get simulated
+    for (std::size_t i = 0; i < alive_particle_count; i++) {
+        ages[i] += delta_time;
+    }
+    for (std::size_t i = 0; i < alive_particle_count;) {
+        if (ages[i] >= life_spans[i]) {
+            kill_particle(i);
+        } else {
+            i++;
+        }
+    }
+
+    for (std::size_t i = 0; i < alive_particle_count; i++) {
+        float life_percentage = ages[i] / life_spans[i];
+        glm::vec3 velocity_change = VCP::compute(life_percentage, delta_time, random);
+        velocities_x[i] += velocity_change.x;
+        velocities_y[i] += velocity_change.y;
+        velocities_z[i] += velocity_change.z;
+        scales[i] = SP::compute(life_percentage);
+        rotations[i] = RP::compute(life_percentage);
+    }
+
+    for (std::size_t i = 0; i < alive_particle_count; i++) {
+        positions_x[i] += velocities_x[i] * delta_time;
+        positions_y[i] += velocities_y[i] * delta_time;
+        positions_z[i] += velocities_z[i] * delta_time;
+    }
+
+    if (emitting) {
+        // a lower spawn rate scale makes time between spawns pass slower
+        time_since_last_spawn += delta_time * budget.spawn_rate_scale;
+        std::size_t particle_cap = std::min<std::size_t>(max_particles, budget.alive_particle_cap);
+        while (time_since_last_spawn >= spawn_delay and alive_particle_count < particle_cap) {
+            time_since_last_spawn -= spawn_delay;
+            spawn_particle();
+            spawn_delay = SDP::sample(random);
+            mean_spawn_delay += 0.05f * (spawn_delay - mean_spawn_delay);
+        }
+        // a full emitter doesn't bank spawns for later
+        time_since_last_spawn = std::min(time_since_last_spawn, spawn_delay);
+    }
+
+    sort_particles_by_distance(world_to_clip);
+
+    budget.alive_particle_count = alive_particle_count;
+    if (emitting and mean_spawn_delay > 0) {
+        budget.particle_demand = std::min<float>(max_particles, mean_life_span / mean_spawn_delay);
+    } else {
+        // the ones still alive are all that is left of the demand
+        budget.particle_demand = alive_particle_count;
+    }
+    budget.last_update_cost_sec =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - update_start).count();
+}
+
+template <typename LSP, typename IVP, typename VCP, typename SP, typename RP, typename SDP>
+void SoAParticleEmitter<LSP, IVP, VCP, SP, RP, SDP>::stop_emitting_particles() {
+    emitting = false;
+}
+
+template <typename LSP, typename IVP, typename VCP, typename SP, typename RP, typename SDP>
+void SoAParticleEmitter<LSP, IVP, VCP, SP, RP, SDP>::resume_emitting_particles() {
+    if (not emitting) {
+        time_since_last_spawn = 0;
+    }
+    emitting = true;
+}
+
+template <typename LSP, typename IVP, typename VCP, typename SP, typename RP, typename SDP>
+void SoAParticleEmitter<LSP, IVP, VCP, SP, RP, SDP>::spawn_particle() {
+    std::size_t i = alive_particle_count;
+    alive_particle_count++;
+
+    glm::vec3 initial_velocity = IVP::sample(random);
+    positions_x[i] = transform.position.x;
+    positions_y[i] = transform.position.y;
+    positions_z[i] = transform.position.z;
+    velocities_x[i] = initial_velocity.x;
+    velocities_y[i] = initial_velocity.y;
+    velocities_z[i] = initial_velocity.z;
+    ages[i] = 0;
+    float life_span = LSP::sample(random);
+    mean_life_span += 0.05f * (life_span - mean_life_span);
+    life_spans[i] = life_span * budget.life_span_scale;
+    scales[i] = SP::compute(0);
+    rotations[i] = RP::compute(0);
+    emitter_scales[i] = transform.scale;
+    depth_sorter.insert(i);
+}
+
+template <typename LSP, typename IVP, typename VCP, typename SP, typename RP, typename SDP>
+void SoAParticleEmitter<LSP, IVP, VCP, SP, RP, SDP>::kill_particle(std::size_t i) {
+    // move the last alive particle into the hole, the ids are swapped so that every slot keeps a unique id
+    std::size_t last = alive_particle_count - 1;
+    positions_x[i] = positions_x[last];
+    positions_y[i] = positions_y[last];
+    positions_z[i] = positions_z[last];
+    velocities_x[i] = velocities_x[last];
+    velocities_y[i] = velocities_y[last];
+    velocities_z[i] = velocities_z[last];
+    ages[i] = ages[last];
+    life_spans[i] = life_spans[last];
+    scales[i] = scales[last];
+    rotations[i] = rotations[last];
+    emitter_scales[i] = emitter_scales[last];
+    std::swap(ids[i], ids[last]);
+    depth_sorter.remove(i, last);
+    alive_particle_count--;
+}
+
+template <typename LSP, typename IVP, typename VCP, typename SP, typename RP, typename SDP>
+void SoAParticleEmitter<LSP, IVP, VCP, SP, RP, SDP>::sort_particles_by_distance(const glm::mat4 &world_to_clip) {
+    // clip space w is the distance along the view direction, so only the fourth row is needed
+    glm::vec4 w_row = glm::vec4(world_to_clip[0][3], world_to_clip[1][3], world_to_clip[2][3], world_to_clip[3][3]);
+    for (std::size_t i = 0; i < alive_particle_count; i++) {
+        depths[i] = w_row.x * positions_x[i] + w_row.y * positions_y[i] + w_row.z * positions_z[i] + w_row.w;
+    }
+
+    depth_sorter.sort_back_to_front(std::span<const float>(depths.data(), alive_particle_count));
+}
+
+#endif // SOA_PARTICLE_EMITTER_HPP
@@ -4,23 +4,40 @@
 #include <glm/detail/qualifier.hpp>
 
 #include "graphics/animated_texture_atlas/animated_texture_atlas.hpp"
+#include "graphics/animated_texture_uv_table/animated_texture_uv_table.hpp"
 #include "graphics/batcher/generated/batcher.hpp"
+#include "graphics/compiled_scripted_path/compiled_scripted_path.hpp"
 #include "graphics/fps_camera/fps_camera.hpp"
-#include "graphics/scripted_events/scripted_scene_manager.hpp"
+#include "graphics/scene_state_timeline/scene_state_timeline.hpp"
+#include "graphics/scripted_event_timeline/scripted_event_timeline.hpp"
 #include "graphics/vertex_geometry/vertex_geometry.hpp"
 #include "graphics/window/window.hpp"
 #include "graphics/shader_cache/shader_cache.hpp"
-#include "graphics/particle_emitter/particle_emitter.hpp"
+#include "graphics/smoke_particle_emitters/smoke_particle_emitters.hpp"
+#include "graphics/retained_mesh_registry/retained_mesh_registry.hpp"
+#include "graphics/ltw_matrix_slots/ltw_matrix_slots.hpp"
+#include "graphics/ltw_matrix_uploader/ltw_matrix_uploader.hpp"
+#include "graphics/light_uniform_manager/light_uniform_manager.hpp"
+#include "utility/animation_pose_cache/animation_pose_cache.hpp"
+#include "utility/asset_job_graph/asset_job_graph.hpp"
+#include "utility/baked_rigged_model/baked_rigged_model.hpp"
+#include "utility/bone_socket_system/bone_socket_system.hpp"
+#include "utility/frame_packet_pipeline/frame_packet_pipeline.hpp"
+#include "utility/frame_profiler/frame_profiler.hpp"
+#include "graphics/particle_budget_manager/particle_budget_manager.hpp"
 #include "graphics/texture_packer/texture_packer.hpp"
 #include "graphics/texture_packer_model_loading/texture_packer_model_loading.hpp"
 #include "graphics/scripted_transform/scripted_transform.hpp"
 
 #include "sound_system/sound_system.hpp"
+#include "cached_sound_system/cached_sound_system.hpp"
 
 #include "utility/glfw_lambda_callback_manager/glfw_lambda_callback_manager.hpp"
 #include "utility/model_loading/model_loading.hpp"
 #include "utility/rigged_model_loading/rigged_model_loading.hpp"
+#include "utility/simulation_clock/simulation_clock.hpp"
 #include "utility/unique_id_generator/unique_id_generator.hpp"
+#include "utility/work_stealing_scheduler/work_stealing_scheduler.hpp"
 
 #define STB_IMAGE_IMPLEMENTATION
 
@@ -31,7 +48,10 @@
 
 #include <functional>
 #include <iostream>
+#include <optional>
 #include <random>
+#include <span>
+#include <utility>
 
 #include <nlohmann/json.hpp>
 
@@ -43,288 +63,101 @@ unsigned int SCREEN_HEIGHT = 800;
 #include <atomic>
 #include <iostream>
 
-class BlowingSmokeParticleEmitter {
-  public:
-    ParticleEmitter particle_emitter;
-
-    BlowingSmokeParticleEmitter(unsigned int max_particles, Transform initial_transform)
-        : particle_emitter(life_span_lambda(), initial_velocity_lambda(), velocity_change_lambda(), scaling_lambda(),
-                           rotation_lambda(), spawn_delay_lambda(), max_particles, initial_transform) {}
-
-  private:
-    static std::function<float()> life_span_lambda() {
-        return []() -> float {
-            static std::mt19937 rng(std::random_device{}());
-            std::uniform_real_distribution<float> dist(1.0f, 3.0f);
-            return dist(rng);
-        };
-    }
-
-    static std::function<glm::vec3()> initial_velocity_lambda() {
-        return []() -> glm::vec3 {
-            static std::mt19937 rng(std::random_device{}());
-            std::uniform_real_distribution<float> x_dist(0.05, 0.1f); // minor variance
-            std::uniform_real_distribution<float> z_dist(0.3, 0.5f);  // blowing
-            std::uniform_real_distribution<float> y_dist(0.5f, 0.1f); // upward push
-
-            // Initial upward push with slight lateral drift
-            float dx = x_dist(rng);
-            float dy = y_dist(rng); // Main upward velocity
-            float dz = z_dist(rng);
-
-            return glm::vec3(dx, dy, dz);
-            /*return glm::vec3(0, 0, 0);*/
-        };
-    }
-
-    static std::function<glm::vec3(float, float)> velocity_change_lambda() {
-        return [](float life_percentage, float delta_time) -> glm::vec3 {
-            static std::mt19937 rng(std::random_device{}());
-            std::uniform_real_distribution<float> horizontal_dist(-0.0025f, 0.0025f); // Small lateral variance
-            std::uniform_real_distribution<float> vertical_dist(0.05f, 0.1f);
-
-            float accel_x = horizontal_dist(rng);
-            float accel_y = vertical_dist(rng);
-            accel_y = 0;
-            float accel_z = horizontal_dist(rng);
-
-            glm::vec3 smoke_push_down = -glm::vec3(accel_x, accel_y, accel_z) * delta_time;
-            return smoke_push_down;
-        };
-    }
-
-    static std::function<float(float)> scaling_lambda() {
-        return [](float life_percentage) -> float { return life_percentage * 0.1; };
-    }
-
-    static std::function<float(float)> rotation_lambda() {
-        return [](float life_percentage) -> float { return life_percentage / 5.0f; };
-    }
-
-    static std::function<float()> spawn_delay_lambda() {
-        return []() -> float { return 0.05f; };
-    }
-};
-
-class CigaretteSmokeParticleEmitter {
-  public:
-    ParticleEmitter particle_emitter;
-
-    CigaretteSmokeParticleEmitter(unsigned int max_particles, Transform initial_transform)
-        : particle_emitter(life_span_lambda(), initial_velocity_lambda(), velocity_change_lambda(), scaling_lambda(),
-                           rotation_lambda(), spawn_delay_lambda(), max_particles, initial_transform) {}
-
-  private:
-    static std::function<float()> life_span_lambda() {
-        return []() -> float {
-            static std::mt19937 rng(std::random_device{}());
-            std::uniform_real_distribution<float> dist(1.0f, 3.0f);
-            return dist(rng);
-        };
-    }
-
-    static std::function<glm::vec3()> initial_velocity_lambda() {
-        return []() -> glm::vec3 {
-            static std::mt19937 rng(std::random_device{}());
-            std::uniform_real_distribution<float> horizontal_dist(-0.10f, 0.10f); // Small lateral variance
-            /*std::uniform_real_distribution<float> upward_dist(0.75f, 0.9f);     // upward push rever back to this*/
-            std::uniform_real_distribution<float> upward_dist(0.1f, 0.2f); // upward push
-
-            // Initial upward push with slight lateral drift
-            float dx = horizontal_dist(rng);
-            float dy = upward_dist(rng); // Main upward velocity
-            float dz = horizontal_dist(rng);
-
-            return glm::vec3(dx, dy, dz);
-            /*return glm::vec3(0, 0, 0);*/
-        };
-    }
-
-    static std::function<glm::vec3(float, float)> velocity_change_lambda() {
-        return [](float life_percentage, float delta_time) -> glm::vec3 {
-            static std::mt19937 rng(std::random_device{}());
-            std::uniform_real_distribution<float> horizontal_dist(-0.0025f, 0.0025f); // Small lateral variance
-            std::uniform_real_distribution<float> vertical_dist(0.05f, 0.1f);
-
-            float accel_x = horizontal_dist(rng);
-            float accel_y = vertical_dist(rng);
-            accel_y = 0;
-            float accel_z = horizontal_dist(rng);
-
-            glm::vec3 smoke_push_down = -glm::vec3(accel_x, accel_y, accel_z) * delta_time;
-            return smoke_push_down;
-        };
-    }
-
-    static std::function<float(float)> scaling_lambda() {
-        return [](float life_percentage) -> float { return life_percentage * 0.1; };
-    }
-
-    static std::function<float(float)> rotation_lambda() {
-        return [](float life_percentage) -> float { return life_percentage / 5.0f; };
-    }
-
-    static std::function<float()> spawn_delay_lambda() {
-        return []() -> float { return 0.10f; };
-    }
-};
-
 static void error_callback(int error, const char *description) { fprintf(stderr, "Error: %s\n", description); }
 
-void setVec3(GLint unif_loc, const glm::vec3 &value) { glUniform3fv(unif_loc, 1, &value[0]); }
-void setFloat(GLint unif_loc, float value) { glUniform1f(unif_loc, value); }
-
-// Light attribute structure
-struct PointLightAttributes {
-    glm::vec3 position = glm::vec3(0, 0, 0);
-    glm::vec3 ambient = glm::vec3(0, 0, 0);
-    glm::vec3 diffuse = glm::vec3(0, 0, 0);
-    glm::vec3 specular = glm::vec3(0, 0, 0);
-    float constant = 1.0f;
-    float linear = 0.09f;
-    float quadratic = 0.032f;
-};
+// the lights that never move, the light uniform manager only sends these once
+void set_static_shader_light_data(LightUniformManager &light_uniform_manager) {
+    light_uniform_manager.set_directional_light(
+        {{-0.2f, -1.0f, -0.3f}, {0.1f, 0.1f, 0.1f}, {0.8f, 0.8f, 0.8f}, {1.0f, 1.0f, 1.0f}});
+
+    light_uniform_manager.set_point_light(
+        1, {{.8, -.8, .8}, {0.00f, 0.00f, 0.00f}, {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}, 1.0f, 0.09f, 0.032f});
+    light_uniform_manager.set_point_light(
+        2, {{.8, .8, -.8}, {0.00f, 0.00f, 0.00f}, {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}, 1.0f, 0.09f, 0.032f});
+    light_uniform_manager.set_point_light(
+        3, {{-.8, .8, .8}, {0.00f, 0.00f, 0.00f}, {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}, 1.0f, 0.09f, 0.032f});
+}
 
 // NOTE we baked in the specular and diffuse into the lights but in reality this is material based
 // need to restructure this later
-void set_shader_light_data(FPSCamera &camera, ShaderCache &shader_cache, bool is_flame_active,
-                           glm::vec3 flame_light_pos) {
-    ShaderProgramInfo shader_info = shader_cache.get_shader_program(
-        ShaderType::
-            TEXTURE_PACKER_RIGGED_AND_ANIMATED_CWL_V_TRANSFORMATION_UBOS_1024_WITH_TEXTURES_AND_MULTIPLE_LIGHTS);
-
-    shader_cache.use_shader_program(
-        ShaderType::
-            TEXTURE_PACKER_RIGGED_AND_ANIMATED_CWL_V_TRANSFORMATION_UBOS_1024_WITH_TEXTURES_AND_MULTIPLE_LIGHTS);
-
-    GLint location = glGetUniformLocation(shader_info.id, "view_pos");
-    if (location != -1) {
-        setVec3(location, camera.transform.position);
-    } else {
-        std::cerr << "Warning: Uniform 'view_pos' not found!" << std::endl;
-    }
-
-    // Set directional light
-    auto set_dir_light = [&](const glm::vec3 &direction, const glm::vec3 &ambient, const glm::vec3 &diffuse,
-                             const glm::vec3 &specular) {
-        setVec3(glGetUniformLocation(shader_info.id, "dir_light.direction"), direction);
-        setVec3(glGetUniformLocation(shader_info.id, "dir_light.ambient"), ambient);
-        setVec3(glGetUniformLocation(shader_info.id, "dir_light.diffuse"), diffuse);
-        setVec3(glGetUniformLocation(shader_info.id, "dir_light.specular"), specular);
-    };
-    set_dir_light({-0.2f, -1.0f, -0.3f}, {0.1f, 0.1f, 0.1f}, {0.8f, 0.8f, 0.8f}, {1.0f, 1.0f, 1.0f});
-
-    // Point light data
-    std::vector<PointLightAttributes> point_lights = {
-        {flame_light_pos, {0.52f, 0.32f, 0.32f}, {0.1f, 0.1f, 0.1f}, {0.4f, 0.4f, 0.4f}, 8.0f, 8.0f, 8.0f},
-        {{.8, -.8, .8}, {0.00f, 0.00f, 0.00f}, {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}, 1.0f, 0.09f, 0.032f},
-        {{.8, .8, -.8}, {0.00f, 0.00f, 0.00f}, {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}, 1.0f, 0.09f, 0.032f},
-        {{-.8, .8, .8}, {0.00f, 0.00f, 0.00f}, {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}, 1.0f, 0.09f, 0.032f},
-    };
-    PointLightAttributes empty_light = PointLightAttributes();
+void set_shader_light_data(const glm::vec3 &camera_position, const glm::vec3 &camera_forward,
+                           LightUniformManager &light_uniform_manager, bool is_flame_active, glm::vec3 flame_light_pos,
+                           double curr_time_sec) {
+    light_uniform_manager.set_view_position(camera_position);
 
     // Enhanced flickering effect
-    float current_time = static_cast<float>(glfwGetTime());
+    float current_time = static_cast<float>(curr_time_sec);
     float flicker_factor = (sin(current_time * 7.0f) + sin(current_time * 13.0f)) * 0.5f + 0.5f; // Combined sine waves
     float flame_intensity = is_flame_active ? (0.1f + 0.4f * flicker_factor) : 0.0f;
 
-    for (size_t i = 0; i < point_lights.size(); ++i) {
-        PointLightAttributes light_data;
-        std::string base = "point_lights[" + std::to_string(i) + "].";
-
-        if (i == 0) {
-            if (not is_flame_active) {
-                light_data = empty_light;
-            } else {
-                light_data = point_lights[i];
-            }
-        } else {
-            light_data = point_lights[i];
-        }
-
-        setVec3(glGetUniformLocation(shader_info.id, (base + "position").c_str()), light_data.position);
-        setVec3(glGetUniformLocation(shader_info.id, (base + "ambient").c_str()), light_data.ambient);
-        setVec3(glGetUniformLocation(shader_info.id, (base + "diffuse").c_str()), light_data.diffuse);
-        setVec3(glGetUniformLocation(shader_info.id, (base + "specular").c_str()), light_data.specular);
-        setFloat(glGetUniformLocation(shader_info.id, (base + "constant").c_str()), light_data.constant);
-        setFloat(glGetUniformLocation(shader_info.id, (base + "linear").c_str()), light_data.linear);
-        setFloat(glGetUniformLocation(shader_info.id, (base + "quadratic").c_str()), light_data.quadratic);
+    PointLightAttributes flame_light;
+    if (is_flame_active) {
+        flame_light = {flame_light_pos, {0.52f, 0.32f, 0.32f}, {0.1f, 0.1f, 0.1f}, {0.4f, 0.4f, 0.4f}, 8.0f, 8.0f,
+                       8.0f};
     }
-
-    // Set spot light
-    auto set_spot_light = [&](const glm::vec3 &position, const glm::vec3 &direction, const glm::vec3 &ambient,
-                              const glm::vec3 &diffuse, const glm::vec3 &specular, float constant, float linear,
-                              float quadratic, float cutoff, float outer_cutoff) {
-        setVec3(glGetUniformLocation(shader_info.id, "spot_light.position"), position);
-        setVec3(glGetUniformLocation(shader_info.id, "spot_light.direction"), direction);
-        setVec3(glGetUniformLocation(shader_info.id, "spot_light.ambient"), ambient);
-        setVec3(glGetUniformLocation(shader_info.id, "spot_light.diffuse"), diffuse);
-        setVec3(glGetUniformLocation(shader_info.id, "spot_light.specular"), specular);
-        setFloat(glGetUniformLocation(shader_info.id, "spot_light.constant"), constant);
-        setFloat(glGetUniformLocation(shader_info.id, "spot_light.linear"), linear);
-        setFloat(glGetUniformLocation(shader_info.id, "spot_light.quadratic"), quadratic);
-        setFloat(glGetUniformLocation(shader_info.id, "spot_light.cut_off"), cutoff);
-        setFloat(glGetUniformLocation(shader_info.id, "spot_light.outer_cut_off"), outer_cutoff);
-    };
-
-    set_spot_light(camera.transform.position, camera.transform.compute_forward_vector(),
-                   /*{0.1f, 0.1f, 0.1f}, // ambient light (soft overall lighting)*/
-                   /*{0.5f, 0.5f, 0.5f}, // diffuse light (intense light from the spotlight)*/
-                   /*{0.5f, 0.5f, 0.5f}, // specular light (highlighted areas with shininess)*/
-                   // temporarily turning this off
-                   {0.0f, 0.0f, 0.0f}, // ambient light (soft overall lighting)
-                   {0.0f, 0.0f, 0.0f}, // diffuse light (intense light from the spotlight)
-                   {0.0f, 0.0f, 0.0f}, // specular light (highlighted areas with shininess)
-                   1.0f, 0.09f, 0.032f, glm::cos(glm::radians(12.5f)), glm::cos(glm::radians(15.0f)));
+    light_uniform_manager.set_point_light(0, flame_light);
+
+    light_uniform_manager.set_spot_light({camera_position, camera_forward,
+                                          /*{0.1f, 0.1f, 0.1f}, // ambient light (soft overall lighting)*/
+                                          /*{0.5f, 0.5f, 0.5f}, // diffuse light (intense light from the spotlight)*/
+                                          /*{0.5f, 0.5f, 0.5f}, // specular light (highlighted areas with shininess)*/
+                                          // temporarily turning this off
+                                          {0.0f, 0.0f, 0.0f}, // ambient light (soft overall lighting)
+                                          {0.0f, 0.0f, 0.0f}, // diffuse light (intense light from the spotlight)
+                                          {0.0f, 0.0f, 0.0f}, // specular light (highlighted areas with shininess)
+                                          1.0f, 0.09f, 0.032f, glm::cos(glm::radians(12.5f)),
+                                          glm::cos(glm::radians(15.0f))});
+
+    light_uniform_manager.upload();
 }
 
+/**
+ * one frame of the scene as the simulation hands it to the gl thread, see FramePacketPipeline
+ */
+struct SceneFramePacket {
+    // written on the gl thread before the packet is simulated
+    double time_sec = 0;
+    double delta_time_sec = 0;
+    glm::mat4 projection{1.0f};
+    glm::mat4 view{1.0f};
+    glm::vec3 camera_position{0.0f};
+    glm::vec3 camera_forward{0.0f, 0.0f, -1.0f};
+
+    // written by the simulation
+    std::vector<std::pair<unsigned int, glm::mat4>> ltw_matrix_writes; // slot and matrix
+    std::vector<glm::mat4> bone_palette;
+    bool flame_light_active = false;
+    glm::vec3 flame_light_position{0.0f};
+    std::vector<unsigned int> draw_list; // object ids in draw order
+    std::vector<SoundType> queued_sounds;
+};
+
 // Wrapper that automatically creates a lambda for member functions
 template <typename T, typename R, typename... Args> auto wrap_member_function(T &obj, R (T::*f)(Args...)) {
     // Return a std::function that wraps the member function in a lambda
     return std::function<R(Args...)>{[&obj, f](Args &&...args) { return (obj.*f)(std::forward<Args>(args)...); }};
 }
 
+template <typename ShaderBatcher>
 void draw_packed_object(std::vector<IVPNTexturePacked> &packed_object, Transform &object_transform,
-                        glm::mat4 *ltw_matrices, Batcher &batcher) {
-    int ltw_mat_idx = packed_object[0].id;
-    ltw_matrices[ltw_mat_idx] = object_transform.get_transform_matrix();
+                        LtwMatrixSlots &ltw_matrix_slots, RetainedMeshRegistry<ShaderBatcher> &mesh_registry) {
+    // the attributes and the matrix slot are set up on the first draw only, all parts share the slot
+    if (not mesh_registry.is_registered(packed_object[0].id)) {
+        unsigned int ltw_mat_idx = ltw_matrix_slots.allocate();
+        for (auto &ivptp : packed_object) {
+            mesh_registry.register_mesh(ivptp, ltw_mat_idx);
+        }
+    }
+    unsigned int ltw_mat_idx = mesh_registry.get_ltw_matrix_slot(packed_object[0].id);
+    ltw_matrix_slots.set(ltw_mat_idx, object_transform.get_transform_matrix());
     for (auto &ivptp : packed_object) {
-        // hopefully the matrix at this index is an identity
-        std::vector<unsigned int> ltw_indices(ivptp.xyz_positions.size(), ltw_mat_idx);
-        std::vector<int> ptis(ivptp.xyz_positions.size(), ivptp.packed_texture_index);
-        std::vector<glm::ivec4> blank_bone_ids(ivptp.xyz_positions.size(), glm::ivec4(0, 0, 0, 0));
-        std::vector<glm::vec4> blank_bone_weights(ivptp.xyz_positions.size(), glm::vec4(0, 0, 0, 0));
-
-        batcher
-            .texture_packer_rigged_and_animated_cwl_v_transformation_ubos_1024_with_textures_and_multiple_lights_shader_batcher
-            .queue_draw(ivptp.id, ivptp.indices, ltw_indices, blank_bone_ids, blank_bone_weights, ptis,
-                        ivptp.packed_texture_coordinates, ivptp.normals, ivptp.xyz_positions);
+        mesh_registry.draw(ivptp.id);
     }
 }
 
-// so that you can attach an item to a bone and keep it attached while animations still play
-glm::mat4 get_the_transform_to_attach_an_object_to_a_bone(std::string bone_name, Transform &bone_origin_offset,
-                                                          RecIvpntRiggedCollector &rirc) {
-
-    int bone_index = rirc.bone_name_to_unique_index[bone_name];
-    BoneInfo bone_info = rirc.bone_unique_idx_to_info[bone_index];
-    auto the_transform_that_translates_the_origin_to_the_bones_origin =
-        glm::inverse(bone_info.local_space_to_bone_space_in_bind_pose_transformation);
-
-    // put it in the right spot, then git it some translation
-    the_transform_that_translates_the_origin_to_the_bones_origin =
-        bone_origin_offset.get_transform_matrix() * the_transform_that_translates_the_origin_to_the_bones_origin;
-    // then animate it which will work because the emitter is relative to the mesh in bind pose now.
-    auto animated_transform = bone_info.local_space_animated_transform_upto_this_bone *
-                              the_transform_that_translates_the_origin_to_the_bones_origin;
-
-    return animated_transform;
-}
-
 int main() {
 
     unsigned int flame_id = UniqueIDGenerator::generate();
-    bool flame_active = false;
     bool cigarette_light_active = false;
     std::vector<glm::vec3> flame_vertices = generate_rectangle_vertices(0, 0, .03, .03);
     std::vector<unsigned int> flame_indices = generate_rectangle_indices();
@@ -338,6 +171,10 @@ int main() {
 
     std::vector<spdlog::sink_ptr> sinks = {console_sink, file_sink};
 
+#ifdef ENABLE_FRAME_PROFILER
+    FrameProfiler::get().set_sinks(sinks);
+#endif
+
     LiveInputState live_input_state;
 
     GLFWwindow *window =
@@ -363,27 +200,126 @@ int main() {
     /*                             {"assets/packed_textures/container_0_atlas_visualization.png",*/
     /*                              "assets/packed_textures/container_1_atlas_visualization.png"});*/
 
-    TexturePacker texture_packer(
-        "assets/packed_textures/packed_texture.json",
-        {"assets/packed_textures/packed_texture_0.png", "assets/packed_textures/packed_texture_1.png"});
-
-    AnimatedTextureAtlas animated_texture_atlas("", "assets/images/flame.png", 50.0, texture_packer);
+    // model and fbx parsing runs on worker threads, anything that makes gl objects or hands out object ids (the
+    // UniqueIDGenerator isn't thread safe) runs here on the context thread
+    AssetJobGraph asset_job_graph;
+
+    std::optional<TexturePacker> texture_packer_storage;
+    AssetJobGraph::JobId texture_packer_job = asset_job_graph.add_job(
+        "texture packer",
+        [&] {
+            texture_packer_storage.emplace(
+                "assets/packed_textures/packed_texture.json",
+                std::vector<std::string>{"assets/packed_textures/packed_texture_0.png",
+                                         "assets/packed_textures/packed_texture_1.png"});
+        },
+        {}, AssetJobThread::CONTEXT_THREAD);
+
+    // the atlas and the uv table have to agree on it or the table's frames drift from the atlas's
+    const double flame_frame_duration_ms = 50.0;
+    std::optional<AnimatedTextureAtlas> animated_texture_atlas;
+    std::optional<AnimatedTextureUVTable> flame_uv_table_storage;
+    asset_job_graph.add_job(
+        "flame atlas",
+        [&] {
+            animated_texture_atlas.emplace("", "assets/images/flame.png", flame_frame_duration_ms,
+                                           *texture_packer_storage);
+            flame_uv_table_storage.emplace(*animated_texture_atlas, flame_frame_duration_ms);
+        },
+        {texture_packer_job}, AssetJobThread::CONTEXT_THREAD);
 
     /*AnimatedTextureAtlas animated_texture_atlas("", "assets/images/flame.png", 500.0, texture_packer);*/
 
+    // asking for the same model more than once shares both the parse and the packing
+    using ParsedModel = decltype(parse_model_into_ivpnts(std::string(), false));
+    std::unordered_map<std::string, ParsedModel> parsed_models;
+    std::unordered_map<std::string, std::vector<IVPNTexturePacked>> packed_models;
+    auto load_packed_model = [&](const std::string &model_path) {
+        // references into an unordered_map stay valid as more models are added
+        ParsedModel &parsed_model = parsed_models[model_path];
+        std::vector<IVPNTexturePacked> &packed_model = packed_models[model_path];
+        AssetJobGraph::JobId parse_job = asset_job_graph.add_deduplicated_job(
+            "parse " + model_path, "parse " + model_path,
+            [&parsed_model, model_path] { parsed_model = parse_model_into_ivpnts(model_path, false); });
+        return asset_job_graph.add_deduplicated_job(
+            "pack " + model_path, "pack " + model_path,
+            [&parsed_model, &packed_model, &texture_packer_storage] {
+                packed_model = convert_ivpnt_to_ivpntp(parsed_model, *texture_packer_storage);
+            },
+            {parse_job, texture_packer_job}, AssetJobThread::CONTEXT_THREAD);
+    };
+
+    const std::string crosshair_path = "assets/crosshair/3d_crosshair.obj";
+    const std::string lightbulb_path = "assets/lightbulb/lightbulb.obj";
+    load_packed_model(crosshair_path);
+    // we have four point lights atm
+    for (int i = 0; i < 4; i++) {
+        load_packed_model(lightbulb_path);
+    }
+
+    ScriptedEventTimeline scripted_event_timeline("assets/smoking/smoking_event.json");
+
+    // the rig is only run through assimp and the texture packer when the fbx or the packing changed since the last
+    // bake, otherwise the bake is memory mapped and used as is
+    /*const std::string smoking_fbx_path = "assets/test/test.fbx";*/
+    const std::string smoking_fbx_path = "assets/smoking/smoking.fbx";
+    const std::string baked_smoking_model_path = "baked_models/smoking.baked_rigged_model";
+    // the animation is only ever sampled while the scene plays
+    const double smoking_animation_duration_sec = scripted_event_timeline.get_end_time_sec();
+    const double smoking_animation_samples_per_sec = 60.0;
+    std::uint64_t smoking_model_source_hash;
+    std::shared_ptr<const BakedRiggedModel> baked_smoking_model;
     RecIvpntRiggedCollector rirc;
+    std::vector<IVPNTRigged> smoke_ivpntrs;
+    AssetJobGraph::JobId smoke_load_bake_job = asset_job_graph.add_job("load baked " + smoking_fbx_path, [&] {
+        // the duration comes from the event script, so a longer scene bakes a longer animation
+        smoking_model_source_hash =
+            hash_baked_rigged_model_sources({smoking_fbx_path, "assets/packed_textures/packed_texture.json"},
+                                            smoking_animation_duration_sec, smoking_animation_samples_per_sec);
+        baked_smoking_model = try_load_baked_rigged_model(baked_smoking_model_path, smoking_model_source_hash);
+    });
+    AssetJobGraph::JobId smoke_parse_job = asset_job_graph.add_job(
+        "parse " + smoking_fbx_path,
+        [&] {
+            if (not baked_smoking_model) {
+                smoke_ivpntrs = rirc.parse_model_into_ivpntrs(smoking_fbx_path);
+            }
+        },
+        {smoke_load_bake_job});
+    asset_job_graph.add_job(
+        "bake " + smoking_fbx_path,
+        [&] {
+            if (baked_smoking_model) {
+                return;
+            }
+            std::vector<IVPNTPRigged> smoke_ivptprs = convert_ivpnt_to_ivpntpr(smoke_ivpntrs, *texture_packer_storage);
+            bake_rigged_model(baked_smoking_model_path, smoking_model_source_hash, smoke_ivptprs, rirc,
+                              smoking_animation_duration_sec, smoking_animation_samples_per_sec);
+            baked_smoking_model = std::make_shared<const BakedRiggedModel>(baked_smoking_model_path);
+        },
+        {smoke_parse_job, texture_packer_job}, AssetJobThread::CONTEXT_THREAD);
+
+    asset_job_graph.run();
+    asset_job_graph.print_timing_report();
+
+    TexturePacker &texture_packer = *texture_packer_storage;
+    AnimatedTextureUVTable &flame_uv_table = *flame_uv_table_storage;
 
     Transform crosshair_transform = Transform();
     crosshair_transform.scale = glm::vec3(.01, .01, .01);
-    auto crosshair = parse_model_into_ivpnts("assets/crosshair/3d_crosshair.obj", false);
-    std::vector<IVPNTexturePacked> packed_crosshair = convert_ivpnt_to_ivpntp(crosshair, texture_packer);
+    std::vector<IVPNTexturePacked> packed_crosshair = packed_models.at(crosshair_path);
 
-    auto lightbulb = parse_model_into_ivpnts("assets/lightbulb/lightbulb.obj", false);
-    // we have four point lights atm
-    std::vector<IVPNTexturePacked> packed_lightbulb_1 = convert_ivpnt_to_ivpntp(lightbulb, texture_packer);
-    std::vector<IVPNTexturePacked> packed_lightbulb_2 = convert_ivpnt_to_ivpntp(lightbulb, texture_packer);
-    std::vector<IVPNTexturePacked> packed_lightbulb_3 = convert_ivpnt_to_ivpntp(lightbulb, texture_packer);
-    std::vector<IVPNTexturePacked> packed_lightbulb_4 = convert_ivpnt_to_ivpntp(lightbulb, texture_packer);
+    // the bulbs share one packed model, each copy only needs its own object ids
+    auto copy_with_new_object_ids = [](std::vector<IVPNTexturePacked> packed_model) {
+        for (auto &ivptp : packed_model) {
+            ivptp.id = UniqueIDGenerator::generate();
+        }
+        return packed_model;
+    };
+    std::vector<IVPNTexturePacked> packed_lightbulb_1 = packed_models.at(lightbulb_path);
+    std::vector<IVPNTexturePacked> packed_lightbulb_2 = copy_with_new_object_ids(packed_models.at(lightbulb_path));
+    std::vector<IVPNTexturePacked> packed_lightbulb_3 = copy_with_new_object_ids(packed_models.at(lightbulb_path));
+    std::vector<IVPNTexturePacked> packed_lightbulb_4 = copy_with_new_object_ids(packed_models.at(lightbulb_path));
 
     /*{{0, 0, 0}, {0.52f, 0.32f, 0.32f}, {0.1f, 0.1f, 0.1f}, {0.4f, 0.4f, 0.4f}, 1.0f, 0.09f, 0.032f},*/
     /*{{2, -2, 2}, {0.02f, 0.02f, 0.02f}, {0.1f, 0.1f, 0.1f}, {0.4f, 0.4f, 0.4f}, 1.0f, 0.09f, 0.032f},*/
@@ -401,25 +337,74 @@ int main() {
     auto lightbulb_4_transform = Transform();
     lightbulb_4_transform.position = glm::vec3(-.8, .8, .8);
 
-    /*std::vector<IVPNTRigged> smoke_ivpntrs = rirc.parse_model_into_ivpntrs("assets/test/test.fbx");*/
-    std::vector<IVPNTRigged> smoke_ivpntrs = rirc.parse_model_into_ivpntrs("assets/smoking/smoking.fbx");
-    std::vector<IVPNTPRigged> smoke_ivptprs = convert_ivpnt_to_ivpntpr(smoke_ivpntrs, texture_packer);
+    // every instance of the rig that samples the same moment of the animation shares one evaluation. the bake blends
+    // between its samples, so the cache keys poses four times finer than the bake to keep that smoothness
+    AnimationPoseCache animation_pose_cache(64, 4 * baked_smoking_model->get_samples_per_sec());
+    unsigned int smoking_clip_id =
+        animation_pose_cache.register_clip([&baked_smoking_model](double time_sec, AnimationPose &pose) {
+            baked_smoking_model->evaluate_pose(time_sec, pose);
+        });
+
+    // so that the emitters and the lighter stay attached while the animation plays
+    BoneSocketSystem bone_socket_system(baked_smoking_model->get_bone_name_to_index(),
+                                        baked_smoking_model->get_bind_pose_transforms());
+    Transform cig_tip_offset;
+    cig_tip_offset.position = glm::vec3(.05, 0, -.05);
+    unsigned int cig_tip_socket = bone_socket_system.register_socket("cig_root", cig_tip_offset);
+    Transform mouth_offset;
+    mouth_offset.position = glm::vec3(0, 0.02, .08);
+    unsigned int mouth_socket = bone_socket_system.register_socket("head", mouth_offset);
+    Transform lighter_offset;
+    lighter_offset.position = glm::vec3(-.02, 0, .05);
+    unsigned int lighter_socket = bone_socket_system.register_socket("lighter_root", lighter_offset);
+
+    // the shader's ltw matrix array has 1024 entries
+    LtwMatrixSlots ltw_matrix_slots(1024);
+
+    RetainedMeshRegistry mesh_registry(
+        batcher
+            .texture_packer_rigged_and_animated_cwl_v_transformation_ubos_1024_with_textures_and_multiple_lights_shader_batcher);
+    // the rig is moved by its bones, so all of its meshes share one identity matrix
+    unsigned int smoke_model_ltw_slot = ltw_matrix_slots.allocate();
+    std::vector<unsigned int> smoke_mesh_ids;
+    for (std::size_t mesh_index = 0; mesh_index < baked_smoking_model->get_mesh_count(); mesh_index++) {
+        BakedRiggedMeshView mesh = baked_smoking_model->get_mesh(mesh_index);
+        unsigned int mesh_id = UniqueIDGenerator::generate();
+        mesh_registry.register_mesh(mesh_id, smoke_model_ltw_slot, {mesh.indices.begin(), mesh.indices.end()},
+                                    {mesh.xyz_positions.begin(), mesh.xyz_positions.end()},
+                                    {mesh.normals.begin(), mesh.normals.end()},
+                                    {mesh.packed_texture_coordinates.begin(), mesh.packed_texture_coordinates.end()},
+                                    mesh.packed_texture_index, {mesh.bone_ids.begin(), mesh.bone_ids.end()},
+                                    {mesh.bone_weights.begin(), mesh.bone_weights.end()});
+        smoke_mesh_ids.push_back(mesh_id);
+    }
 
     glfwSwapInterval(0);
 
-    GLuint ltw_matrices_gl_name;
-    glm::mat4 ltw_matrices[1024];
+    // only the matrices written since the last frame get uploaded, through a persistently mapped ring when the
+    // context supports it
+    LtwMatrixUploader ltw_matrix_uploader(ltw_matrix_slots, 0, true);
 
-    // initialize all matrices to identity matrices
-    for (int i = 0; i < 1024; ++i) {
-        ltw_matrices[i] = glm::mat4(1.0f);
+    ShaderProgramInfo lit_shader_info = shader_cache.get_shader_program(
+        ShaderType::
+            TEXTURE_PACKER_RIGGED_AND_ANIMATED_CWL_V_TRANSFORMATION_UBOS_1024_WITH_TEXTURES_AND_MULTIPLE_LIGHTS);
+    LightUniformManager light_uniform_manager(lit_shader_info.id, 4);
+    set_static_shader_light_data(light_uniform_manager);
+    GLint bone_animation_transforms_location = glGetUniformLocation(
+        lit_shader_info.id, shader_cache.get_uniform_name(ShaderUniformVariable::BONE_ANIMATION_TRANSFORMS).c_str());
+
+    unsigned int cig_tip_ltw_slot = ltw_matrix_slots.allocate();
+    unsigned int mouth_ltw_slot = ltw_matrix_slots.allocate();
+    unsigned int lighter_ltw_slot = ltw_matrix_slots.allocate();
+
+    // every flame frame is its own mesh with a fixed id, drawing the flame is just picking the current one
+    for (unsigned int frame_index = 0; frame_index < flame_uv_table.get_num_frames(); frame_index++) {
+        auto frame_texture_coordinates = flame_uv_table.get_texture_coordinates(frame_index);
+        mesh_registry.register_mesh(flame_uv_table.get_object_id(frame_index), lighter_ltw_slot, flame_indices,
+                                    flame_vertices, flame_normals,
+                                    {frame_texture_coordinates.begin(), frame_texture_coordinates.end()}, 0);
     }
 
-    glGenBuffers(1, &ltw_matrices_gl_name);
-    glBindBuffer(GL_UNIFORM_BUFFER, ltw_matrices_gl_name);
-    glBufferData(GL_UNIFORM_BUFFER, sizeof(ltw_matrices), ltw_matrices, GL_STATIC_DRAW);
-    glBindBufferBase(GL_UNIFORM_BUFFER, 0, ltw_matrices_gl_name);
-
     std::unordered_map<SoundType, std::string> sound_type_to_file = {
         {SoundType::LIGHTER_FAIL, "assets/sounds/lighter_fail.mp3"},
         {SoundType::LIGHTER_SUCCESS, "assets/sounds/lighter_success.mp3"},
@@ -432,79 +417,97 @@ int main() {
         {SoundType::WOOSH, "assets/sounds/woosh.wav"},
     };
 
-    SoundSystem sound_system(100, sound_type_to_file);
+    // sounds are decoded in the background and kept under 32mb, the ambient track goes first
+    CachedSoundSystem<SoundType> sound_system(100, sound_type_to_file, 32 * 1024 * 1024);
 
     sound_system.queue_sound(SoundType::AMBIENT, glm::vec3(0, 0, 0));
 
-    std::vector<glm::vec2> packed_tex_coords_last_tick{};
-    int curr_obj_id = 1000;
-    int flame_obj_id = 1000;
-
     Transform spe_transform;
     spe_transform.position = glm::vec3(0, 0, 0);
     spe_transform.scale = glm::vec3(.2, .2, .2);
     CigaretteSmokeParticleEmitter cs_pe(300, spe_transform);
     BlowingSmokeParticleEmitter bs_pe(300, spe_transform);
     // turn off at first
-    bs_pe.particle_emitter.stop_emitting_particles();
-    cs_pe.particle_emitter.stop_emitting_particles();
-    ScriptedEvent scripted_event("assets/smoking/smoking_event.json");
+    bs_pe.stop_emitting_particles();
+    cs_pe.stop_emitting_particles();
+
+    // both emitters have to share the smoke ltw matrix slots and a slice of the frame
+    ParticleBudgetManager particle_budget_manager(400, 0.001);
+    unsigned int cs_pe_budget_id = particle_budget_manager.register_emitter("cigarette smoke", cs_pe.budget, 1.0f);
+    unsigned int bs_pe_budget_id = particle_budget_manager.register_emitter("blowing smoke", bs_pe.budget, 2.0f);
 
     std::vector<glm::ivec4> smoke_bone_ids(4, glm::ivec4(0, 0, 0, 0));   // 4 because square
     std::vector<glm::vec4> smoke_bone_weights(4, glm::vec4(0, 0, 0, 0)); // 4 because square
 
+    // the callbacks run on the frame packet worker, sounds go through the packet to be queued on the gl thread
+    std::vector<SoundType> sounds_queued_by_events;
+    auto queue_event_sound = [&](SoundType sound_type) { sounds_queued_by_events.push_back(sound_type); };
+
+    // the sound each event plays when it starts, both the callbacks and the prewarm order below are built from this
+    std::unordered_map<std::string, SoundType> event_name_to_sound_type = {
+        {"grab_pack", SoundType::GRAB},
+        {"grab_lighter", SoundType::GRAB},
+        {"ligher_flick_fail", SoundType::LIGHTER_FAIL},
+        {"inhale", SoundType::CIGARETTE_BURN},
+        {"exhale", SoundType::EXHALE},
+        {"grab_knife", SoundType::KNIFE_GRAB},
+        {"knife_throw", SoundType::WOOSH},
+        {"couch_stab", SoundType::STAB},
+    };
+
+    // what the events do besides playing their sound
     std::unordered_map<std::string, std::function<void(bool, bool)>> event_callbacks = {
-        {"grab_pack",
-         [&](bool first_call, bool last_call) { sound_system.queue_sound(SoundType::GRAB, glm::vec3(0.0)); }},
-        {"grab_lighter",
-         [&](bool first_call, bool last_call) { sound_system.queue_sound(SoundType::GRAB, glm::vec3(0.0)); }},
-        {"ligher_flick_fail",
-         [&](bool first_call, bool last_call) { sound_system.queue_sound(SoundType::LIGHTER_FAIL, glm::vec3(0.0)); }},
-        {"lighter_flick_success",
-         [&](bool first_call, bool last_call) {
-             sound_system.queue_sound(SoundType::LIGHTER_SUCCESS, glm::vec3(0.0));
-         }},
-        {"lighter_flame",
-         [&](bool first_call, bool last_call) {
-             if (first_call) {
-                 flame_active = true;
-             }
-             if (last_call) {
-                 flame_active = false;
-             }
-         }},
-        {"grab_knife",
-         [&](bool first_call, bool last_call) { sound_system.queue_sound(SoundType::KNIFE_GRAB, glm::vec3(0.0)); }},
-        {"knife_throw",
-         [&](bool first_call, bool last_call) { sound_system.queue_sound(SoundType::WOOSH, glm::vec3(0.0)); }},
-        {"couch_stab",
-         [&](bool first_call, bool last_call) { sound_system.queue_sound(SoundType::STAB, glm::vec3(0.0)); }},
         {"inhale",
          [&](bool first_call, bool last_call) {
              if (first_call) {
-                 sound_system.queue_sound(SoundType::CIGARETTE_BURN, glm::vec3(0.0));
                  cigarette_light_active = true;
-                 cs_pe.particle_emitter.stop_emitting_particles();
+                 cs_pe.stop_emitting_particles();
              }
 
              if (last_call) {
                  cigarette_light_active = false;
-                 cs_pe.particle_emitter.resume_emitting_particles();
+                 cs_pe.resume_emitting_particles();
                  return;
              }
          }},
         {"exhale",
          [&](bool first_call, bool last_call) {
              if (first_call) {
-                 sound_system.queue_sound(SoundType::EXHALE, glm::vec3(0.0));
-                 bs_pe.particle_emitter.resume_emitting_particles();
+                 bs_pe.resume_emitting_particles();
              }
 
              if (last_call) {
-                 bs_pe.particle_emitter.stop_emitting_particles();
+                 bs_pe.stop_emitting_particles();
              }
          }},
     };
+    for (const auto &[event_name, sound_type] : event_name_to_sound_type) {
+        // an event without a callback of its own gets an empty one here
+        std::function<void(bool, bool)> event_callback = std::move(event_callbacks[event_name]);
+        event_callbacks[event_name] = [&, sound_type = sound_type, event_callback](bool first_call, bool last_call) {
+            if (first_call) {
+                queue_event_sound(sound_type);
+            }
+            if (event_callback) {
+                event_callback(first_call, last_call);
+            }
+        };
+    }
+    scripted_event_timeline.bind_callbacks(event_callbacks);
+
+    // get the cues decoding in the order they fire so the first ones are ready soonest
+    for (unsigned int event_id : scripted_event_timeline.get_event_ids_in_firing_order()) {
+        auto it = event_name_to_sound_type.find(scripted_event_timeline.get_event_name(event_id));
+        if (it != event_name_to_sound_type.end()) {
+            sound_system.prewarm(it->second);
+        }
+    }
+    sound_system.prewarm(SoundType::LIGHTER_SUCCESS);
+
+    // the lighter flame and the flick that lights it come from the scene script instead of event callbacks
+    SceneStateTimeline scene_state_timeline("assets/scene_script.json");
+    unsigned int flame_draw_slot = scene_state_timeline.get_bool_slot("flame.draw");
+    unsigned int flick_play_slot = scene_state_timeline.get_bool_slot("flick.play");
 
     auto smoke_vertices = generate_square_vertices(0, 0, 0.5);
     auto smoke_indices = generate_rectangle_indices();
@@ -512,74 +515,110 @@ int main() {
     auto smoke_texture_coordinates =
         texture_packer.get_packed_texture_coordinates("assets/images/smoke_64px.png", smoke_local_uvs);
     auto smoke_pt_idx = texture_packer.get_packed_texture_index_of_texture("assets/images/smoke_64px.png");
-    std::vector<int> smoke_pt_idxs(4, smoke_pt_idx); // 4 because square
-
-    std::vector<ScriptedTransformKeyframe> keyframes = {
-        {glm::vec3(-2.42812, 0.75087, 1.23079), glm::vec3(-6.94999, 0.400007, 0), glm::vec3(1.0)},
-        {glm::vec3(-2.30063, 0.735328, 1.23168), glm::vec3(-6.94999, 0.400007, 0), glm::vec3(1.0)},
-        {glm::vec3(-1.44007, 0.609176, 1.54849), glm::vec3(-12.35, -42.35, 0), glm::vec3(1.0)},
-        {glm::vec3(-0.537447, 0.554101, 1.7012), glm::vec3(-14.25, -77.8, 0), glm::vec3(1.0)},
-        {glm::vec3(0.219981, 0.518201, 1.59799), glm::vec3(-16.4, -105.65, 0), glm::vec3(1.0)},
-        {glm::vec3(0.669285, 0.419364, 1.05889), glm::vec3(-16.85, -121.1, 0), glm::vec3(1.0)},
-        {glm::vec3(0.82821, 0.538547, 0.361138), glm::vec3(-19.45, -142.55, 0), glm::vec3(1.0)},
-        {glm::vec3(0.0950879, 0.840009, 0.121181), glm::vec3(-32.4999, -132.5, 0), glm::vec3(1.0)},
-        {glm::vec3(-0.762376, 1.22297, 0.309486), glm::vec3(-47.1498, -45.8001, 0), glm::vec3(1.0)},
-        {glm::vec3(-0.99569, 1.28449, 0.0686839), glm::vec3(-52.4997, -19.2001, 0), glm::vec3(1.0)},
-    };
-    ScriptedTransform scripted_transform(keyframes, 8000.0, 18000.0);
-    bool use_scripted_transform = true;
 
-    int width, height;
+    // every particle slot draws the same square through its own ltw matrix
+    for (auto particle_ids : {cs_pe.get_all_particle_ids(), bs_pe.get_all_particle_ids()}) {
+        for (unsigned int particle_id : particle_ids) {
+            mesh_registry.register_mesh(particle_id, ltw_matrix_slots.allocate(), smoke_indices, smoke_vertices,
+                                        flame_normals, smoke_texture_coordinates, smoke_pt_idx, smoke_bone_ids,
+                                        smoke_bone_weights);
+        }
+    }
 
-    double previous_time = glfwGetTime();
-    while (!glfwWindowShouldClose(window)) {
-        double current_time = glfwGetTime();
-        double delta_time = current_time - previous_time;
-        previous_time = current_time;
+    // compiled from assets/scripted_paths/smoking_camera.json by the scripted_path_compiler target
+    ScriptedTransform scripted_transform =
+        load_compiled_scripted_path("assets/scripted_paths/smoking_camera.scripted_path");
+    bool use_scripted_transform = true;
 
-        glfwGetFramebufferSize(window, &width, &height);
+    // turn on to run the scene update on the simulation thread in order, the frames come out the same as the parallel
+    // ones which is handy when something looks off and you want to rule the threading out
+    bool deterministic_scene_update = false;
+    WorkStealingScheduler scene_update_scheduler(WorkStealingScheduler::default_num_workers(),
+                                                 deterministic_scene_update);
+    // a billboard matrix is cheap, it takes a few hundred of them to be worth handing to another thread
+    const std::size_t particle_draw_grain_size = 256;
 
-        glViewport(0, 0, width, height);
+    int width, height;
 
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        glClearColor(0.1, 0.1, 0.1, 1.0);
+    // every subsystem reads the time from here so that they agree on what "now" is during a frame
+    SimulationClock simulation_clock(glfwGetTime);
 
-        // pass uniforms
-        camera.process_input(window, delta_time);
+    // input and the clock have to be read on this thread, the simulation gets a copy through the packet
+    auto prepare_scene_frame = [&](SceneFramePacket &packet) {
+        simulation_clock.tick();
+        packet.time_sec = simulation_clock.get_time_sec();
+        packet.delta_time_sec = simulation_clock.get_delta_time_sec();
 
-        scripted_transform.update(current_time * 1000.0);
+        camera.process_input(window, packet.delta_time_sec);
+
+        FRAME_PROFILER_NAMED_ZONE(scripted_transform_zone, "scripted transform");
+        scripted_transform.update(simulation_clock.get_time_ms());
         if (use_scripted_transform) {
             camera.transform.position = scripted_transform.transform.position;
             camera.transform.rotation = scripted_transform.transform.rotation;
         }
+        FRAME_PROFILER_ZONE_END(scripted_transform_zone);
 
-        glm::mat4 projection = camera.get_projection_matrix();
-        glm::mat4 view = camera.get_view_matrix();
-
-        shader_cache.set_uniform(
-            ShaderType::
-                TEXTURE_PACKER_RIGGED_AND_ANIMATED_CWL_V_TRANSFORMATION_UBOS_1024_WITH_TEXTURES_AND_MULTIPLE_LIGHTS,
-            ShaderUniformVariable::CAMERA_TO_CLIP, projection);
-        shader_cache.set_uniform(
-            ShaderType::
-                TEXTURE_PACKER_RIGGED_AND_ANIMATED_CWL_V_TRANSFORMATION_UBOS_1024_WITH_TEXTURES_AND_MULTIPLE_LIGHTS,
-            ShaderUniformVariable::WORLD_TO_CAMERA, view);
-
-        cs_pe.particle_emitter.update(delta_time, projection * view);
-        auto cs_particles = cs_pe.particle_emitter.get_particles_sorted_by_distance();
-
-        bs_pe.particle_emitter.update(delta_time, projection * view);
-        auto bs_particles = bs_pe.particle_emitter.get_particles_sorted_by_distance();
+        packet.projection = camera.get_projection_matrix();
+        packet.view = camera.get_view_matrix();
+        packet.camera_position = camera.transform.position;
+        packet.camera_forward = camera.transform.compute_forward_vector();
+    };
 
+    // everything in here runs on the frame packet worker, it must not make gl calls or queue draws, only write the
+    // packet. the emitters, bones, event timeline and the event callbacks belong to this thread while the loop runs
+    auto simulate_scene_frame = [&](SceneFramePacket &packet) {
+        packet.ltw_matrix_writes.clear();
+        packet.draw_list.clear();
+        packet.queued_sounds.clear();
+
+        // the two emitters and the bones don't share anything so they update side by side, the rebalance reads where
+        // the emitters were so it waits on both of them. the socket attachment below moves the emitters, it runs once
+        // everything here is done
+        std::span<const unsigned int> cs_particles, bs_particles;
+
+        auto cs_update_task = scene_update_scheduler.add_task([&] {
+            FRAME_PROFILER_ZONE("cigarette smoke update and sort");
+            cs_pe.update(packet.delta_time_sec, packet.projection * packet.view);
+            cs_particles = cs_pe.get_particles_sorted_by_distance();
+        });
+
+        auto bs_update_task = scene_update_scheduler.add_task([&] {
+            FRAME_PROFILER_ZONE("blowing smoke update and sort");
+            bs_pe.update(packet.delta_time_sec, packet.projection * packet.view);
+            bs_particles = bs_pe.get_particles_sorted_by_distance();
+        });
+
+        scene_update_scheduler.add_task([&] {
+            FRAME_PROFILER_ZONE("bone evaluation");
+            const AnimationPose &animation_pose = animation_pose_cache.get_pose(smoking_clip_id, packet.time_sec);
+            bone_socket_system.evaluate(animation_pose);
+            packet.bone_palette = animation_pose.bone_palette;
+        });
+
+        scene_update_scheduler.add_task(
+            [&] {
+                FRAME_PROFILER_ZONE("particle budget rebalance");
+                // closer smoke covers more of the screen
+                particle_budget_manager.set_screen_importance(
+                    cs_pe_budget_id, 1.0f / (1.0f + glm::distance(packet.camera_position, cs_pe.transform.position)));
+                particle_budget_manager.set_screen_importance(
+                    bs_pe_budget_id, 1.0f / (1.0f + glm::distance(packet.camera_position, bs_pe.transform.position)));
+                particle_budget_manager.rebalance();
+            },
+            {cs_update_task, bs_update_task});
+
+        scene_update_scheduler.run_tasks();
+        FRAME_PROFILER_COUNTER("particles", cs_particles.size() + bs_particles.size());
+
+        FRAME_PROFILER_NAMED_ZONE(socket_attachment_zone, "socket attachment");
         // VVV CIG
 
-        auto custom_transform = Transform();
-        custom_transform.position = glm::vec3(.05, 0, -.05);
-        auto smoke_emitter_at_cig_tip_transform =
-            get_the_transform_to_attach_an_object_to_a_bone("cig_root", custom_transform, rirc);
+        auto smoke_emitter_at_cig_tip_transform = bone_socket_system.get_socket_transform(cig_tip_socket);
 
-        cs_pe.particle_emitter.transform.set_transform_matrix(smoke_emitter_at_cig_tip_transform);
-        ltw_matrices[0] = smoke_emitter_at_cig_tip_transform * crosshair_transform.get_transform_matrix();
+        cs_pe.transform.set_transform_matrix(smoke_emitter_at_cig_tip_transform);
+        packet.ltw_matrix_writes.emplace_back(cig_tip_ltw_slot, smoke_emitter_at_cig_tip_transform *
+                                                                    crosshair_transform.get_transform_matrix());
 
         glm::vec4 cig_light_pos = smoke_emitter_at_cig_tip_transform * glm::vec4(.05, 0, -.05, 1);
         glm::vec3 cig_light_pos_3d = glm::vec3(cig_light_pos);
@@ -587,245 +626,228 @@ int main() {
         // ^^^ CIG
 
         // VVV MOUTH
-        custom_transform = Transform();
-        custom_transform.position = glm::vec3(0, 0.02, .08);
-        auto smoke_emitter_at_mouth_transform =
-            get_the_transform_to_attach_an_object_to_a_bone("head", custom_transform, rirc);
+        auto smoke_emitter_at_mouth_transform = bone_socket_system.get_socket_transform(mouth_socket);
 
-        bs_pe.particle_emitter.transform.set_transform_matrix(smoke_emitter_at_mouth_transform);
+        bs_pe.transform.set_transform_matrix(smoke_emitter_at_mouth_transform);
         /*ltw_matrices[1] = smoke_emitter_at_mouth_transform * crosshair_transform.get_transform_matrix();*/
-        ltw_matrices[1] = smoke_emitter_at_mouth_transform * crosshair_transform.get_transform_matrix();
+        packet.ltw_matrix_writes.emplace_back(mouth_ltw_slot, smoke_emitter_at_mouth_transform *
+                                                                  crosshair_transform.get_transform_matrix());
         // ^^^ MOUTH
         //
         // VVV LIGHTER
-        custom_transform = Transform();
-        custom_transform.position = glm::vec3(-.02, 0, .05);
-        auto lighter_transform =
-            get_the_transform_to_attach_an_object_to_a_bone("lighter_root", custom_transform, rirc);
+        auto lighter_transform = bone_socket_system.get_socket_transform(lighter_socket);
 
         /*ltw_matrices[packed_crosshair[0].id] = lighter_transform * crosshair_transform.get_transform_matrix();*/
         /*ltw_matrices[1] = lighter_transform * crosshair_transform.get_transform_matrix();*/
-        ltw_matrices[1] = lighter_transform;
+        packet.ltw_matrix_writes.emplace_back(lighter_ltw_slot, lighter_transform);
 
         glm::vec4 lighter_flame_pos = lighter_transform * glm::vec4(-.02, 0, .02, 1);
         glm::vec3 lighter_flame_pos_3d = glm::vec3(lighter_flame_pos);
         // ^^^ LIGHTER
-
-        if (flame_active) {
-            set_shader_light_data(camera, shader_cache, true, lighter_flame_pos_3d);
-        } else if (cigarette_light_active) {
-            set_shader_light_data(camera, shader_cache, true, cig_light_pos_3d);
-        } else {
-            set_shader_light_data(camera, shader_cache, false, glm::vec3(0));
-        }
-
-        /*draw_packed_object(packed_crosshair, crosshair_transform, ltw_matrices, batcher);*/
-        /*for (auto &ivptp : packed_crosshair) {*/
-        /*    // hopefully the matrix at this index is an identity*/
-        /*    std::vector<unsigned int> ltw_indices(ivptp.xyz_positions.size(), 1);*/
-        /*    std::vector<int> ptis(ivptp.xyz_positions.size(), ivptp.packed_texture_index);*/
-        /*    std::vector<glm::ivec4> blank_bone_ids(ivptp.xyz_positions.size(), glm::ivec4(0, 0, 0, 0));*/
-        /*    std::vector<glm::vec4> blank_bone_weights(ivptp.xyz_positions.size(), glm::vec4(0, 0, 0, 0));*/
-        /**/
-        /*    batcher*/
-        /*        .texture_packer_rigged_and_animated_cwl_v_transformation_ubos_1024_with_textures_and_multiple_lights_shader_batcher*/
-        /*        .queue_draw(ivptp.id, ivptp.indices, ltw_indices, blank_bone_ids, blank_bone_weights, ptis,*/
-        /*                    ivptp.packed_texture_coordinates, ivptp.normals, ivptp.xyz_positions);*/
-        /*}*/
-
-        /*draw_packed_object(packed_lightbulb_1, lightbulb_1_transform, ltw_matrices, batcher);*/
-        /*draw_packed_object(packed_lightbulb_2, lightbulb_2_transform, ltw_matrices, batcher);*/
-        /*draw_packed_object(packed_lightbulb_3, lightbulb_3_transform, ltw_matrices, batcher);*/
-        /*draw_packed_object(packed_lightbulb_4, lightbulb_4_transform, ltw_matrices, batcher);*/
-
-        /*for (auto &ivptp : packed_lightbulb) {*/
-        /*    // hopefully the matrix at this index is an identity*/
-        /*    std::vector<unsigned int> ltw_indices(ivptp.xyz_positions.size(), 0);*/
-        /*    std::vector<int> ptis(ivptp.xyz_positions.size(), ivptp.packed_texture_index);*/
-        /*    std::vector<glm::ivec4> blank_bone_ids(ivptp.xyz_positions.size(), glm::ivec4(0, 0, 0, 0));*/
-        /*    std::vector<glm::vec4> blank_bone_weights(ivptp.xyz_positions.size(), glm::vec4(0, 0, 0, 0));*/
-        /**/
-        /*    batcher*/
-        /*        .texture_packer_rigged_and_animated_cwl_v_transformation_ubos_1024_with_textures_and_multiple_lights_shader_batcher*/
-        /*        .queue_draw(ivptp.id, ivptp.indices, ltw_indices, blank_bone_ids, blank_bone_weights, ptis,*/
-        /*                    ivptp.packed_texture_coordinates, ivptp.normals, ivptp.xyz_positions);*/
-        /*}*/
-
-        // run scripted events
-
-        std::vector<glm::mat4> bone_transformations;
-        float animation_time_sec = glfwGetTime();
-        rirc.set_bone_transforms(animation_time_sec, bone_transformations);
-
-        const unsigned int MAX_BONES_TO_BE_USED = 100;
-        ShaderProgramInfo shader_info = shader_cache.get_shader_program(
-            ShaderType::
-                TEXTURE_PACKER_RIGGED_AND_ANIMATED_CWL_V_TRANSFORMATION_UBOS_1024_WITH_TEXTURES_AND_MULTIPLE_LIGHTS);
-        GLint location = glGetUniformLocation(
-            shader_info.id, shader_cache.get_uniform_name(ShaderUniformVariable::BONE_ANIMATION_TRANSFORMS).c_str());
-        glUniformMatrix4fv(location, MAX_BONES_TO_BE_USED, GL_FALSE, glm::value_ptr(bone_transformations[0]));
-
-        for (auto &ivptr : smoke_ivptprs) {
-            // Populate bone_indices and bone_weights
-            std::vector<glm::ivec4> bone_indices;
-            std::vector<glm::vec4> bone_weights;
-
-            for (const auto &vertex_bone_data : ivptr.bone_data) {
-                glm::ivec4 indices(static_cast<int>(vertex_bone_data.indices_of_bones_that_affect_this_vertex[0]),
-                                   static_cast<int>(vertex_bone_data.indices_of_bones_that_affect_this_vertex[1]),
-                                   static_cast<int>(vertex_bone_data.indices_of_bones_that_affect_this_vertex[2]),
-                                   static_cast<int>(vertex_bone_data.indices_of_bones_that_affect_this_vertex[3]));
-
-                glm::vec4 weights(vertex_bone_data.weight_value_of_this_vertex_wrt_bone[0],
-                                  vertex_bone_data.weight_value_of_this_vertex_wrt_bone[1],
-                                  vertex_bone_data.weight_value_of_this_vertex_wrt_bone[2],
-                                  vertex_bone_data.weight_value_of_this_vertex_wrt_bone[3]);
-
-                bone_indices.push_back(indices);
-                bone_weights.push_back(weights);
+        FRAME_PROFILER_ZONE_END(socket_attachment_zone);
+
+        FRAME_PROFILER_NAMED_ZONE(scene_state_zone, "scene state");
+        scene_state_timeline.advance(packet.time_sec * 1000.0);
+        const SceneState &scene_state = scene_state_timeline.get_current_state();
+        bool flame_active = scene_state.bools[flame_draw_slot];
+        // the flick sound plays when flick.play turns on
+        for (const SceneStateSlot &slot : scene_state_timeline.get_slots_changed_by_last_advance()) {
+            if (slot.type == SceneStateSlotType::BOOL and slot.index == flick_play_slot and
+                scene_state.bools[flick_play_slot]) {
+                queue_event_sound(SoundType::LIGHTER_SUCCESS);
             }
+        }
+        FRAME_PROFILER_ZONE_END(scene_state_zone);
 
-            std::vector<int> packed_texture_indices(ivptr.xyz_positions.size(), ivptr.packed_texture_index);
+        packet.flame_light_active = flame_active or cigarette_light_active;
+        packet.flame_light_position = flame_active ? lighter_flame_pos_3d : cig_light_pos_3d;
 
-            std::vector<unsigned int> ltw_indices(ivptr.xyz_positions.size(), ivptr.id);
-            batcher
-                .texture_packer_rigged_and_animated_cwl_v_transformation_ubos_1024_with_textures_and_multiple_lights_shader_batcher
-                .queue_draw(ivptr.id, ivptr.indices, ltw_indices, bone_indices, bone_weights, packed_texture_indices,
-                            ivptr.packed_texture_coordinates, ivptr.normals, ivptr.xyz_positions);
+        FRAME_PROFILER_NAMED_ZONE(draw_list_zone, "draw list");
+        for (unsigned int smoke_mesh_id : smoke_mesh_ids) {
+            packet.draw_list.push_back(smoke_mesh_id);
         }
 
-        for (size_t i = 0; i < cs_particles.size(); ++i) {
+        //  compute the up vector (assuming we want it to be along the y-axis)
+        glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
+        glm::vec3 forward = packet.camera_forward;
 
-            auto &curr_particle = cs_particles[i];
+        glm::vec3 right = glm::normalize(glm::cross(up, forward));
 
-            //  compute the up vector (assuming we want it to be along the y-axis)
-            glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
-            glm::vec3 forward = camera.transform.compute_forward_vector();
+        up = glm::normalize(glm::cross(forward, right));
 
-            glm::vec3 right = glm::normalize(glm::cross(up, forward));
+        // this makes it billboarded
+        glm::mat4 rotation_matrix = glm::mat4(1.0f);
+        rotation_matrix[0] = glm::vec4(right, 0.0f);
+        rotation_matrix[1] = glm::vec4(up, 0.0f);
+        rotation_matrix[2] = glm::vec4(-forward, 0.0f); // We negate the direction for correct facing
 
-            up = glm::normalize(glm::cross(forward, right));
+        // every particle owns one entry of each list, so the chunks write into their own ranges and the draw order
+        // stays the sorted order no matter which thread got which chunk
+        std::size_t ltw_matrix_writes_begin = packet.ltw_matrix_writes.size();
+        std::size_t draw_list_begin = packet.draw_list.size();
+        std::size_t num_particle_draws = cs_particles.size() + bs_particles.size();
+        packet.ltw_matrix_writes.resize(ltw_matrix_writes_begin + num_particle_draws);
+        packet.draw_list.resize(draw_list_begin + num_particle_draws);
 
-            // this makes it billboarded
-            glm::mat4 rotation_matrix = glm::mat4(1.0f);
-            rotation_matrix[0] = glm::vec4(right, 0.0f);
-            rotation_matrix[1] = glm::vec4(up, 0.0f);
-            rotation_matrix[2] = glm::vec4(-forward, 0.0f); // We negate the direction for correct facing
+        auto add_particle_draw = [&](const auto &particle_emitter, unsigned int particle_index, std::size_t draw_index) {
+            glm::vec3 particle_position = particle_emitter.get_position(particle_index);
+            unsigned int particle_id = particle_emitter.get_id(particle_index);
 
             // I think this is bad.
-            glm::mat4 transform = glm::translate(glm::mat4(1.0f), curr_particle.transform.position);
+            glm::mat4 transform = glm::translate(glm::mat4(1.0f), particle_position);
             transform *= rotation_matrix;
-            transform = glm::scale(transform, curr_particle.transform.scale);
-            transform = glm::scale(transform, curr_particle.emitter_transform.scale);
-
-            // temporary
-            ltw_matrices[curr_particle.id] = transform;
-
-            if (curr_particle.is_alive()) {
+            transform = glm::scale(transform, glm::vec3(particle_emitter.get_scale(particle_index)));
+            transform = glm::scale(transform, particle_emitter.get_emitter_scale(particle_index));
 
-                auto nv = generate_rectangle_vertices_3d(curr_particle.transform.position,
-                                                         camera.transform.compute_right_vector(),
-                                                         camera.transform.compute_up_vector(), 1, 1);
+            packet.ltw_matrix_writes[ltw_matrix_writes_begin + draw_index] = {
+                mesh_registry.get_ltw_matrix_slot(particle_id), transform};
+            packet.draw_list[draw_list_begin + draw_index] = particle_id;
+        };
+        // the cigarette smoke comes first, then the blowing smoke
+        scene_update_scheduler.parallel_for(
+            0, num_particle_draws, particle_draw_grain_size, [&](std::size_t chunk_begin, std::size_t chunk_end) {
+                for (std::size_t draw_index = chunk_begin; draw_index < chunk_end; draw_index++) {
+                    if (draw_index < cs_particles.size()) {
+                        add_particle_draw(cs_pe, cs_particles[draw_index], draw_index);
+                    } else {
+                        add_particle_draw(bs_pe, bs_particles[draw_index - cs_particles.size()], draw_index);
+                    }
+                }
+            });
 
-                std::vector<unsigned int> smoke_ltw_mat_idxs(4, curr_particle.id);
-                batcher
-                    .texture_packer_rigged_and_animated_cwl_v_transformation_ubos_1024_with_textures_and_multiple_lights_shader_batcher
-                    .queue_draw(curr_particle.id, smoke_indices, smoke_ltw_mat_idxs, smoke_bone_ids, smoke_bone_weights,
-                                smoke_pt_idxs, smoke_texture_coordinates, flame_normals, smoke_vertices);
-            }
+        if (flame_active) {
+            double ms_curr_time = packet.time_sec * 1000.0;
+            packet.draw_list.push_back(flame_uv_table.get_object_id(flame_uv_table.get_frame_index(ms_curr_time)));
         }
+        FRAME_PROFILER_ZONE_END(draw_list_zone);
 
-        for (size_t i = 0; i < bs_particles.size(); ++i) {
+        {
+            FRAME_PROFILER_ZONE("scripted events");
+            scripted_event_timeline.run_scripted_events(packet.time_sec);
+            packet.queued_sounds.swap(sounds_queued_by_events);
+        }
+    };
 
-            auto &curr_particle = bs_particles[i];
+    // the gl thread renders frame n while the worker simulates frame n + 1
+    FramePacketPipeline<SceneFramePacket> frame_packet_pipeline(simulate_scene_frame);
+    frame_packet_pipeline.begin_simulation(prepare_scene_frame);
 
-            //  compute the up vector (assuming we want it to be along the y-axis)
-            glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
-            glm::vec3 forward = camera.transform.compute_forward_vector();
+    while (!glfwWindowShouldClose(window)) {
+        frame_packet_pipeline.begin_simulation(prepare_scene_frame);
+        const SceneFramePacket &packet = frame_packet_pipeline.acquire_packet_to_render();
 
-            glm::vec3 right = glm::normalize(glm::cross(up, forward));
+        glfwGetFramebufferSize(window, &width, &height);
 
-            up = glm::normalize(glm::cross(forward, right));
+        glViewport(0, 0, width, height);
 
-            // this makes it billboarded
-            glm::mat4 rotation_matrix = glm::mat4(1.0f);
-            rotation_matrix[0] = glm::vec4(right, 0.0f);
-            rotation_matrix[1] = glm::vec4(up, 0.0f);
-            rotation_matrix[2] = glm::vec4(-forward, 0.0f); // We negate the direction for correct facing
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glClearColor(0.1, 0.1, 0.1, 1.0);
 
-            // I think this is bad.
-            glm::mat4 transform = glm::translate(glm::mat4(1.0f), curr_particle.transform.position);
-            transform *= rotation_matrix;
-            transform = glm::scale(transform, curr_particle.transform.scale);
-            transform = glm::scale(transform, curr_particle.emitter_transform.scale);
+        // pass uniforms
+        shader_cache.set_uniform(
+            ShaderType::
+                TEXTURE_PACKER_RIGGED_AND_ANIMATED_CWL_V_TRANSFORMATION_UBOS_1024_WITH_TEXTURES_AND_MULTIPLE_LIGHTS,
+            ShaderUniformVariable::CAMERA_TO_CLIP, packet.projection);
+        shader_cache.set_uniform(
+            ShaderType::
+                TEXTURE_PACKER_RIGGED_AND_ANIMATED_CWL_V_TRANSFORMATION_UBOS_1024_WITH_TEXTURES_AND_MULTIPLE_LIGHTS,
+            ShaderUniformVariable::WORLD_TO_CAMERA, packet.view);
 
-            // temporary
-            ltw_matrices[curr_particle.id] = transform;
+        {
+            FRAME_PROFILER_ZONE("light uniforms");
+            set_shader_light_data(packet.camera_position, packet.camera_forward, light_uniform_manager,
+                                  packet.flame_light_active, packet.flame_light_position, packet.time_sec);
+        }
 
-            if (curr_particle.is_alive()) {
+        FRAME_PROFILER_NAMED_ZONE(queue_draws_zone, "queue draws");
+        mesh_registry.reset_draw_count();
 
-                auto nv = generate_rectangle_vertices_3d(curr_particle.transform.position,
-                                                         camera.transform.compute_right_vector(),
-                                                         camera.transform.compute_up_vector(), 1, 1);
+        const unsigned int MAX_BONES_TO_BE_USED = 100;
+        glUniformMatrix4fv(bone_animation_transforms_location, MAX_BONES_TO_BE_USED, GL_FALSE,
+                           glm::value_ptr(packet.bone_palette[0]));
 
-                std::vector<unsigned int> smoke_ltw_mat_idxs(4, curr_particle.id);
-                batcher
-                    .texture_packer_rigged_and_animated_cwl_v_transformation_ubos_1024_with_textures_and_multiple_lights_shader_batcher
-                    .queue_draw(curr_particle.id, smoke_indices, smoke_ltw_mat_idxs, smoke_bone_ids, smoke_bone_weights,
-                                smoke_pt_idxs, smoke_texture_coordinates, flame_normals, smoke_vertices);
-            }
+        for (const auto &[ltw_matrix_slot, ltw_matrix] : packet.ltw_matrix_writes) {
+            ltw_matrix_slots.set(ltw_matrix_slot, ltw_matrix);
         }
 
-        /*if (flame_active) {*/
-        if (true) {
-            double ms_curr_time = glfwGetTime() * 1000;
-
-            std::vector<glm::vec2> packed_tex_coords =
+        for (unsigned int object_id : packet.draw_list) {
+            mesh_registry.draw(object_id);
+        }
 
-                animated_texture_atlas.get_texture_coordinates_of_current_animation_frame(ms_curr_time);
+        /*draw_packed_object(packed_crosshair, crosshair_transform, ltw_matrix_slots, mesh_registry);*/
+        /*for (auto &ivptp : packed_crosshair) {*/
+        /*    // hopefully the matrix at this index is an identity*/
+        /*    std::vector<unsigned int> ltw_indices(ivptp.xyz_positions.size(), 1);*/
+        /*    std::vector<int> ptis(ivptp.xyz_positions.size(), ivptp.packed_texture_index);*/
+        /*    std::vector<glm::ivec4> blank_bone_ids(ivptp.xyz_positions.size(), glm::ivec4(0, 0, 0, 0));*/
+        /*    std::vector<glm::vec4> blank_bone_weights(ivptp.xyz_positions.size(), glm::vec4(0, 0, 0, 0));*/
+        /**/
+        /*    batcher*/
+        /*        .texture_packer_rigged_and_animated_cwl_v_transformation_ubos_1024_with_textures_and_multiple_lights_shader_batcher*/
+        /*        .queue_draw(ivptp.id, ivptp.indices, ltw_indices, blank_bone_ids, blank_bone_weights, ptis,*/
+        /*                    ivptp.packed_texture_coordinates, ivptp.normals, ivptp.xyz_positions);*/
+        /*}*/
 
-            /*auto packed_tex_coords =*/
-            /*    texture_packer.get_packed_texture_coordinates("assets/images/alphabet.png",
-             * atlas_texture_coordinates);*/
+        /*draw_packed_object(packed_lightbulb_1, lightbulb_1_transform, ltw_matrix_slots, mesh_registry);*/
+        /*draw_packed_object(packed_lightbulb_2, lightbulb_2_transform, ltw_matrix_slots, mesh_registry);*/
+        /*draw_packed_object(packed_lightbulb_3, lightbulb_3_transform, ltw_matrix_slots, mesh_registry);*/
+        /*draw_packed_object(packed_lightbulb_4, lightbulb_4_transform, ltw_matrix_slots, mesh_registry);*/
 
-            bool new_coords = false;
-            if (packed_tex_coords != packed_tex_coords_last_tick) {
-                new_coords = true;
-                curr_obj_id += 1;
-            }
+        /*for (auto &ivptp : packed_lightbulb) {*/
+        /*    // hopefully the matrix at this index is an identity*/
+        /*    std::vector<unsigned int> ltw_indices(ivptp.xyz_positions.size(), 0);*/
+        /*    std::vector<int> ptis(ivptp.xyz_positions.size(), ivptp.packed_texture_index);*/
+        /*    std::vector<glm::ivec4> blank_bone_ids(ivptp.xyz_positions.size(), glm::ivec4(0, 0, 0, 0));*/
+        /*    std::vector<glm::vec4> blank_bone_weights(ivptp.xyz_positions.size(), glm::vec4(0, 0, 0, 0));*/
+        /**/
+        /*    batcher*/
+        /*        .texture_packer_rigged_and_animated_cwl_v_transformation_ubos_1024_with_textures_and_multiple_lights_shader_batcher*/
+        /*        .queue_draw(ivptp.id, ivptp.indices, ltw_indices, blank_bone_ids, blank_bone_weights, ptis,*/
+        /*                    ivptp.packed_texture_coordinates, ivptp.normals, ivptp.xyz_positions);*/
+        /*}*/
 
-            packed_tex_coords_last_tick = packed_tex_coords;
+        FRAME_PROFILER_ZONE_END(queue_draws_zone);
+        FRAME_PROFILER_COUNTER("draws", mesh_registry.get_draw_count());
 
-            const std::vector<int> packed_texture_indices(4, 0);
-            std::vector<unsigned int> ltw_mat_idxs(4, 1);
+        {
+            FRAME_PROFILER_ZONE("ltw upload");
+            // load in the matrices before anything that reads them is drawn
+            ltw_matrix_uploader.upload();
+        }
+        FRAME_PROFILER_COUNTER("ltw bytes uploaded", ltw_matrix_uploader.get_bytes_uploaded_last_frame());
 
+        {
+            FRAME_PROFILER_ZONE("draw everything");
             batcher
                 .texture_packer_rigged_and_animated_cwl_v_transformation_ubos_1024_with_textures_and_multiple_lights_shader_batcher
-                .queue_draw(curr_obj_id, flame_indices, ltw_mat_idxs, smoke_bone_ids, smoke_bone_weights,
-                            packed_texture_indices, packed_tex_coords, flame_normals, flame_vertices);
+                .draw_everything();
         }
 
-        double curr_time_sec = glfwGetTime();
-        scripted_event.run_scripted_events(curr_time_sec, event_callbacks);
-
-        batcher
-            .texture_packer_rigged_and_animated_cwl_v_transformation_ubos_1024_with_textures_and_multiple_lights_shader_batcher
-            .draw_everything();
-
-        sound_system.play_all_sounds();
+        {
+            FRAME_PROFILER_ZONE("play sounds");
+            for (SoundType sound_type : packet.queued_sounds) {
+                sound_system.queue_sound(sound_type, glm::vec3(0.0));
+            }
+            sound_system.play_all_sounds();
+        }
 
-        // load in the matrices
-        glBindBuffer(GL_UNIFORM_BUFFER, ltw_matrices_gl_name);
-        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(ltw_matrices), ltw_matrices);
-        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        frame_packet_pipeline.release_rendered_packet();
 
         /*batcher.texture_packer_cwl_v_transformation_ubos_1024_multiple_lights_shader_batcher.draw_everything();*/
         // -------------------
 
         glfwSwapBuffers(window);
         glfwPollEvents();
+
+        FRAME_PROFILER_FRAME_MARK();
     }
 
+    frame_packet_pipeline.stop();
+
+#ifdef ENABLE_FRAME_PROFILER
+    FrameProfiler::get().write_chrome_trace("frame_profile.json");
+#endif
+
     glfwDestroyWindow(window);
 
     glfwTerminate();
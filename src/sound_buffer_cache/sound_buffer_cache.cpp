@@ -0,0 +1,245 @@
+#include "sound_buffer_cache.hpp"
+
+#include <sndfile.h>
+
+#include <iostream>
+#include <utility>
+
+SoundBufferCache::SoundBufferCache(std::size_t memory_budget_bytes)
+    : memory_budget_bytes{memory_budget_bytes}, memory_usage_bytes{0}, eviction_count{0}, decodes_in_flight{0},
+      stopping{false} {
+    decode_thread = std::thread(&SoundBufferCache::decode_loop, this);
+}
+
+SoundBufferCache::~SoundBufferCache() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        stopping = true;
+    }
+    queue_condition.notify_all();
+    decode_thread.join();
+
+    for (auto &[file_path, entry] : entries) {
+        if (entry.buffer != 0) {
+            alDeleteBuffers(1, &entry.buffer);
+        }
+    }
+}
+
+void SoundBufferCache::request(const std::string &file_path) {
+    if (entries.find(file_path) != entries.end()) {
+        return;
+    }
+    entries.emplace(file_path, Entry{});
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        pending_decodes.push_back(file_path);
+        decodes_in_flight++;
+    }
+    queue_condition.notify_one();
+}
+
+void SoundBufferCache::prewarm(const std::vector<std::string> &file_paths) {
+    for (const std::string &file_path : file_paths) {
+        request(file_path);
+    }
+}
+
+void SoundBufferCache::update() {
+    std::vector<DecodedSound> decoded_sounds;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        if (finished_decodes.empty()) {
+            return;
+        }
+        decoded_sounds.swap(finished_decodes);
+    }
+
+    for (DecodedSound &decoded_sound : decoded_sounds) {
+        upload(decoded_sound);
+    }
+    evict_to_budget();
+}
+
+bool SoundBufferCache::is_ready(const std::string &file_path) const {
+    auto it = entries.find(file_path);
+    return it != entries.end() and it->second.state == EntryState::READY;
+}
+
+bool SoundBufferCache::has_failed(const std::string &file_path) const {
+    auto it = entries.find(file_path);
+    return it != entries.end() and it->second.state == EntryState::FAILED;
+}
+
+ALuint SoundBufferCache::acquire(const std::string &file_path) {
+    auto it = entries.find(file_path);
+    if (it == entries.end()) {
+        request(file_path);
+        return 0;
+    }
+
+    Entry &entry = it->second;
+    if (entry.state != EntryState::READY) {
+        return 0;
+    }
+    entry.acquire_count++;
+    touch(entry);
+    return entry.buffer;
+}
+
+void SoundBufferCache::release(const std::string &file_path) {
+    auto it = entries.find(file_path);
+    if (it == entries.end() or it->second.acquire_count == 0) {
+        return;
+    }
+    it->second.acquire_count--;
+    if (it->second.acquire_count == 0) {
+        evict_to_budget();
+    }
+}
+
+void SoundBufferCache::wait_until_idle() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_condition.wait(lock, [&] { return decodes_in_flight == 0 or not finished_decodes.empty(); });
+            if (decodes_in_flight == 0 and finished_decodes.empty()) {
+                return;
+            }
+        }
+        update();
+    }
+}
+
+std::size_t SoundBufferCache::get_memory_usage() const { return memory_usage_bytes; }
+
+std::size_t SoundBufferCache::get_memory_budget() const { return memory_budget_bytes; }
+
+void SoundBufferCache::set_memory_budget(std::size_t memory_budget_bytes) {
+    this->memory_budget_bytes = memory_budget_bytes;
+    evict_to_budget();
+}
+
+std::size_t SoundBufferCache::get_loaded_count() const { return lru_order.size(); }
+
+std::size_t SoundBufferCache::get_eviction_count() const { return eviction_count; }
+
+SoundBufferCache::DecodedSound SoundBufferCache::decode(const std::string &file_path) {
+    DecodedSound decoded_sound;
+    decoded_sound.file_path = file_path;
+
+    SF_INFO sf_info{};
+    SNDFILE *sound_file = sf_open(file_path.c_str(), SFM_READ, &sf_info);
+    if (sound_file == nullptr) {
+        std::cerr << "couldn't open sound " << file_path << ": " << sf_strerror(nullptr) << std::endl;
+        decoded_sound.failed = true;
+        return decoded_sound;
+    }
+
+    if (sf_info.frames <= 0 or sf_info.channels < 1 or sf_info.channels > 2) {
+        std::cerr << "sound " << file_path << " has " << sf_info.channels << " channels and " << sf_info.frames
+                  << " frames, only non empty mono or stereo is supported" << std::endl;
+        sf_close(sound_file);
+        decoded_sound.failed = true;
+        return decoded_sound;
+    }
+
+    decoded_sound.num_channels = sf_info.channels;
+    decoded_sound.sample_rate = sf_info.samplerate;
+    decoded_sound.samples.resize(static_cast<std::size_t>(sf_info.frames) * sf_info.channels);
+    sf_count_t frames_read = sf_readf_short(sound_file, decoded_sound.samples.data(), sf_info.frames);
+    sf_close(sound_file);
+
+    // some compressed formats report a frame count that is an estimate
+    decoded_sound.samples.resize(static_cast<std::size_t>(frames_read) * sf_info.channels);
+    if (decoded_sound.samples.empty()) {
+        std::cerr << "couldn't decode any samples from " << file_path << std::endl;
+        decoded_sound.failed = true;
+    }
+    return decoded_sound;
+}
+
+void SoundBufferCache::decode_loop() {
+    while (true) {
+        std::string file_path;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_condition.wait(lock, [&] { return stopping or not pending_decodes.empty(); });
+            if (stopping) {
+                return;
+            }
+            file_path = std::move(pending_decodes.front());
+            pending_decodes.pop_front();
+        }
+
+        DecodedSound decoded_sound = decode(file_path);
+
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            finished_decodes.push_back(std::move(decoded_sound));
+            decodes_in_flight--;
+        }
+        queue_condition.notify_all();
+    }
+}
+
+void SoundBufferCache::upload(DecodedSound &decoded_sound) {
+    auto it = entries.find(decoded_sound.file_path);
+    if (it == entries.end()) {
+        return;
+    }
+    Entry &entry = it->second;
+
+    if (decoded_sound.failed) {
+        entry.state = EntryState::FAILED;
+        return;
+    }
+
+    ALenum format = decoded_sound.num_channels == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+    std::size_t size_bytes = decoded_sound.samples.size() * sizeof(std::int16_t);
+
+    alGetError();
+    alGenBuffers(1, &entry.buffer);
+    alBufferData(entry.buffer, format, decoded_sound.samples.data(), static_cast<ALsizei>(size_bytes),
+                 decoded_sound.sample_rate);
+    if (alGetError() != AL_NO_ERROR) {
+        std::cerr << "couldn't upload sound " << decoded_sound.file_path << " to openal" << std::endl;
+        if (alIsBuffer(entry.buffer)) {
+            alDeleteBuffers(1, &entry.buffer);
+        }
+        entry.buffer = 0;
+        entry.state = EntryState::FAILED;
+        return;
+    }
+
+    entry.state = EntryState::READY;
+    entry.size_bytes = size_bytes;
+    memory_usage_bytes += size_bytes;
+    lru_order.push_front(decoded_sound.file_path);
+    entry.lru_position = lru_order.begin();
+}
+
+void SoundBufferCache::evict_to_budget() {
+    // walk from the least recently used end, skipping anything that is acquired
+    auto it = lru_order.end();
+    while (memory_usage_bytes > memory_budget_bytes and it != lru_order.begin()) {
+        --it;
+        auto entry_it = entries.find(*it);
+        Entry &entry = entry_it->second;
+        if (entry.acquire_count > 0) {
+            continue;
+        }
+        // the most recently used sound is kept even when it alone is over budget
+        if (it == lru_order.begin()) {
+            break;
+        }
+
+        alDeleteBuffers(1, &entry.buffer);
+        memory_usage_bytes -= entry.size_bytes;
+        eviction_count++;
+        it = lru_order.erase(it);
+        entries.erase(entry_it);
+    }
+}
+
+void SoundBufferCache::touch(Entry &entry) { lru_order.splice(lru_order.begin(), lru_order, entry.lru_position); }
@@ -0,0 +1,125 @@
+#ifndef SOUND_BUFFER_CACHE_HPP
+#define SOUND_BUFFER_CACHE_HPP
+
+#include <AL/al.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * owns the openal buffers for sound files and decodes them with libsndfile on a background thread, so the main thread
+ * never waits on a decode when a cue fires. a sound that isn't decoded yet just isn't available yet, the caller decides
+ * whether to wait a frame or skip it.
+ *
+ * the decoded sizes are kept under a memory budget by evicting the least recently used sounds, a sound that is acquired
+ * (eg attached to a playing source) is never evicted. a single sound larger than the whole budget is still kept, it just
+ * pushes everything else out.
+ *
+ * everything except the decoding happens on the thread that owns the openal context, that thread has to call update
+ * regularly to turn finished decodes into buffers. the cache doesn't open a device, so it runs the same against a null
+ * or loopback device as against a real one.
+ */
+class SoundBufferCache {
+  public:
+    explicit SoundBufferCache(std::size_t memory_budget_bytes);
+    ~SoundBufferCache();
+
+    SoundBufferCache(const SoundBufferCache &) = delete;
+    SoundBufferCache &operator=(const SoundBufferCache &) = delete;
+
+    /**
+     * queues a decode if the sound is neither loaded nor on its way, returns immediately
+     */
+    void request(const std::string &file_path);
+
+    /**
+     * requests each sound in order, the decode thread works through them in the same order
+     */
+    void prewarm(const std::vector<std::string> &file_paths);
+
+    /**
+     * uploads whatever finished decoding since the last call and evicts down to the budget
+     */
+    void update();
+
+    bool is_ready(const std::string &file_path) const;
+    /**
+     * true when the sound couldn't be opened or decoded, it isn't retried
+     */
+    bool has_failed(const std::string &file_path) const;
+
+    /**
+     * returns the buffer and keeps it from being evicted until release is called, or 0 if the sound isn't ready yet in
+     * which case it is requested
+     */
+    ALuint acquire(const std::string &file_path);
+    void release(const std::string &file_path);
+
+    /**
+     * blocks until every requested sound is decoded and uploaded, for loading screens and for tests
+     */
+    void wait_until_idle();
+
+    std::size_t get_memory_usage() const;
+    std::size_t get_memory_budget() const;
+    void set_memory_budget(std::size_t memory_budget_bytes);
+    std::size_t get_loaded_count() const;
+    std::size_t get_eviction_count() const;
+
+  private:
+    enum class EntryState {
+        DECODING,
+        READY,
+        FAILED,
+    };
+
+    struct Entry {
+        EntryState state = EntryState::DECODING;
+        ALuint buffer = 0;
+        std::size_t size_bytes = 0;
+        unsigned int acquire_count = 0;
+        std::list<std::string>::iterator lru_position; // only valid when ready
+    };
+
+    struct DecodedSound {
+        std::string file_path;
+        std::vector<std::int16_t> samples;
+        int num_channels = 0;
+        int sample_rate = 0;
+        bool failed = false;
+    };
+
+    static DecodedSound decode(const std::string &file_path);
+    void decode_loop();
+    void upload(DecodedSound &decoded_sound);
+    void evict_to_budget();
+    void touch(Entry &entry);
+
+    std::size_t memory_budget_bytes;
+    std::size_t memory_usage_bytes;
+    std::size_t eviction_count;
+
+    // only touched by the owning thread
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> lru_order; // front is the most recently used
+
+    // shared with the decode thread
+    mutable std::mutex queue_mutex;
+    std::condition_variable queue_condition;
+    std::deque<std::string> pending_decodes;
+    std::vector<DecodedSound> finished_decodes;
+    std::size_t decodes_in_flight;
+    bool stopping;
+
+    std::thread decode_thread;
+};
+
+#endif // SOUND_BUFFER_CACHE_HPP
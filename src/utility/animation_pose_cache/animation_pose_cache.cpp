@@ -0,0 +1,110 @@
+#include "animation_pose_cache.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+AnimationPoseCache::AnimationPoseCache(unsigned int pool_size, double samples_per_sec)
+    : samples_per_sec{samples_per_sec}, pool(pool_size), clock_hand{0}, hit_count{0}, miss_count{0} {
+    if (pool_size == 0) {
+        throw std::runtime_error("an animation pose cache needs at least one pool slot");
+    }
+    key_to_slot.reserve(pool_size);
+    for (PoolSlot &slot : pool) {
+        slot.in_use = false;
+        slot.recently_used = false;
+    }
+}
+
+unsigned int AnimationPoseCache::register_clip(PoseEvaluator evaluator) {
+    clip_evaluators.push_back(std::move(evaluator));
+    return clip_evaluators.size() - 1;
+}
+
+unsigned int AnimationPoseCache::register_clip(RecIvpntRiggedCollector &rirc) {
+    return register_clip([&rirc](double time_sec, AnimationPose &pose) {
+        rirc.set_bone_transforms(time_sec, pose.bone_palette);
+
+        // the hierarchy walk leaves the per bone transforms on the collector, copy them out before the next
+        // evaluation overwrites them
+        std::size_t num_bones = rirc.bone_unique_idx_to_info.size();
+        pose.animated_transforms_upto_bone.resize(num_bones);
+        for (std::size_t bone_index = 0; bone_index < num_bones; bone_index++) {
+            pose.animated_transforms_upto_bone[bone_index] =
+                rirc.bone_unique_idx_to_info[bone_index].local_space_animated_transform_upto_this_bone;
+        }
+    });
+}
+
+const AnimationPose &AnimationPoseCache::get_pose(unsigned int clip_id, double time_sec) {
+    if (clip_id >= clip_evaluators.size()) {
+        throw std::runtime_error("no animation clip registered with id " + std::to_string(clip_id));
+    }
+
+    long long sample_index = std::llround(time_sec * samples_per_sec);
+    std::uint64_t key = make_key(clip_id, sample_index);
+
+    auto it = key_to_slot.find(key);
+    if (it != key_to_slot.end()) {
+        hit_count++;
+        PoolSlot &slot = pool[it->second];
+        slot.recently_used = true;
+        return slot.pose;
+    }
+
+    miss_count++;
+    unsigned int slot_index = find_slot_to_reuse();
+    PoolSlot &slot = pool[slot_index];
+    if (slot.in_use) {
+        key_to_slot.erase(slot.key);
+    }
+    slot.key = key;
+    slot.in_use = true;
+    slot.recently_used = true;
+    key_to_slot.emplace(key, slot_index);
+
+    // the vectors in the slot keep their capacity so re-evaluating into them doesn't allocate
+    clip_evaluators[clip_id](sample_index / samples_per_sec, slot.pose);
+    return slot.pose;
+}
+
+unsigned long long AnimationPoseCache::get_hit_count() const { return hit_count; }
+
+unsigned long long AnimationPoseCache::get_miss_count() const { return miss_count; }
+
+double AnimationPoseCache::get_hit_rate() const {
+    unsigned long long lookups = hit_count + miss_count;
+    return lookups == 0 ? 0.0 : static_cast<double>(hit_count) / lookups;
+}
+
+void AnimationPoseCache::reset_counters() {
+    hit_count = 0;
+    miss_count = 0;
+}
+
+void AnimationPoseCache::clear() {
+    key_to_slot.clear();
+    for (PoolSlot &slot : pool) {
+        slot.in_use = false;
+        slot.recently_used = false;
+    }
+}
+
+std::uint64_t AnimationPoseCache::make_key(unsigned int clip_id, long long sample_index) const {
+    // 24 bits of clip and 40 bits of sample, which is over 290 years at 120 samples per second
+    std::uint64_t sample_bits = static_cast<std::uint64_t>(sample_index) & ((1ull << 40) - 1);
+    return (static_cast<std::uint64_t>(clip_id) << 40) | sample_bits;
+}
+
+unsigned int AnimationPoseCache::find_slot_to_reuse() {
+    // sweep until a slot that is free or hasn't been touched since the last sweep comes up
+    while (true) {
+        PoolSlot &slot = pool[clock_hand];
+        unsigned int candidate = clock_hand;
+        clock_hand = (clock_hand + 1) % pool.size();
+        if (not slot.in_use or not slot.recently_used) {
+            return candidate;
+        }
+        slot.recently_used = false;
+    }
+}
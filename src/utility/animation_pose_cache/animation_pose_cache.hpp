@@ -0,0 +1,78 @@
+#ifndef ANIMATION_POSE_CACHE_HPP
+#define ANIMATION_POSE_CACHE_HPP
+
+#include "sbpt_generated_includes.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * one evaluated pose of a rig, both are indexed by the bone's unique index
+ */
+struct AnimationPose {
+    // what gets uploaded as BONE_ANIMATION_TRANSFORMS
+    std::vector<glm::mat4> bone_palette;
+    // BoneInfo::local_space_animated_transform_upto_this_bone for every bone, for attaching things to bones
+    std::vector<glm::mat4> animated_transforms_upto_bone;
+};
+
+/**
+ * evaluated poses keyed by (clip, quantized time) in a pool that is allocated once, so that every instance of a rig
+ * that samples a clip at the same moment shares one evaluation instead of walking the bone hierarchy again.
+ *
+ * time is snapped to 1 / samples_per_sec and the pose is evaluated at the snapped time, so two instances that land in
+ * the same sample get exactly the same pose. when the pool is full the least recently touched pose is reused (clock
+ * replacement).
+ */
+class AnimationPoseCache {
+  public:
+    using PoseEvaluator = std::function<void(double time_sec, AnimationPose &pose)>;
+
+    explicit AnimationPoseCache(unsigned int pool_size = 64, double samples_per_sec = 120.0);
+
+    unsigned int register_clip(PoseEvaluator evaluator);
+
+    /**
+     * a clip that evaluates the animation loaded into rirc, rirc must outlive the cache
+     */
+    unsigned int register_clip(RecIvpntRiggedCollector &rirc);
+
+    /**
+     * the returned pose stays valid until pool_size other poses have been requested
+     */
+    const AnimationPose &get_pose(unsigned int clip_id, double time_sec);
+
+    unsigned long long get_hit_count() const;
+    unsigned long long get_miss_count() const;
+    double get_hit_rate() const;
+    void reset_counters();
+
+    // forget every cached pose, eg after the rig was reloaded
+    void clear();
+
+  private:
+    struct PoolSlot {
+        std::uint64_t key;
+        bool in_use;
+        bool recently_used;
+        AnimationPose pose;
+    };
+
+    std::uint64_t make_key(unsigned int clip_id, long long sample_index) const;
+    unsigned int find_slot_to_reuse();
+
+    double samples_per_sec;
+    std::vector<PoseEvaluator> clip_evaluators;
+    std::vector<PoolSlot> pool;
+    std::unordered_map<std::uint64_t, unsigned int> key_to_slot;
+    unsigned int clock_hand;
+
+    unsigned long long hit_count;
+    unsigned long long miss_count;
+};
+
+#endif // ANIMATION_POSE_CACHE_HPP
@@ -0,0 +1,213 @@
+#include "asset_job_graph.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <stdexcept>
+#include <thread>
+
+AssetJobGraph::AssetJobGraph(unsigned int num_workers)
+    : num_workers{num_workers}, deduplicated_count{0}, finished_count{0}, running_count{0}, has_run{false} {}
+
+unsigned int AssetJobGraph::default_num_workers() {
+    unsigned int hardware_threads = std::thread::hardware_concurrency();
+    // the context thread works through jobs as well
+    return hardware_threads > 1 ? hardware_threads - 1 : 1;
+}
+
+AssetJobGraph::JobId AssetJobGraph::add_job(const std::string &name, std::function<void()> work,
+                                            const std::vector<JobId> &dependencies, AssetJobThread thread) {
+    if (has_run) {
+        throw std::runtime_error("can't add the job " + name + " to an asset job graph that already ran");
+    }
+
+    JobId job_id = jobs.size();
+    for (JobId dependency : dependencies) {
+        // since a job can only depend on jobs that exist already, the graph can't have a cycle
+        if (dependency >= job_id) {
+            throw std::runtime_error("the job " + name + " depends on job " + std::to_string(dependency) +
+                                     " which doesn't exist");
+        }
+        jobs[dependency].dependents.push_back(job_id);
+    }
+
+    jobs.push_back({name, std::move(work), thread, {}, static_cast<unsigned int>(dependencies.size()), 0, {}, {}, {},
+                    CONTEXT_THREAD_INDEX});
+    return job_id;
+}
+
+AssetJobGraph::JobId AssetJobGraph::add_deduplicated_job(const std::string &dedupe_key, const std::string &name,
+                                                         std::function<void()> work,
+                                                         const std::vector<JobId> &dependencies,
+                                                         AssetJobThread thread) {
+    auto it = dedupe_key_to_job.find(dedupe_key);
+    if (it != dedupe_key_to_job.end()) {
+        jobs[it->second].dedupe_hits++;
+        deduplicated_count++;
+        return it->second;
+    }
+    JobId job_id = add_job(name, std::move(work), dependencies, thread);
+    dedupe_key_to_job.emplace(dedupe_key, job_id);
+    return job_id;
+}
+
+void AssetJobGraph::run() {
+    if (has_run) {
+        throw std::runtime_error("an asset job graph can only run once");
+    }
+    has_run = true;
+
+    run_start_time = std::chrono::steady_clock::now();
+    for (JobId job_id = 0; job_id < jobs.size(); job_id++) {
+        if (jobs[job_id].unfinished_dependencies == 0) {
+            make_ready(job_id, run_start_time);
+        }
+    }
+
+    std::vector<std::thread> workers;
+    for (unsigned int i = 0; i < num_workers; i++) {
+        workers.emplace_back(&AssetJobGraph::worker_loop, this, static_cast<int>(i));
+    }
+
+    // the context thread prefers its own jobs but helps with the rest when it has nothing else to do
+    while (true) {
+        JobId job_id;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&] {
+                bool has_ready_job = not ready_context_thread_jobs.empty() or not ready_worker_jobs.empty();
+                return has_finished() or (not first_exception and has_ready_job);
+            });
+            if (has_finished()) {
+                break;
+            }
+            if (not ready_context_thread_jobs.empty()) {
+                job_id = ready_context_thread_jobs.front();
+                ready_context_thread_jobs.pop_front();
+            } else {
+                job_id = ready_worker_jobs.front();
+                ready_worker_jobs.pop_front();
+            }
+            running_count++;
+        }
+        execute(job_id, CONTEXT_THREAD_INDEX);
+    }
+
+    condition.notify_all();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    run_end_time = std::chrono::steady_clock::now();
+
+    if (first_exception) {
+        std::rethrow_exception(first_exception);
+    }
+}
+
+std::size_t AssetJobGraph::get_job_count() const { return jobs.size(); }
+
+std::size_t AssetJobGraph::get_deduplicated_count() const { return deduplicated_count; }
+
+double AssetJobGraph::get_wall_time_sec() const {
+    return std::chrono::duration<double>(run_end_time - run_start_time).count();
+}
+
+void AssetJobGraph::print_timing_report(std::ostream &os) const {
+    auto ms_since_start = [&](std::chrono::steady_clock::time_point time_point) {
+        return std::chrono::duration<double, std::milli>(time_point - run_start_time).count();
+    };
+
+    std::vector<JobId> job_ids_by_start(jobs.size());
+    for (JobId job_id = 0; job_id < jobs.size(); job_id++) {
+        job_ids_by_start[job_id] = job_id;
+    }
+    std::sort(job_ids_by_start.begin(), job_ids_by_start.end(),
+              [&](JobId a, JobId b) { return jobs[a].start_time < jobs[b].start_time; });
+
+    double total_job_ms = 0;
+    os << "asset loading took " << std::fixed << std::setprecision(1) << get_wall_time_sec() * 1000.0 << "ms over "
+       << num_workers << " workers and the context thread" << std::endl;
+    os << std::setw(10) << "start ms" << std::setw(10) << "wait ms" << std::setw(10) << "took ms" << std::setw(10)
+       << "thread"
+       << "  job" << std::endl;
+    for (JobId job_id : job_ids_by_start) {
+        const Job &job = jobs[job_id];
+        double took_ms = std::chrono::duration<double, std::milli>(job.end_time - job.start_time).count();
+        double wait_ms = std::chrono::duration<double, std::milli>(job.start_time - job.ready_time).count();
+        total_job_ms += took_ms;
+
+        std::string thread_name =
+            job.executed_by == CONTEXT_THREAD_INDEX ? "context" : "worker " + std::to_string(job.executed_by);
+        os << std::setw(10) << ms_since_start(job.start_time) << std::setw(10) << wait_ms << std::setw(10) << took_ms
+           << std::setw(10) << thread_name << "  " << job.name;
+        if (job.dedupe_hits > 0) {
+            os << " (shared by " << job.dedupe_hits + 1 << ")";
+        }
+        os << std::endl;
+    }
+    os << "sum of job times " << total_job_ms << "ms, " << deduplicated_count << " duplicate jobs skipped"
+       << std::defaultfloat << std::endl;
+}
+
+void AssetJobGraph::make_ready(JobId job_id, std::chrono::steady_clock::time_point now) {
+    Job &job = jobs[job_id];
+    job.ready_time = now;
+    if (job.thread == AssetJobThread::CONTEXT_THREAD) {
+        ready_context_thread_jobs.push_back(job_id);
+    } else {
+        ready_worker_jobs.push_back(job_id);
+    }
+}
+
+void AssetJobGraph::execute(JobId job_id, int thread_index) {
+    Job &job = jobs[job_id];
+    job.executed_by = thread_index;
+    job.start_time = std::chrono::steady_clock::now();
+
+    std::exception_ptr exception;
+    try {
+        job.work();
+    } catch (...) {
+        exception = std::current_exception();
+    }
+    job.end_time = std::chrono::steady_clock::now();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running_count--;
+        finished_count++;
+        if (exception and not first_exception) {
+            first_exception = exception;
+        }
+        if (not first_exception) {
+            for (JobId dependent : job.dependents) {
+                if (--jobs[dependent].unfinished_dependencies == 0) {
+                    make_ready(dependent, job.end_time);
+                }
+            }
+        }
+    }
+    condition.notify_all();
+}
+
+void AssetJobGraph::worker_loop(int worker_index) {
+    while (true) {
+        JobId job_id;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock,
+                           [&] { return has_finished() or (not first_exception and not ready_worker_jobs.empty()); });
+            if (has_finished()) {
+                return;
+            }
+            job_id = ready_worker_jobs.front();
+            ready_worker_jobs.pop_front();
+            running_count++;
+        }
+        execute(job_id, worker_index);
+    }
+}
+
+bool AssetJobGraph::has_finished() const {
+    // after a failure the graph is done as soon as whatever was already running is
+    return finished_count == jobs.size() or (first_exception and running_count == 0);
+}
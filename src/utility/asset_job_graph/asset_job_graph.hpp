@@ -0,0 +1,104 @@
+#ifndef ASSET_JOB_GRAPH_HPP
+#define ASSET_JOB_GRAPH_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class AssetJobThread {
+    WORKER,         // anything that doesn't touch gl, runs on a worker or on the main thread when it's idle
+    CONTEXT_THREAD, // gl uploads and anything else that has to run on the thread that called run
+};
+
+/**
+ * a set of loading jobs with dependencies between them, independent parsing and decoding runs across worker threads
+ * while the jobs that need the gl context are handed back to the thread that calls run. jobs pass results to each other
+ * through whatever they capture, a job only starts once everything it depends on has finished.
+ *
+ * jobs added with the same dedupe key are the same job, the second add just returns the id of the first, so identical
+ * conversions that show up in several places only happen once.
+ *
+ * every job is timed, print_timing_report shows where startup went.
+ */
+class AssetJobGraph {
+  public:
+    using JobId = unsigned int;
+
+    /**
+     * with zero workers everything runs on the thread that calls run, in dependency order
+     */
+    explicit AssetJobGraph(unsigned int num_workers = default_num_workers());
+
+    JobId add_job(const std::string &name, std::function<void()> work, const std::vector<JobId> &dependencies = {},
+                  AssetJobThread thread = AssetJobThread::WORKER);
+
+    /**
+     * like add_job, but if a job with this dedupe key was already added that job's id is returned and nothing new is
+     * added
+     */
+    JobId add_deduplicated_job(const std::string &dedupe_key, const std::string &name, std::function<void()> work,
+                               const std::vector<JobId> &dependencies = {},
+                               AssetJobThread thread = AssetJobThread::WORKER);
+
+    /**
+     * runs every job and returns once they're all done. if a job throws nothing new is started, the jobs already
+     * running are waited on and the first exception is rethrown here
+     */
+    void run();
+
+    std::size_t get_job_count() const;
+    std::size_t get_deduplicated_count() const;
+    double get_wall_time_sec() const;
+
+    void print_timing_report(std::ostream &os = std::cout) const;
+
+    static unsigned int default_num_workers();
+
+  private:
+    static constexpr int CONTEXT_THREAD_INDEX = -1;
+
+    struct Job {
+        std::string name;
+        std::function<void()> work;
+        AssetJobThread thread;
+        std::vector<JobId> dependents;
+        unsigned int unfinished_dependencies;
+        unsigned int dedupe_hits;
+        std::chrono::steady_clock::time_point ready_time;
+        std::chrono::steady_clock::time_point start_time;
+        std::chrono::steady_clock::time_point end_time;
+        int executed_by; // worker index or CONTEXT_THREAD_INDEX
+    };
+
+    void make_ready(JobId job_id, std::chrono::steady_clock::time_point now);
+    void execute(JobId job_id, int thread_index);
+    void worker_loop(int worker_index);
+    bool has_finished() const;
+
+    unsigned int num_workers;
+    std::vector<Job> jobs;
+    std::unordered_map<std::string, JobId> dedupe_key_to_job;
+    std::size_t deduplicated_count;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<JobId> ready_worker_jobs;
+    std::deque<JobId> ready_context_thread_jobs;
+    std::size_t finished_count;
+    std::size_t running_count;
+    std::exception_ptr first_exception;
+    bool has_run;
+
+    std::chrono::steady_clock::time_point run_start_time;
+    std::chrono::steady_clock::time_point run_end_time;
+};
+
+#endif // ASSET_JOB_GRAPH_HPP
@@ -0,0 +1,356 @@
+#include "baked_rigged_model.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+
+const char BAKED_RIGGED_MODEL_MAGIC[4] = {'B', 'R', 'M', 'D'};
+const std::uint32_t ENDIANNESS_CHECK = 0x01020304;
+const std::uint32_t LAYOUT_SIGNATURE = sizeof(BakedRiggedMeshRecord) | sizeof(glm::mat4) << 8 |
+                                       sizeof(glm::ivec4) << 16 | sizeof(glm::vec3) << 24;
+const std::size_t ARRAY_ALIGNMENT = 16;
+
+static_assert(std::is_trivially_copyable_v<BakedRiggedModelHeader>);
+static_assert(std::is_trivially_copyable_v<BakedRiggedMeshRecord>);
+static_assert(std::is_trivially_copyable_v<BakedBoneNameRange>);
+
+std::uint64_t hash_baked_rigged_model_sources(const std::vector<std::string> &source_file_paths,
+                                              double animation_duration_sec, double samples_per_sec) {
+    const std::uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ull;
+    const std::uint64_t FNV_PRIME = 0x100000001b3ull;
+
+    std::uint64_t hash = FNV_OFFSET_BASIS;
+    auto hash_bytes = [&](const unsigned char *bytes, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= FNV_PRIME;
+        }
+    };
+
+    for (const std::string &source_file_path : source_file_paths) {
+        MappedFile source_file(source_file_path);
+        // the size goes in too so that moving bytes from the end of one file to the start of the next is noticed
+        std::uint64_t size = source_file.size();
+        hash_bytes(reinterpret_cast<const unsigned char *>(&size), sizeof(size));
+        hash_bytes(reinterpret_cast<const unsigned char *>(source_file.data()), source_file.size());
+    }
+    hash_bytes(reinterpret_cast<const unsigned char *>(&animation_duration_sec), sizeof(animation_duration_sec));
+    hash_bytes(reinterpret_cast<const unsigned char *>(&samples_per_sec), sizeof(samples_per_sec));
+    return hash;
+}
+
+namespace {
+
+// the arrays of the file in the order they get written, each one remembers where it goes
+class BakedArrayWriter {
+  public:
+    explicit BakedArrayWriter(std::uint64_t header_size) : file_size{header_size} {}
+
+    template <typename T> std::uint64_t reserve(std::span<const T> array) {
+        std::uint64_t offset = (file_size + ARRAY_ALIGNMENT - 1) / ARRAY_ALIGNMENT * ARRAY_ALIGNMENT;
+        file_size = offset + array.size_bytes();
+        arrays.push_back({reinterpret_cast<const char *>(array.data()), array.size_bytes(), offset});
+        return offset;
+    }
+
+    void write(std::ofstream &file) const {
+        // zero padding up to each aligned offset
+        static const char padding[ARRAY_ALIGNMENT] = {};
+        for (const PendingArray &array : arrays) {
+            std::uint64_t position = file.tellp();
+            file.write(padding, array.offset - position);
+            file.write(array.data, array.size_bytes);
+        }
+    }
+
+  private:
+    struct PendingArray {
+        const char *data;
+        std::size_t size_bytes;
+        std::uint64_t offset;
+    };
+
+    std::uint64_t file_size;
+    std::vector<PendingArray> arrays;
+};
+
+} // namespace
+
+void bake_rigged_model(const std::string &file_path, std::uint64_t source_hash,
+                       const std::vector<BakedRiggedMeshSource> &meshes, const std::vector<std::string> &bone_names,
+                       const std::vector<glm::mat4> &bind_pose_transforms,
+                       const AnimationPoseCache::PoseEvaluator &evaluate_pose, double animation_duration_sec,
+                       double samples_per_sec) {
+    if (samples_per_sec <= 0 or animation_duration_sec < 0) {
+        throw std::runtime_error("can't bake " + file_path + " with a non positive sample rate or a negative duration");
+    }
+    if (bind_pose_transforms.size() != bone_names.size()) {
+        throw std::runtime_error("can't bake " + file_path + ", there isn't one bind pose for every bone");
+    }
+
+    BakedRiggedModelHeader header{};
+    std::memcpy(header.magic, BAKED_RIGGED_MODEL_MAGIC, sizeof(header.magic));
+    header.version = BAKED_RIGGED_MODEL_VERSION;
+    header.endianness_check = ENDIANNESS_CHECK;
+    header.layout_signature = LAYOUT_SIGNATURE;
+    header.source_hash = source_hash;
+    header.samples_per_sec = samples_per_sec;
+
+    BakedArrayWriter writer(sizeof(BakedRiggedModelHeader));
+
+    // meshes
+    std::vector<BakedRiggedMeshRecord> mesh_records(meshes.size());
+    header.mesh_count = meshes.size();
+    header.meshes_offset = writer.reserve(std::span<const BakedRiggedMeshRecord>(mesh_records));
+
+    for (std::size_t i = 0; i < meshes.size(); i++) {
+        const BakedRiggedMeshSource &mesh = meshes[i];
+        std::size_t num_vertices = mesh.xyz_positions.size();
+        if (mesh.normals.size() != num_vertices or mesh.packed_texture_coordinates.size() != num_vertices or
+            mesh.bone_ids.size() != num_vertices or mesh.bone_weights.size() != num_vertices) {
+            throw std::runtime_error("can't bake " + file_path + ", mesh " + std::to_string(i) +
+                                     " has mismatched vertex attribute counts");
+        }
+
+        BakedRiggedMeshRecord &record = mesh_records[i];
+        record.packed_texture_index = mesh.packed_texture_index;
+        record.index_count = mesh.indices.size();
+        record.vertex_count = num_vertices;
+        record.indices_offset = writer.reserve(std::span<const unsigned int>(mesh.indices));
+        record.xyz_positions_offset = writer.reserve(std::span<const glm::vec3>(mesh.xyz_positions));
+        record.normals_offset = writer.reserve(std::span<const glm::vec3>(mesh.normals));
+        record.packed_texture_coordinates_offset =
+            writer.reserve(std::span<const glm::vec2>(mesh.packed_texture_coordinates));
+        record.bone_ids_offset = writer.reserve(std::span<const glm::ivec4>(mesh.bone_ids));
+        record.bone_weights_offset = writer.reserve(std::span<const glm::vec4>(mesh.bone_weights));
+    }
+
+    // bones
+    std::size_t bone_count = bone_names.size();
+    std::vector<BakedBoneNameRange> bone_name_ranges;
+    std::string bone_name_characters;
+    for (std::size_t bone_index = 0; bone_index < bone_count; bone_index++) {
+        bone_name_ranges.push_back({static_cast<std::uint32_t>(bone_name_characters.size()),
+                                    static_cast<std::uint32_t>(bone_names[bone_index].size())});
+        bone_name_characters += bone_names[bone_index];
+    }
+    header.bone_count = bone_count;
+    header.bone_name_ranges_offset = writer.reserve(std::span<const BakedBoneNameRange>(bone_name_ranges));
+    header.bone_names_offset = writer.reserve(std::span<const char>(bone_name_characters));
+    header.bone_names_size = bone_name_characters.size();
+    header.bind_pose_transforms_offset = writer.reserve(std::span<const glm::mat4>(bind_pose_transforms));
+
+    // the animation, one pose after the other
+    std::size_t pose_sample_count = static_cast<std::size_t>(std::floor(animation_duration_sec * samples_per_sec)) + 1;
+    std::vector<glm::mat4> bone_palettes;
+    std::vector<glm::mat4> animated_transforms_upto_bone;
+    AnimationPose pose;
+    std::size_t bone_palette_size = 0;
+    for (std::size_t sample = 0; sample < pose_sample_count; sample++) {
+        evaluate_pose(sample / samples_per_sec, pose);
+        if (sample == 0) {
+            bone_palette_size = pose.bone_palette.size();
+        } else if (pose.bone_palette.size() != bone_palette_size) {
+            throw std::runtime_error("can't bake " + file_path +
+                                     ", the bone palette changed size during the animation");
+        }
+        if (pose.animated_transforms_upto_bone.size() != bone_count) {
+            throw std::runtime_error("can't bake " + file_path + ", a pose doesn't have a transform for every bone");
+        }
+        bone_palettes.insert(bone_palettes.end(), pose.bone_palette.begin(), pose.bone_palette.end());
+        animated_transforms_upto_bone.insert(animated_transforms_upto_bone.end(),
+                                             pose.animated_transforms_upto_bone.begin(),
+                                             pose.animated_transforms_upto_bone.end());
+    }
+    header.bone_palette_size = bone_palette_size;
+    header.pose_sample_count = pose_sample_count;
+    header.bone_palettes_offset = writer.reserve(std::span<const glm::mat4>(bone_palettes));
+    header.animated_transforms_upto_bone_offset =
+        writer.reserve(std::span<const glm::mat4>(animated_transforms_upto_bone));
+
+    // written next to the destination and renamed over it, so nothing ever maps a half written bake
+    std::filesystem::path destination(file_path);
+    if (destination.has_parent_path()) {
+        std::filesystem::create_directories(destination.parent_path());
+    }
+    std::string temporary_file_path = file_path + ".tmp";
+    {
+        std::ofstream file(temporary_file_path, std::ios::binary | std::ios::trunc);
+        if (not file.is_open()) {
+            throw std::runtime_error("couldn't open " + temporary_file_path + " for writing");
+        }
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        writer.write(file);
+        if (not file.good()) {
+            throw std::runtime_error("failed to write baked rigged model " + temporary_file_path);
+        }
+    }
+    std::filesystem::rename(temporary_file_path, destination);
+}
+
+void bake_rigged_model(const std::string &file_path, std::uint64_t source_hash,
+                       const std::vector<IVPNTPRigged> &ivptprs, RecIvpntRiggedCollector &rirc,
+                       double animation_duration_sec, double samples_per_sec) {
+    // the bone data is split up here the same way RetainedMeshRegistry does it
+    std::vector<BakedRiggedMeshSource> meshes;
+    for (const IVPNTPRigged &ivptpr : ivptprs) {
+        BakedRiggedMeshSource &mesh = meshes.emplace_back();
+        mesh.packed_texture_index = ivptpr.packed_texture_index;
+        mesh.indices = ivptpr.indices;
+        mesh.xyz_positions = ivptpr.xyz_positions;
+        mesh.normals = ivptpr.normals;
+        mesh.packed_texture_coordinates = ivptpr.packed_texture_coordinates;
+        for (const auto &vertex_bone_data : ivptpr.bone_data) {
+            const auto &bone_indices = vertex_bone_data.indices_of_bones_that_affect_this_vertex;
+            const auto &bone_weights = vertex_bone_data.weight_value_of_this_vertex_wrt_bone;
+            mesh.bone_ids.emplace_back(static_cast<int>(bone_indices[0]), static_cast<int>(bone_indices[1]),
+                                       static_cast<int>(bone_indices[2]), static_cast<int>(bone_indices[3]));
+            mesh.bone_weights.emplace_back(bone_weights[0], bone_weights[1], bone_weights[2], bone_weights[3]);
+        }
+    }
+
+    std::size_t bone_count = rirc.bone_unique_idx_to_info.size();
+    std::vector<std::string> bone_names(bone_count);
+    for (const auto &[bone_name, bone_index] : rirc.bone_name_to_unique_index) {
+        if (bone_index < bone_count) {
+            bone_names[bone_index] = bone_name;
+        }
+    }
+    std::vector<glm::mat4> bind_pose_transforms;
+    for (std::size_t bone_index = 0; bone_index < bone_count; bone_index++) {
+        bind_pose_transforms.push_back(
+            rirc.bone_unique_idx_to_info[bone_index].local_space_to_bone_space_in_bind_pose_transformation);
+    }
+
+    bake_rigged_model(
+        file_path, source_hash, meshes, bone_names, bind_pose_transforms,
+        [&rirc, bone_count](double time_sec, AnimationPose &pose) {
+            rirc.set_bone_transforms(time_sec, pose.bone_palette);
+            pose.animated_transforms_upto_bone.resize(bone_count);
+            for (std::size_t bone_index = 0; bone_index < bone_count; bone_index++) {
+                pose.animated_transforms_upto_bone[bone_index] =
+                    rirc.bone_unique_idx_to_info[bone_index].local_space_animated_transform_upto_this_bone;
+            }
+        },
+        animation_duration_sec, samples_per_sec);
+}
+
+template <typename T>
+static std::span<const T> get_array(const MappedFile &mapped_file, std::uint64_t offset, std::uint64_t count) {
+    if (offset % ARRAY_ALIGNMENT != 0 or offset > mapped_file.size() or
+        count > (mapped_file.size() - offset) / sizeof(T)) {
+        throw std::runtime_error("baked rigged model has an array outside of the file");
+    }
+    return std::span<const T>(reinterpret_cast<const T *>(mapped_file.data() + offset), count);
+}
+
+BakedRiggedModel::BakedRiggedModel(const std::string &file_path)
+    : mapped_file{std::make_shared<const MappedFile>(file_path)} {
+
+    if (mapped_file->size() < sizeof(BakedRiggedModelHeader)) {
+        throw std::runtime_error(file_path + " is too small to be a baked rigged model");
+    }
+
+    // mappings are page aligned so the header can be read in place
+    header = reinterpret_cast<const BakedRiggedModelHeader *>(mapped_file->data());
+    if (std::memcmp(header->magic, BAKED_RIGGED_MODEL_MAGIC, sizeof(header->magic)) != 0) {
+        throw std::runtime_error(file_path + " is not a baked rigged model");
+    }
+    if (header->version != BAKED_RIGGED_MODEL_VERSION or header->endianness_check != ENDIANNESS_CHECK or
+        header->layout_signature != LAYOUT_SIGNATURE) {
+        throw std::runtime_error(file_path + " was baked for a different version or platform, bake it again");
+    }
+    if (header->samples_per_sec <= 0 or header->pose_sample_count == 0) {
+        throw std::runtime_error(file_path + " has no animation samples");
+    }
+
+    for (const BakedRiggedMeshRecord &record :
+         get_array<BakedRiggedMeshRecord>(*mapped_file, header->meshes_offset, header->mesh_count)) {
+        meshes.push_back(
+            {record.packed_texture_index,
+             get_array<unsigned int>(*mapped_file, record.indices_offset, record.index_count),
+             get_array<glm::vec3>(*mapped_file, record.xyz_positions_offset, record.vertex_count),
+             get_array<glm::vec3>(*mapped_file, record.normals_offset, record.vertex_count),
+             get_array<glm::vec2>(*mapped_file, record.packed_texture_coordinates_offset, record.vertex_count),
+             get_array<glm::ivec4>(*mapped_file, record.bone_ids_offset, record.vertex_count),
+             get_array<glm::vec4>(*mapped_file, record.bone_weights_offset, record.vertex_count)});
+    }
+
+    std::span<const char> bone_name_characters =
+        get_array<char>(*mapped_file, header->bone_names_offset, header->bone_names_size);
+    std::span<const BakedBoneNameRange> bone_name_ranges =
+        get_array<BakedBoneNameRange>(*mapped_file, header->bone_name_ranges_offset, header->bone_count);
+    for (unsigned int bone_index = 0; bone_index < header->bone_count; bone_index++) {
+        const BakedBoneNameRange &range = bone_name_ranges[bone_index];
+        if (range.offset > bone_name_characters.size() or range.length > bone_name_characters.size() - range.offset) {
+            throw std::runtime_error(file_path + " has a bone name outside of the file");
+        }
+        bone_name_to_index.emplace(std::string(bone_name_characters.data() + range.offset, range.length), bone_index);
+    }
+
+    bind_pose_transforms = get_array<glm::mat4>(*mapped_file, header->bind_pose_transforms_offset, header->bone_count);
+    bone_palettes = get_array<glm::mat4>(*mapped_file, header->bone_palettes_offset,
+                                         std::uint64_t(header->pose_sample_count) * header->bone_palette_size);
+    animated_transforms_upto_bone =
+        get_array<glm::mat4>(*mapped_file, header->animated_transforms_upto_bone_offset,
+                             std::uint64_t(header->pose_sample_count) * header->bone_count);
+}
+
+std::uint64_t BakedRiggedModel::get_source_hash() const { return header->source_hash; }
+
+std::size_t BakedRiggedModel::get_mesh_count() const { return meshes.size(); }
+
+BakedRiggedMeshView BakedRiggedModel::get_mesh(std::size_t mesh_index) const { return meshes.at(mesh_index); }
+
+std::size_t BakedRiggedModel::get_bone_count() const { return header->bone_count; }
+
+const std::unordered_map<std::string, unsigned int> &BakedRiggedModel::get_bone_name_to_index() const {
+    return bone_name_to_index;
+}
+
+std::span<const glm::mat4> BakedRiggedModel::get_bind_pose_transforms() const { return bind_pose_transforms; }
+
+double BakedRiggedModel::get_samples_per_sec() const { return header->samples_per_sec; }
+
+double BakedRiggedModel::get_duration_sec() const { return (header->pose_sample_count - 1) / header->samples_per_sec; }
+
+void BakedRiggedModel::evaluate_pose(double time_sec, AnimationPose &pose) const {
+    double last_sample = header->pose_sample_count - 1;
+    double sample_position = std::clamp(time_sec * header->samples_per_sec, 0.0, last_sample);
+    std::size_t sample = static_cast<std::size_t>(sample_position);
+    std::size_t next_sample = std::min(sample + 1, static_cast<std::size_t>(last_sample));
+    float next_sample_weight = static_cast<float>(sample_position - sample);
+
+    // each array holds count matrices per sample, the pose gets the blend of the two samples around time_sec
+    auto blend_samples = [&](std::span<const glm::mat4> samples, std::size_t count, std::vector<glm::mat4> &blended) {
+        std::span<const glm::mat4> before = samples.subspan(sample * count, count);
+        std::span<const glm::mat4> after = samples.subspan(next_sample * count, count);
+        blended.resize(count);
+        for (std::size_t i = 0; i < count; i++) {
+            blended[i] = before[i] * (1.0f - next_sample_weight) + after[i] * next_sample_weight;
+        }
+    };
+    blend_samples(bone_palettes, header->bone_palette_size, pose.bone_palette);
+    blend_samples(animated_transforms_upto_bone, header->bone_count, pose.animated_transforms_upto_bone);
+}
+
+std::shared_ptr<const BakedRiggedModel> try_load_baked_rigged_model(const std::string &file_path,
+                                                                    std::uint64_t source_hash) {
+    if (not std::filesystem::exists(file_path)) {
+        return nullptr;
+    }
+    try {
+        auto baked_rigged_model = std::make_shared<const BakedRiggedModel>(file_path);
+        if (baked_rigged_model->get_source_hash() != source_hash) {
+            return nullptr;
+        }
+        return baked_rigged_model;
+    } catch (const std::runtime_error &) {
+        // a bake from another version or a damaged file just gets baked again
+        return nullptr;
+    }
+}
@@ -0,0 +1,161 @@
+#ifndef BAKED_RIGGED_MODEL_HPP
+#define BAKED_RIGGED_MODEL_HPP
+
+#include "sbpt_generated_includes.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * a baked rigged model is a rigged model after it went through assimp and the texture packer, written out in the
+ * layout the rest of the program uses it in: the meshes with their per vertex attributes (bone data already split into
+ * ids and weights the way the shader batcher takes them), the bones' names and bind poses, and the animation sampled
+ * at a fixed rate so that evaluating it is a blend of two samples instead of a walk over the bone hierarchy.
+ *
+ * the file is the header followed by the arrays it points at, every array starts at a 16 byte aligned offset. like a
+ * compiled scripted path it is stored in the in memory layout of the machine that baked it, and source_hash is the
+ * hash of the files and the sampling settings it was baked from so a stale bake is noticed and redone.
+ */
+struct BakedRiggedModelHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t endianness_check;
+    std::uint32_t layout_signature;
+    std::uint64_t source_hash;
+    std::uint32_t mesh_count;
+    std::uint32_t bone_count;
+    std::uint32_t bone_palette_size;
+    std::uint32_t pose_sample_count;
+    double samples_per_sec;
+    std::uint64_t meshes_offset;
+    std::uint64_t bone_name_ranges_offset;
+    std::uint64_t bone_names_offset;
+    std::uint64_t bone_names_size;
+    std::uint64_t bind_pose_transforms_offset;
+    std::uint64_t bone_palettes_offset;
+    std::uint64_t animated_transforms_upto_bone_offset;
+};
+
+struct BakedRiggedMeshRecord {
+    std::int32_t packed_texture_index;
+    std::uint32_t index_count;
+    std::uint32_t vertex_count;
+    std::uint32_t padding;
+    std::uint64_t indices_offset;
+    std::uint64_t xyz_positions_offset;
+    std::uint64_t normals_offset;
+    std::uint64_t packed_texture_coordinates_offset;
+    std::uint64_t bone_ids_offset;
+    std::uint64_t bone_weights_offset;
+};
+
+struct BakedBoneNameRange {
+    std::uint32_t offset;
+    std::uint32_t length;
+};
+
+const std::uint32_t BAKED_RIGGED_MODEL_VERSION = 1;
+
+/**
+ * one mesh of a baked model, everything points into the mapping of the file
+ */
+struct BakedRiggedMeshView {
+    int packed_texture_index;
+    std::span<const unsigned int> indices;
+    std::span<const glm::vec3> xyz_positions;
+    std::span<const glm::vec3> normals;
+    std::span<const glm::vec2> packed_texture_coordinates;
+    std::span<const glm::ivec4> bone_ids;
+    std::span<const glm::vec4> bone_weights;
+};
+
+/**
+ * 64 bit fnv-1a over the contents of every file in order followed by the settings the animation gets sampled with,
+ * this is what a bake is keyed by so that changing any of them bakes again
+ */
+std::uint64_t hash_baked_rigged_model_sources(const std::vector<std::string> &source_file_paths,
+                                              double animation_duration_sec, double samples_per_sec);
+
+/**
+ * one mesh as it goes into a bake, with its bone data already split into ids and weights
+ */
+struct BakedRiggedMeshSource {
+    int packed_texture_index;
+    std::vector<unsigned int> indices;
+    std::vector<glm::vec3> xyz_positions;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> packed_texture_coordinates;
+    std::vector<glm::ivec4> bone_ids;
+    std::vector<glm::vec4> bone_weights;
+};
+
+/**
+ * bakes whatever a rig was loaded into, bone_names and bind_pose_transforms are indexed by the bone's unique index and
+ * evaluate_pose is sampled from 0 to animation_duration_sec (inclusive) at samples_per_sec
+ */
+void bake_rigged_model(const std::string &file_path, std::uint64_t source_hash,
+                       const std::vector<BakedRiggedMeshSource> &meshes, const std::vector<std::string> &bone_names,
+                       const std::vector<glm::mat4> &bind_pose_transforms,
+                       const AnimationPoseCache::PoseEvaluator &evaluate_pose, double animation_duration_sec,
+                       double samples_per_sec);
+
+/**
+ * samples rirc's animation from 0 to animation_duration_sec (inclusive) at samples_per_sec, rirc has to hold the model
+ * that ivptprs were converted from
+ */
+void bake_rigged_model(const std::string &file_path, std::uint64_t source_hash,
+                       const std::vector<IVPNTPRigged> &ivptprs, RecIvpntRiggedCollector &rirc,
+                       double animation_duration_sec, double samples_per_sec);
+
+class BakedRiggedModel {
+  public:
+    /**
+     * memory maps a baked model, throws if it isn't one or was baked for a different version or platform
+     */
+    explicit BakedRiggedModel(const std::string &file_path);
+
+    std::uint64_t get_source_hash() const;
+
+    std::size_t get_mesh_count() const;
+    BakedRiggedMeshView get_mesh(std::size_t mesh_index) const;
+
+    std::size_t get_bone_count() const;
+    const std::unordered_map<std::string, unsigned int> &get_bone_name_to_index() const;
+    // BoneInfo::local_space_to_bone_space_in_bind_pose_transformation for every bone
+    std::span<const glm::mat4> get_bind_pose_transforms() const;
+
+    double get_samples_per_sec() const;
+    double get_duration_sec() const;
+
+    /**
+     * the two samples around time_sec blended linearly matrix by matrix, so the pose moves smoothly even when frames
+     * come faster than the samples. blending two rotations that are an angle apart shrinks the bone by up to
+     * 1 - cos(angle / 2) halfway between them, that stays under half a percent while no bone turns more than 11 degrees
+     * per sample, about 660 degrees per sec at the 60 samples per sec the smoking rig is baked at. a rig that moves
+     * faster has to be baked at a higher rate. times outside of what was baked hold the first or the last pose
+     */
+    void evaluate_pose(double time_sec, AnimationPose &pose) const;
+
+  private:
+    std::shared_ptr<const MappedFile> mapped_file;
+    const BakedRiggedModelHeader *header;
+    std::vector<BakedRiggedMeshView> meshes;
+    std::unordered_map<std::string, unsigned int> bone_name_to_index;
+    std::span<const glm::mat4> bind_pose_transforms;
+    std::span<const glm::mat4> bone_palettes;
+    std::span<const glm::mat4> animated_transforms_upto_bone;
+};
+
+/**
+ * the baked model at file_path if it exists and was baked from sources with this hash, nullptr otherwise
+ */
+std::shared_ptr<const BakedRiggedModel> try_load_baked_rigged_model(const std::string &file_path,
+                                                                    std::uint64_t source_hash);
+
+#endif // BAKED_RIGGED_MODEL_HPP
@@ -0,0 +1,52 @@
+#include "bone_socket_system.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+BoneSocketSystem::BoneSocketSystem(RecIvpntRiggedCollector &rirc)
+    : bone_name_to_index(rirc.bone_name_to_unique_index.begin(), rirc.bone_name_to_unique_index.end()) {
+    std::size_t num_bones = rirc.bone_unique_idx_to_info.size();
+    bind_pose_transforms.reserve(num_bones);
+    for (std::size_t bone_index = 0; bone_index < num_bones; bone_index++) {
+        bind_pose_transforms.push_back(
+            rirc.bone_unique_idx_to_info[bone_index].local_space_to_bone_space_in_bind_pose_transformation);
+    }
+}
+
+BoneSocketSystem::BoneSocketSystem(std::unordered_map<std::string, unsigned int> bone_name_to_index,
+                                   std::span<const glm::mat4> bind_pose_transforms)
+    : bone_name_to_index(std::move(bone_name_to_index)),
+      bind_pose_transforms(bind_pose_transforms.begin(), bind_pose_transforms.end()) {}
+
+unsigned int BoneSocketSystem::register_socket(const std::string &bone_name, Transform bone_origin_offset) {
+    auto it = bone_name_to_index.find(bone_name);
+    if (it == bone_name_to_index.end() or it->second >= bind_pose_transforms.size()) {
+        throw std::runtime_error("can't attach to bone " + bone_name + ", the rig has no bone with that name");
+    }
+    unsigned int bone_index = it->second;
+
+    // translates the origin to the bone's origin in bind pose, then applies the offset, the animated transform of the
+    // bone is applied on top of this every frame which works because the socket is relative to the bind pose now
+    glm::mat4 the_transform_that_translates_the_origin_to_the_bones_origin =
+        glm::inverse(bind_pose_transforms[bone_index]);
+
+    bone_indices.push_back(bone_index);
+    offset_times_inverse_bind_pose.push_back(bone_origin_offset.get_transform_matrix() *
+                                             the_transform_that_translates_the_origin_to_the_bones_origin);
+    socket_transforms.push_back(glm::mat4(1.0f));
+
+    return bone_indices.size() - 1;
+}
+
+void BoneSocketSystem::evaluate(const AnimationPose &animation_pose) {
+    for (std::size_t socket = 0; socket < bone_indices.size(); socket++) {
+        socket_transforms[socket] =
+            animation_pose.animated_transforms_upto_bone[bone_indices[socket]] * offset_times_inverse_bind_pose[socket];
+    }
+}
+
+const glm::mat4 &BoneSocketSystem::get_socket_transform(unsigned int socket) const {
+    return socket_transforms.at(socket);
+}
+
+std::size_t BoneSocketSystem::get_socket_count() const { return bone_indices.size(); }
@@ -0,0 +1,57 @@
+#ifndef BONE_SOCKET_SYSTEM_HPP
+#define BONE_SOCKET_SYSTEM_HPP
+
+#include "sbpt_generated_includes.hpp"
+
+#include <glm/glm.hpp>
+
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * so that you can attach items to bones and keep them attached while animations play. a socket is a bone plus an
+ * offset from that bone's origin, everything about it that doesn't depend on the pose (the bone lookup, the inverse
+ * of the bind pose and the offset) is worked out once when it is registered, leaving one matrix multiply per socket
+ * per frame.
+ */
+class BoneSocketSystem {
+  public:
+    explicit BoneSocketSystem(RecIvpntRiggedCollector &rirc);
+
+    /**
+     * for rigs that don't come from a collector, eg a BakedRiggedModel, bind_pose_transforms is
+     * BoneInfo::local_space_to_bone_space_in_bind_pose_transformation for every bone
+     */
+    BoneSocketSystem(std::unordered_map<std::string, unsigned int> bone_name_to_index,
+                     std::span<const glm::mat4> bind_pose_transforms);
+
+    /**
+     * returns the socket handle, throws if the rig has no bone with that name
+     */
+    unsigned int register_socket(const std::string &bone_name, Transform bone_origin_offset);
+
+    /**
+     * computes every socket transform for this pose in one pass, call it once per frame after the pose is evaluated
+     */
+    void evaluate(const AnimationPose &animation_pose);
+
+    /**
+     * the object to world transform of something sitting in the socket, as of the last evaluate
+     */
+    const glm::mat4 &get_socket_transform(unsigned int socket) const;
+
+    std::size_t get_socket_count() const;
+
+  private:
+    std::unordered_map<std::string, unsigned int> bone_name_to_index;
+    std::vector<glm::mat4> bind_pose_transforms;
+
+    // one entry per socket
+    std::vector<unsigned int> bone_indices;
+    std::vector<glm::mat4> offset_times_inverse_bind_pose;
+    std::vector<glm::mat4> socket_transforms;
+};
+
+#endif // BONE_SOCKET_SYSTEM_HPP
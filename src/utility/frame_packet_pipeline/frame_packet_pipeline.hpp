@@ -0,0 +1,161 @@
+#ifndef FRAME_PACKET_PIPELINE_HPP
+#define FRAME_PACKET_PIPELINE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+/**
+ * lets the simulation of the next frame run on a worker thread while the gl thread submits the current one. the
+ * simulation writes everything the gl thread needs (matrices, bone palettes, draw lists, ...) into a FramePacket and
+ * only ever touches the packet it was handed, the gl thread only reads the packet it acquired, so the two never share
+ * anything else while a frame is in flight.
+ *
+ * there are two packets, so the gl thread is always exactly one frame behind the simulation:
+ *
+ *     pipeline.begin_simulation(prepare);     // once before the loop, so that one packet is always ahead
+ *     while (running) {
+ *         pipeline.begin_simulation(prepare); // frame n + 1 starts simulating on the worker
+ *         const FramePacket &packet = pipeline.acquire_packet_to_render(); // waits for frame n
+ *         ...                                 // gl calls that read packet
+ *         pipeline.release_rendered_packet(); // frame n's packet is free for frame n + 2
+ *     }
+ *     pipeline.stop();
+ *
+ * prepare runs on the calling thread before the packet goes to the worker, it is where things that must be read on
+ * the gl thread (input, the clock) get copied into the packet.
+ */
+template <typename FramePacket> class FramePacketPipeline {
+  public:
+    explicit FramePacketPipeline(std::function<void(FramePacket &)> simulate)
+        : simulate(std::move(simulate)), worker([this] { run_worker(); }) {}
+
+    ~FramePacketPipeline() { stop(); }
+
+    FramePacketPipeline(const FramePacketPipeline &) = delete;
+    FramePacketPipeline &operator=(const FramePacketPipeline &) = delete;
+
+    /**
+     * prepares the free packet on this thread and hands it to the worker to simulate, waits if both packets are in use
+     */
+    void begin_simulation(const std::function<void(FramePacket &)> &prepare) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (stopping) {
+            throw std::runtime_error("frame packet pipeline was stopped");
+        }
+        // the packet for this frame was last used two frames ago, that frame has to be rendered and released
+        condition.wait(lock, [&] { return released_count + NUM_PACKETS > submitted_count; });
+        FramePacket &packet = packets[submitted_count % NUM_PACKETS];
+        lock.unlock();
+
+        // the worker never touches a packet before it's submitted, and the gl thread is done with it
+        prepare(packet);
+
+        lock.lock();
+        submitted_count++;
+        condition.notify_all();
+    }
+
+    /**
+     * waits for the oldest packet that hasn't been rendered yet, rethrows if its simulation threw. nothing after a
+     * failed frame gets simulated, so acquiring those rethrows as well. the packet stays valid until
+     * release_rendered_packet
+     */
+    const FramePacket &acquire_packet_to_render() {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (acquired) {
+            throw std::runtime_error("the previous frame packet was not released");
+        }
+        if (released_count == submitted_count) {
+            throw std::runtime_error("no frame packet is being simulated, call begin_simulation first");
+        }
+        condition.wait(lock, [&] { return simulated_count > released_count; });
+        // the frames before the failed one were simulated fine and still get rendered
+        if (simulation_exception and released_count >= failed_frame) {
+            std::rethrow_exception(simulation_exception);
+        }
+        acquired = true;
+        return packets[released_count % NUM_PACKETS];
+    }
+
+    void release_rendered_packet() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (not acquired) {
+            throw std::runtime_error("no frame packet was acquired");
+        }
+        acquired = false;
+        released_count++;
+        condition.notify_all();
+    }
+
+    /**
+     * finishes the packet the worker is on and joins it, packets that were submitted but not started are dropped.
+     * call this before anything that simulate refers to goes away, the destructor does it too
+     */
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition.notify_all();
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+  private:
+    static constexpr std::size_t NUM_PACKETS = 2;
+
+    void run_worker() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            condition.wait(lock, [&] { return stopping or simulated_count < submitted_count; });
+            if (stopping) {
+                return;
+            }
+            FramePacket &packet = packets[simulated_count % NUM_PACKETS];
+            lock.unlock();
+
+            std::exception_ptr exception;
+            if (not simulation_exception) {
+                try {
+                    simulate(packet);
+                } catch (...) {
+                    exception = std::current_exception();
+                }
+            }
+
+            lock.lock();
+            if (exception and not simulation_exception) {
+                simulation_exception = exception;
+                failed_frame = simulated_count;
+            }
+            simulated_count++;
+            condition.notify_all();
+        }
+    }
+
+    std::function<void(FramePacket &)> simulate;
+    FramePacket packets[NUM_PACKETS];
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    // frame i uses packets[i % NUM_PACKETS], released <= simulated <= submitted
+    std::size_t submitted_count = 0;
+    std::size_t simulated_count = 0;
+    std::size_t released_count = 0;
+    bool acquired = false;
+    bool stopping = false;
+    std::exception_ptr simulation_exception;
+    std::size_t failed_frame = 0; // the frame whose simulation threw, once simulation_exception is set
+
+    // last so that everything it uses exists before it starts
+    std::thread worker;
+};
+
+#endif // FRAME_PACKET_PIPELINE_HPP
@@ -0,0 +1,211 @@
+#include "frame_profiler.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+FrameProfilerThreadRing::FrameProfilerThreadRing(unsigned int thread_index)
+    : thread_index{thread_index}, events{}, write_position{0}, read_position{0} {}
+
+void FrameProfilerThreadRing::push(const FrameProfilerEvent &event) {
+    std::uint64_t position = write_position.load(std::memory_order_relaxed);
+    FrameProfilerEvent &slot = events[position % CAPACITY];
+    slot = event;
+    slot.thread_index = thread_index;
+    write_position.store(position + 1, std::memory_order_release);
+}
+
+std::size_t FrameProfilerThreadRing::drain(std::vector<FrameProfilerEvent> &drained_events) {
+    std::uint64_t end = write_position.load(std::memory_order_acquire);
+    std::uint64_t begin = std::max(read_position, end > CAPACITY ? end - CAPACITY : 0);
+    std::size_t lost = begin - read_position;
+
+    std::size_t first_copied = drained_events.size();
+    for (std::uint64_t position = begin; position < end; position++) {
+        drained_events.push_back(events[position % CAPACITY]);
+    }
+
+    // whatever the writer lapped while we were copying may be torn, drop it. an acquire load alone lets the copies
+    // above be reordered after it, the fence keeps them before it so a lap during the copy is always seen. the writer
+    // may already be writing the slot of end_after_copy without having published it, so that slot counts as lapped too
+    std::atomic_thread_fence(std::memory_order_acquire);
+    std::uint64_t end_after_copy = write_position.load(std::memory_order_acquire);
+    if (end_after_copy + 1 > CAPACITY and end_after_copy + 1 - CAPACITY > begin) {
+        std::uint64_t overwritten = std::min(end_after_copy + 1 - CAPACITY, end) - begin;
+        drained_events.erase(drained_events.begin() + first_copied,
+                             drained_events.begin() + first_copied + overwritten);
+        lost += overwritten;
+    }
+
+    read_position = end;
+    return lost;
+}
+
+unsigned int FrameProfilerThreadRing::get_thread_index() const { return thread_index; }
+
+FrameProfiler &FrameProfiler::get() {
+    static FrameProfiler frame_profiler;
+    return frame_profiler;
+}
+
+FrameProfiler::FrameProfiler()
+    : epoch{std::chrono::steady_clock::now()}, last_frame_mark_ns{0}, lost_event_count{0}, frame_count{0},
+      window_frames{600}, summary_interval_frames{600} {}
+
+std::int64_t FrameProfiler::now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - get().epoch)
+        .count();
+}
+
+FrameProfilerThreadRing &FrameProfiler::get_thread_ring() {
+    // rings are never freed, a thread that exits leaves its ring behind to be drained
+    thread_local FrameProfilerThreadRing *thread_ring = nullptr;
+    if (thread_ring == nullptr) {
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        rings.push_back(std::make_unique<FrameProfilerThreadRing>(rings.size()));
+        thread_ring = rings.back().get();
+    }
+    return *thread_ring;
+}
+
+void FrameProfiler::record_zone(const char *name, std::int64_t start_ns, std::int64_t end_ns) {
+    get_thread_ring().push({name, start_ns, end_ns - start_ns, FrameProfilerEventType::ZONE, 0});
+}
+
+void FrameProfiler::record_counter(const char *name, std::int64_t value) {
+    get_thread_ring().push({name, now_ns(), value, FrameProfilerEventType::COUNTER, 0});
+}
+
+void FrameProfiler::mark_frame() {
+    std::int64_t frame_end_ns = now_ns();
+    if (frame_count > 0) {
+        record_zone("frame", last_frame_mark_ns, frame_end_ns);
+    }
+    last_frame_mark_ns = frame_end_ns;
+
+    drained_events.clear();
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        for (auto &ring : rings) {
+            lost_event_count += ring->drain(drained_events);
+        }
+    }
+
+    for (const FrameProfilerEvent &event : drained_events) {
+        if (event.type == FrameProfilerEventType::ZONE) {
+            zone_durations_ns[event.name].emplace_back(frame_count, event.duration_ns_or_value);
+        } else {
+            latest_counters[event.name] = event.duration_ns_or_value;
+        }
+    }
+    for (auto &[name, durations] : zone_durations_ns) {
+        while (not durations.empty() and durations.front().first + window_frames <= frame_count) {
+            durations.pop_front();
+        }
+    }
+
+    recent_frames.push_back(drained_events);
+    while (recent_frames.size() > window_frames) {
+        recent_frames.pop_front();
+    }
+
+    frame_count++;
+    if (summary_interval_frames > 0 and frame_count % summary_interval_frames == 0) {
+        log_summary();
+    }
+}
+
+void FrameProfiler::set_sinks(const std::vector<spdlog::sink_ptr> &sinks) {
+    logger = std::make_shared<spdlog::logger>("frame_profiler", sinks.begin(), sinks.end());
+}
+
+void FrameProfiler::set_summary_interval_frames(unsigned int summary_interval_frames) {
+    this->summary_interval_frames = summary_interval_frames;
+}
+
+void FrameProfiler::set_window_frames(unsigned int window_frames) {
+    if (window_frames == 0) {
+        throw std::runtime_error("the frame profiler window needs at least one frame");
+    }
+    this->window_frames = window_frames;
+}
+
+std::vector<FrameProfilerZoneSummary> FrameProfiler::get_zone_summaries() const {
+    std::vector<FrameProfilerZoneSummary> zone_summaries;
+    std::vector<std::int64_t> sorted_durations;
+    for (const auto &[name, durations] : zone_durations_ns) {
+        if (durations.empty()) {
+            continue;
+        }
+        sorted_durations.clear();
+        for (const auto &[frame, duration_ns] : durations) {
+            sorted_durations.push_back(duration_ns);
+        }
+        std::sort(sorted_durations.begin(), sorted_durations.end());
+
+        auto percentile_ms = [&](double percentile) {
+            std::size_t index = static_cast<std::size_t>(percentile * (sorted_durations.size() - 1) + 0.5);
+            return sorted_durations[index] / 1e6;
+        };
+        zone_summaries.push_back({name, sorted_durations.size(), percentile_ms(0.5), percentile_ms(0.95),
+                                  percentile_ms(0.99), sorted_durations.back() / 1e6});
+    }
+
+    // the most expensive zones first
+    std::sort(zone_summaries.begin(), zone_summaries.end(),
+              [](const FrameProfilerZoneSummary &a, const FrameProfilerZoneSummary &b) { return a.p95_ms > b.p95_ms; });
+    return zone_summaries;
+}
+
+std::int64_t FrameProfiler::get_counter(const std::string &name) const {
+    auto it = latest_counters.find(name);
+    return it == latest_counters.end() ? 0 : it->second;
+}
+
+std::size_t FrameProfiler::get_lost_event_count() const { return lost_event_count; }
+
+void FrameProfiler::log_summary() {
+    std::shared_ptr<spdlog::logger> summary_logger = logger ? logger : spdlog::default_logger();
+
+    summary_logger->info("frame profile over the last {} frames, {} events lost", window_frames, lost_event_count);
+    for (const FrameProfilerZoneSummary &zone_summary : get_zone_summaries()) {
+        summary_logger->info("  {:<24} p50 {:8.3f}ms  p95 {:8.3f}ms  p99 {:8.3f}ms  max {:8.3f}ms  ({} samples)",
+                             zone_summary.name, zone_summary.p50_ms, zone_summary.p95_ms, zone_summary.p99_ms,
+                             zone_summary.max_ms, zone_summary.sample_count);
+    }
+    for (const auto &[name, value] : latest_counters) {
+        summary_logger->info("  {:<24} {}", name, value);
+    }
+}
+
+void FrameProfiler::write_chrome_trace(const std::string &file_path) const {
+    std::ofstream file(file_path);
+    if (not file.is_open()) {
+        throw std::runtime_error("couldn't open " + file_path + " for writing");
+    }
+
+    // names come from string literals in the source so they don't need escaping
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (const std::vector<FrameProfilerEvent> &frame_events : recent_frames) {
+        for (const FrameProfilerEvent &event : frame_events) {
+            file << (first ? "\n" : ",\n");
+            first = false;
+            double timestamp_us = event.start_ns / 1e3;
+            if (event.type == FrameProfilerEventType::ZONE) {
+                file << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.thread_index
+                     << ",\"ts\":" << std::to_string(timestamp_us)
+                     << ",\"dur\":" << std::to_string(event.duration_ns_or_value / 1e3) << "}";
+            } else {
+                file << "{\"name\":\"" << event.name << "\",\"ph\":\"C\",\"pid\":0,\"tid\":" << event.thread_index
+                     << ",\"ts\":" << std::to_string(timestamp_us) << ",\"args\":{\"value\":"
+                     << event.duration_ns_or_value << "}}";
+            }
+        }
+    }
+    file << "\n]}\n";
+
+    if (not file.good()) {
+        throw std::runtime_error("failed to write chrome trace " + file_path);
+    }
+}
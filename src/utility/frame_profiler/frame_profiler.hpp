@@ -0,0 +1,183 @@
+#ifndef FRAME_PROFILER_HPP
+#define FRAME_PROFILER_HPP
+
+#include <spdlog/spdlog.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * scoped zones and counters that get recorded into a ring buffer per thread, nothing is locked and nothing is
+ * allocated on the recording side. once per frame the main thread drains every ring, keeps the recent events around for
+ * a chrome trace (chrome://tracing or ui.perfetto.dev) and keeps a rolling window of durations per zone for percentile
+ * summaries that go out through spdlog.
+ *
+ * use it through the macros, without ENABLE_FRAME_PROFILER defined they expand to nothing at all:
+ *
+ *     FRAME_PROFILER_ZONE("particles");             // until the end of the enclosing scope
+ *     FRAME_PROFILER_NAMED_ZONE(bones_zone, "bones");
+ *     FRAME_PROFILER_ZONE_END(bones_zone);          // or end it early
+ *     FRAME_PROFILER_COUNTER("draws", draw_count);
+ *     FRAME_PROFILER_FRAME_MARK();                  // once per frame on the main thread, ends the frame
+ *
+ * zone and counter names have to be string literals (or otherwise live forever), only the pointer is recorded.
+ */
+enum class FrameProfilerEventType : std::uint8_t {
+    ZONE,
+    COUNTER,
+};
+
+struct FrameProfilerEvent {
+    const char *name;
+    std::int64_t start_ns;
+    std::int64_t duration_ns_or_value; // the duration for a zone, the value for a counter
+    FrameProfilerEventType type;
+    std::uint32_t thread_index;
+};
+
+/**
+ * single producer single consumer, the owning thread writes and the thread that calls collect reads. when the reader
+ * falls a ring behind the oldest events are lost rather than blocking the writer, the slot the writer fills next counts
+ * as lost as well since it may be halfway through writing it.
+ */
+class FrameProfilerThreadRing {
+  public:
+    static constexpr std::size_t CAPACITY = 1 << 14;
+
+    explicit FrameProfilerThreadRing(unsigned int thread_index);
+
+    void push(const FrameProfilerEvent &event);
+
+    /**
+     * appends every event written since the last drain to events, returns how many were lost to overrun
+     */
+    std::size_t drain(std::vector<FrameProfilerEvent> &events);
+
+    unsigned int get_thread_index() const;
+
+  private:
+    unsigned int thread_index;
+    std::array<FrameProfilerEvent, CAPACITY> events;
+    std::atomic<std::uint64_t> write_position;
+    std::uint64_t read_position;
+};
+
+struct FrameProfilerZoneSummary {
+    std::string name;
+    std::size_t sample_count;
+    double p50_ms;
+    double p95_ms;
+    double p99_ms;
+    double max_ms;
+};
+
+class FrameProfiler {
+  public:
+    static FrameProfiler &get();
+
+    static std::int64_t now_ns();
+
+    void record_zone(const char *name, std::int64_t start_ns, std::int64_t end_ns);
+    void record_counter(const char *name, std::int64_t value);
+
+    /**
+     * ends the current frame: drains the rings, updates the rolling windows and every summary_interval_frames logs a
+     * summary
+     */
+    void mark_frame();
+
+    /**
+     * the summary goes to a logger made from these sinks, eg the ones the shader cache logs to
+     */
+    void set_sinks(const std::vector<spdlog::sink_ptr> &sinks);
+    void set_summary_interval_frames(unsigned int summary_interval_frames);
+
+    /**
+     * how many frames the percentiles are taken over, and how many frames of events are kept for the trace
+     */
+    void set_window_frames(unsigned int window_frames);
+
+    std::vector<FrameProfilerZoneSummary> get_zone_summaries() const;
+    std::int64_t get_counter(const std::string &name) const;
+    std::size_t get_lost_event_count() const;
+
+    void log_summary();
+    void write_chrome_trace(const std::string &file_path) const;
+
+  private:
+    FrameProfiler();
+
+    FrameProfilerThreadRing &get_thread_ring();
+
+    std::chrono::steady_clock::time_point epoch;
+
+    std::mutex rings_mutex;
+    std::vector<std::unique_ptr<FrameProfilerThreadRing>> rings;
+
+    // only touched by the thread calling mark_frame
+    std::vector<FrameProfilerEvent> drained_events;
+    std::deque<std::vector<FrameProfilerEvent>> recent_frames;
+    // a window of (frame, duration) samples per zone
+    std::unordered_map<std::string, std::deque<std::pair<unsigned long long, std::int64_t>>> zone_durations_ns;
+    std::unordered_map<std::string, std::int64_t> latest_counters;
+    std::int64_t last_frame_mark_ns;
+    std::size_t lost_event_count;
+    unsigned long long frame_count;
+    unsigned int window_frames;
+    unsigned int summary_interval_frames;
+    std::shared_ptr<spdlog::logger> logger;
+};
+
+class FrameProfilerScopedZone {
+  public:
+    explicit FrameProfilerScopedZone(const char *name) : name{name}, start_ns{FrameProfiler::now_ns()} {}
+    ~FrameProfilerScopedZone() { end(); }
+
+    /**
+     * closes the zone early, this is for phases whose locals are used further down so they can't get their own block
+     */
+    void end() {
+        if (not ended) {
+            FrameProfiler::get().record_zone(name, start_ns, FrameProfiler::now_ns());
+            ended = true;
+        }
+    }
+
+    FrameProfilerScopedZone(const FrameProfilerScopedZone &) = delete;
+    FrameProfilerScopedZone &operator=(const FrameProfilerScopedZone &) = delete;
+
+  private:
+    const char *name;
+    std::int64_t start_ns;
+    bool ended = false;
+};
+
+#define FRAME_PROFILER_CONCATENATE_INNER(a, b) a##b
+#define FRAME_PROFILER_CONCATENATE(a, b) FRAME_PROFILER_CONCATENATE_INNER(a, b)
+
+#ifdef ENABLE_FRAME_PROFILER
+#define FRAME_PROFILER_ZONE(name)                                                                                     \
+    FrameProfilerScopedZone FRAME_PROFILER_CONCATENATE(frame_profiler_zone_, __LINE__)(name)
+#define FRAME_PROFILER_NAMED_ZONE(variable, name) FrameProfilerScopedZone variable(name)
+#define FRAME_PROFILER_ZONE_END(variable) variable.end()
+#define FRAME_PROFILER_COUNTER(name, value) FrameProfiler::get().record_counter(name, static_cast<std::int64_t>(value))
+#define FRAME_PROFILER_FRAME_MARK() FrameProfiler::get().mark_frame()
+#else
+#define FRAME_PROFILER_ZONE(name)
+#define FRAME_PROFILER_NAMED_ZONE(variable, name)
+#define FRAME_PROFILER_ZONE_END(variable)
+#define FRAME_PROFILER_COUNTER(name, value)
+#define FRAME_PROFILER_FRAME_MARK()
+#endif
+
+#endif // FRAME_PROFILER_HPP
@@ -0,0 +1,82 @@
+#include "mapped_file.hpp"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string &file_path)
+    : mapped_data{nullptr}, mapped_size{0}, file_handle{INVALID_HANDLE_VALUE}, mapping_handle{nullptr} {
+    file_handle = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("MappedFile couldn't open " + file_path);
+    }
+
+    LARGE_INTEGER file_size;
+    if (not GetFileSizeEx(file_handle, &file_size) or file_size.QuadPart == 0) {
+        CloseHandle(file_handle);
+        throw std::runtime_error("MappedFile can't map the empty or unreadable file " + file_path);
+    }
+    mapped_size = static_cast<std::size_t>(file_size.QuadPart);
+
+    mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_handle == nullptr) {
+        CloseHandle(file_handle);
+        throw std::runtime_error("MappedFile couldn't create a mapping of " + file_path);
+    }
+
+    mapped_data = static_cast<const std::byte *>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+    if (mapped_data == nullptr) {
+        CloseHandle(mapping_handle);
+        CloseHandle(file_handle);
+        throw std::runtime_error("MappedFile couldn't map " + file_path);
+    }
+}
+
+MappedFile::~MappedFile() {
+    UnmapViewOfFile(mapped_data);
+    CloseHandle(mapping_handle);
+    CloseHandle(file_handle);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string &file_path) : mapped_data{nullptr}, mapped_size{0} {
+    int file_descriptor = open(file_path.c_str(), O_RDONLY);
+    if (file_descriptor == -1) {
+        throw std::runtime_error("MappedFile couldn't open " + file_path);
+    }
+
+    struct stat file_status;
+    if (fstat(file_descriptor, &file_status) == -1 or file_status.st_size == 0) {
+        close(file_descriptor);
+        throw std::runtime_error("MappedFile can't map the empty or unreadable file " + file_path);
+    }
+    mapped_size = static_cast<std::size_t>(file_status.st_size);
+
+    void *mapping = mmap(nullptr, mapped_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+    // the mapping stays valid after the descriptor is closed
+    close(file_descriptor);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("MappedFile couldn't map " + file_path);
+    }
+    mapped_data = static_cast<const std::byte *>(mapping);
+}
+
+MappedFile::~MappedFile() { munmap(const_cast<std::byte *>(mapped_data), mapped_size); }
+
+#endif
+
+const std::byte *MappedFile::data() const { return mapped_data; }
+
+std::size_t MappedFile::size() const { return mapped_size; }
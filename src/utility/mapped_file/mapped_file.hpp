@@ -0,0 +1,31 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+
+/**
+ * maps a whole file into memory read only, the mapping lives as long as the object does, so anything that points into
+ * it should hold on to the object (usually through a shared_ptr)
+ */
+class MappedFile {
+  public:
+    explicit MappedFile(const std::string &file_path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const std::byte *data() const;
+    std::size_t size() const;
+
+  private:
+    const std::byte *mapped_data;
+    std::size_t mapped_size;
+#ifdef _WIN32
+    void *file_handle;
+    void *mapping_handle;
+#endif
+};
+
+#endif // MAPPED_FILE_HPP
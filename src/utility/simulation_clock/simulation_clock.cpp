@@ -0,0 +1,36 @@
+#include "simulation_clock.hpp"
+
+SimulationClock::SimulationClock(std::function<double()> time_source_sec)
+    : mode{SimulationClockMode::REAL_TIME}, time_source_sec{time_source_sec}, fixed_timestep_sec{0.0},
+      start_time_sec{time_source_sec()}, time_sec{start_time_sec}, delta_time_sec{0.0}, tick_count{0} {}
+
+SimulationClock::SimulationClock(double fixed_timestep_sec, double start_time_sec)
+    : mode{SimulationClockMode::FIXED_TIMESTEP}, time_source_sec{}, fixed_timestep_sec{fixed_timestep_sec},
+      start_time_sec{start_time_sec}, time_sec{start_time_sec}, delta_time_sec{0.0}, tick_count{0} {}
+
+void SimulationClock::tick() {
+    double previous_time_sec = time_sec;
+    tick_count++;
+
+    switch (mode) {
+    case SimulationClockMode::REAL_TIME:
+        time_sec = time_source_sec();
+        break;
+    case SimulationClockMode::FIXED_TIMESTEP:
+        // multiplying instead of accumulating keeps long runs free of drift
+        time_sec = start_time_sec + tick_count * fixed_timestep_sec;
+        break;
+    }
+
+    delta_time_sec = time_sec - previous_time_sec;
+}
+
+SimulationClockMode SimulationClock::get_mode() const { return mode; }
+
+double SimulationClock::get_time_sec() const { return time_sec; }
+
+double SimulationClock::get_time_ms() const { return time_sec * 1000.0; }
+
+double SimulationClock::get_delta_time_sec() const { return delta_time_sec; }
+
+unsigned long long SimulationClock::get_tick_count() const { return tick_count; }
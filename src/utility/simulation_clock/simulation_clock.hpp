@@ -0,0 +1,46 @@
+#ifndef SIMULATION_CLOCK_HPP
+#define SIMULATION_CLOCK_HPP
+
+#include <functional>
+
+enum class SimulationClockMode {
+    REAL_TIME,      // every tick reads the time source
+    FIXED_TIMESTEP, // every tick advances by the same amount no matter how long it actually took
+};
+
+/**
+ * the single source of "now" for a frame, tick once at the start of the frame and have every subsystem read the time
+ * from here so that they all agree on it
+ */
+class SimulationClock {
+  public:
+    /**
+     * real time clock driven by time_source_sec, eg glfwGetTime
+     */
+    explicit SimulationClock(std::function<double()> time_source_sec);
+
+    /**
+     * fixed timestep clock starting at start_time_sec, it doesn't need a window or a wall clock so it can run as fast
+     * as the cpu allows
+     */
+    explicit SimulationClock(double fixed_timestep_sec, double start_time_sec = 0.0);
+
+    void tick();
+
+    SimulationClockMode get_mode() const;
+    double get_time_sec() const;
+    double get_time_ms() const;
+    double get_delta_time_sec() const;
+    unsigned long long get_tick_count() const;
+
+  private:
+    SimulationClockMode mode;
+    std::function<double()> time_source_sec;
+    double fixed_timestep_sec;
+    double start_time_sec;
+    double time_sec;
+    double delta_time_sec;
+    unsigned long long tick_count;
+};
+
+#endif // SIMULATION_CLOCK_HPP
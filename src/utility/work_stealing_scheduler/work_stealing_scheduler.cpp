@@ -0,0 +1,260 @@
+#include "work_stealing_scheduler.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace {
+// which scheduler the current thread is a worker of, and the index of its deque
+thread_local const WorkStealingScheduler *current_thread_scheduler = nullptr;
+thread_local std::size_t current_thread_queue_index = 0;
+} // namespace
+
+WorkStealingScheduler::WorkStealingScheduler(unsigned int num_workers, bool deterministic)
+    : num_workers{num_workers}, deterministic{deterministic}, stopping{false} {
+    for (unsigned int i = 0; i < num_workers + 1; i++) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    for (unsigned int i = 0; i < num_workers; i++) {
+        workers.emplace_back([this, i] { worker_loop(i); });
+    }
+}
+
+WorkStealingScheduler::~WorkStealingScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping = true;
+    }
+    sleep_condition.notify_all();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+unsigned int WorkStealingScheduler::default_num_workers() {
+    unsigned int hardware_threads = std::thread::hardware_concurrency();
+    // the thread that waits on the work works through it as well
+    return hardware_threads > 1 ? hardware_threads - 1 : 1;
+}
+
+WorkStealingScheduler::TaskId WorkStealingScheduler::add_task(std::function<void()> work,
+                                                              const std::vector<TaskId> &dependencies) {
+    TaskId task_id = tasks.size();
+    for (TaskId dependency : dependencies) {
+        if (dependency >= task_id) {
+            throw std::runtime_error("task " + std::to_string(task_id) + " depends on task " +
+                                     std::to_string(dependency) + " which wasn't added before it");
+        }
+    }
+
+    Task &task = tasks.emplace_back();
+    task.work = std::move(work);
+    task.unfinished_dependencies = dependencies.size();
+    for (TaskId dependency : dependencies) {
+        tasks[dependency].dependents.push_back(task_id);
+    }
+    return task_id;
+}
+
+void WorkStealingScheduler::run_tasks() {
+    if (tasks.empty()) {
+        return;
+    }
+
+    if (runs_serially()) {
+        // dependencies always come before their dependents, so adding order is a valid order
+        std::deque<Task> serial_tasks = std::move(tasks);
+        tasks.clear();
+        for (Task &task : serial_tasks) {
+            task.work();
+        }
+        return;
+    }
+
+    WorkBatch batch;
+    batch.remaining = tasks.size();
+    // collected before anything is pushed, once a task runs it can bring a later task down to zero and push it itself
+    std::vector<TaskId> ready_task_ids;
+    for (TaskId task_id = 0; task_id < tasks.size(); task_id++) {
+        if (tasks[task_id].unfinished_dependencies == 0) {
+            ready_task_ids.push_back(task_id);
+        }
+    }
+    std::size_t queue_index = get_current_queue_index();
+    // pushed back to front so that this thread starts with the first one
+    for (auto it = ready_task_ids.rbegin(); it != ready_task_ids.rend(); it++) {
+        make_task_item(*it, batch, queue_index);
+    }
+    wait_for(batch);
+
+    tasks.clear();
+    if (batch.first_exception) {
+        std::rethrow_exception(batch.first_exception);
+    }
+}
+
+void WorkStealingScheduler::make_task_item(TaskId task_id, WorkBatch &batch, std::size_t queue_index) {
+    push(queue_index, {[this, task_id, &batch] {
+                           Task &task = tasks[task_id];
+                           // once something failed nothing new starts, but everything still counts as done
+                           if (not batch.failed) {
+                               try {
+                                   task.work();
+                               } catch (...) {
+                                   // before the dependents are pushed so that they see it
+                                   record_exception(batch, std::current_exception());
+                               }
+                           }
+                           std::size_t dependent_queue_index = get_current_queue_index();
+                           for (TaskId dependent : task.dependents) {
+                               if (--tasks[dependent].unfinished_dependencies == 0) {
+                                   make_task_item(dependent, batch, dependent_queue_index);
+                               }
+                           }
+                       },
+                       &batch});
+}
+
+void WorkStealingScheduler::parallel_for(std::size_t begin, std::size_t end, std::size_t grain_size,
+                                         const std::function<void(std::size_t, std::size_t)> &body) {
+    if (end <= begin) {
+        return;
+    }
+    grain_size = std::max<std::size_t>(grain_size, 1);
+    std::size_t num_chunks = (end - begin + grain_size - 1) / grain_size;
+
+    if (runs_serially() or num_chunks == 1) {
+        for (std::size_t chunk_begin = begin; chunk_begin < end; chunk_begin += grain_size) {
+            body(chunk_begin, std::min(chunk_begin + grain_size, end));
+        }
+        return;
+    }
+
+    WorkBatch batch;
+    batch.remaining = num_chunks;
+    std::size_t queue_index = get_current_queue_index();
+    // pushed back to front so that this thread pops them in order while the others steal from the far end
+    for (std::size_t chunk = num_chunks; chunk-- > 0;) {
+        std::size_t chunk_begin = begin + chunk * grain_size;
+        std::size_t chunk_end = std::min(chunk_begin + grain_size, end);
+        push(queue_index, {[&body, &batch, chunk_begin, chunk_end] {
+                               if (not batch.failed) {
+                                   body(chunk_begin, chunk_end);
+                               }
+                           },
+                           &batch});
+    }
+    wait_for(batch);
+
+    if (batch.first_exception) {
+        std::rethrow_exception(batch.first_exception);
+    }
+}
+
+void WorkStealingScheduler::set_deterministic(bool deterministic) { this->deterministic = deterministic; }
+
+bool WorkStealingScheduler::is_deterministic() const { return deterministic; }
+
+unsigned int WorkStealingScheduler::get_num_workers() const { return num_workers; }
+
+std::size_t WorkStealingScheduler::get_steal_count() const { return steal_count; }
+
+bool WorkStealingScheduler::runs_serially() const { return deterministic or num_workers == 0; }
+
+void WorkStealingScheduler::push(std::size_t queue_index, WorkItem item) {
+    {
+        // under the sleep mutex so that a thread that is about to sleep can't miss it, and under the queue mutex so
+        // that the count never drops below what is queued
+        std::lock_guard<std::mutex> sleep_lock(sleep_mutex);
+        std::lock_guard<std::mutex> queue_lock(queues[queue_index]->mutex);
+        queues[queue_index]->items.push_back(std::move(item));
+        queued_count++;
+    }
+    sleep_condition.notify_one();
+}
+
+bool WorkStealingScheduler::try_pop_or_steal(std::size_t queue_index, WorkItem &item) {
+    {
+        WorkQueue &own_queue = *queues[queue_index];
+        std::lock_guard<std::mutex> lock(own_queue.mutex);
+        if (not own_queue.items.empty()) {
+            item = std::move(own_queue.items.back());
+            own_queue.items.pop_back();
+            queued_count--;
+            return true;
+        }
+    }
+
+    for (std::size_t offset = 1; offset < queues.size(); offset++) {
+        WorkQueue &victim_queue = *queues[(queue_index + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim_queue.mutex);
+        if (not victim_queue.items.empty()) {
+            item = std::move(victim_queue.items.front());
+            victim_queue.items.pop_front();
+            queued_count--;
+            steal_count++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingScheduler::record_exception(WorkBatch &batch, std::exception_ptr exception) {
+    std::lock_guard<std::mutex> lock(batch.exception_mutex);
+    if (not batch.first_exception) {
+        batch.first_exception = exception;
+    }
+    batch.failed = true;
+}
+
+void WorkStealingScheduler::execute(WorkItem &item) {
+    WorkBatch &batch = *item.batch;
+    try {
+        item.work();
+    } catch (...) {
+        record_exception(batch, std::current_exception());
+    }
+
+    if (--batch.remaining == 0) {
+        // the waiter checks remaining under the sleep mutex, taking it here means the notify can't slip in before it
+        // goes to sleep
+        { std::lock_guard<std::mutex> lock(sleep_mutex); }
+        sleep_condition.notify_all();
+    }
+}
+
+void WorkStealingScheduler::wait_for(WorkBatch &batch) {
+    std::size_t queue_index = get_current_queue_index();
+    WorkItem item;
+    while (batch.remaining > 0) {
+        if (try_pop_or_steal(queue_index, item)) {
+            execute(item);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        sleep_condition.wait(lock, [&] { return batch.remaining == 0 or queued_count > 0; });
+    }
+}
+
+void WorkStealingScheduler::worker_loop(std::size_t queue_index) {
+    current_thread_scheduler = this;
+    current_thread_queue_index = queue_index;
+
+    WorkItem item;
+    while (true) {
+        if (try_pop_or_steal(queue_index, item)) {
+            execute(item);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        sleep_condition.wait(lock, [&] { return stopping or queued_count > 0; });
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+std::size_t WorkStealingScheduler::get_current_queue_index() const {
+    // threads that aren't workers of this scheduler share the last deque
+    return current_thread_scheduler == this ? current_thread_queue_index : num_workers;
+}
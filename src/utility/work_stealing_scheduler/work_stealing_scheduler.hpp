@@ -0,0 +1,120 @@
+#ifndef WORK_STEALING_SCHEDULER_HPP
+#define WORK_STEALING_SCHEDULER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * spreads per frame work over a fixed set of worker threads. every worker has its own deque, it pushes and pops at the
+ * back of its own and when that runs dry it steals from the front of the others, so work that was split up lands back
+ * on idle cores without a central queue everybody fights over. the thread that waits on work (run_tasks or
+ * parallel_for) works through tasks too instead of blocking, so nesting a parallel_for inside a task is fine.
+ *
+ * in deterministic mode nothing is handed to the workers, tasks run on the calling thread in the order they were added
+ * and parallel_for chunks run in order. the chunks are the same in both modes, so results that are combined per chunk
+ * in chunk order come out bit for bit the same, which is how parallel results are checked against serial ones.
+ */
+class WorkStealingScheduler {
+  public:
+    using TaskId = std::size_t;
+
+    /**
+     * with zero workers everything runs on the calling thread, the same as deterministic mode
+     */
+    explicit WorkStealingScheduler(unsigned int num_workers = default_num_workers(), bool deterministic = false);
+    ~WorkStealingScheduler();
+
+    WorkStealingScheduler(const WorkStealingScheduler &) = delete;
+    WorkStealingScheduler &operator=(const WorkStealingScheduler &) = delete;
+
+    /**
+     * the task starts once every task in dependencies finished, dependencies have to be added before it
+     */
+    TaskId add_task(std::function<void()> work, const std::vector<TaskId> &dependencies = {});
+
+    /**
+     * runs every added task and returns once they're done, then the tasks are cleared so the next frame can add its
+     * own. if a task throws nothing new is started, the tasks already running are waited on and the first exception
+     * is rethrown here. adding and running tasks is for one thread at a time, parallel_for can be called from anywhere
+     */
+    void run_tasks();
+
+    /**
+     * calls body(chunk_begin, chunk_end) over [begin, end) cut into chunks of grain_size (the last one may be
+     * shorter), returns once every chunk is done and rethrows the first exception of a chunk. pick the grain size so
+     * that one chunk is worth more than a task handoff, a few microseconds of work
+     */
+    void parallel_for(std::size_t begin, std::size_t end, std::size_t grain_size,
+                      const std::function<void(std::size_t chunk_begin, std::size_t chunk_end)> &body);
+
+    void set_deterministic(bool deterministic);
+    bool is_deterministic() const;
+
+    unsigned int get_num_workers() const;
+    // how many times a thread took work from another thread's deque
+    std::size_t get_steal_count() const;
+
+    static unsigned int default_num_workers();
+
+  private:
+    /**
+     * a set of work items that somebody is waiting on
+     */
+    struct WorkBatch {
+        std::atomic<std::size_t> remaining{0};
+        std::atomic<bool> failed{false};
+        std::mutex exception_mutex;
+        std::exception_ptr first_exception;
+    };
+
+    struct WorkItem {
+        std::function<void()> work;
+        WorkBatch *batch;
+    };
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<WorkItem> items;
+    };
+
+    struct Task {
+        std::function<void()> work;
+        std::vector<TaskId> dependents;
+        std::atomic<unsigned int> unfinished_dependencies{0};
+    };
+
+    bool runs_serially() const;
+    void push(std::size_t queue_index, WorkItem item);
+    bool try_pop_or_steal(std::size_t queue_index, WorkItem &item);
+    void execute(WorkItem &item);
+    static void record_exception(WorkBatch &batch, std::exception_ptr exception);
+    void wait_for(WorkBatch &batch);
+    void worker_loop(std::size_t queue_index);
+    void make_task_item(TaskId task_id, WorkBatch &batch, std::size_t queue_index);
+    std::size_t get_current_queue_index() const;
+
+    unsigned int num_workers;
+    std::atomic<bool> deterministic;
+
+    // one per worker, then one shared by every thread that isn't a worker
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex sleep_mutex;
+    std::condition_variable sleep_condition;
+    std::atomic<std::size_t> queued_count{0};
+    std::atomic<std::size_t> steal_count{0};
+    bool stopping;
+
+    std::deque<Task> tasks; // a deque so that tasks don't move while they run
+};
+
+#endif // WORK_STEALING_SCHEDULER_HPP
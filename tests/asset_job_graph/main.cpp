@@ -0,0 +1,187 @@
+#include "utility/asset_job_graph/asset_job_graph.hpp"
+
+#include "test_check.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * every test runs with no workers, where the thread that calls run does everything, and with a few workers. the jobs
+ * record what they see into atomics and the checks happen after run returns, a failed check inside a job would just
+ * turn into the graph's exception
+ */
+
+namespace {
+
+const std::vector<unsigned int> worker_counts = {0, 1, 4};
+
+void test_jobs_start_after_their_dependencies() {
+    for (unsigned int num_workers : worker_counts) {
+        std::string name = std::to_string(num_workers) + " workers";
+        std::mt19937 rng(num_workers);
+        const std::size_t num_jobs = 200;
+        std::vector<std::atomic<bool>> finished(num_jobs);
+        std::vector<std::atomic<int>> run_counts(num_jobs);
+        std::atomic<int> early_starts{0};
+
+        AssetJobGraph asset_job_graph(num_workers);
+        for (std::size_t job = 0; job < num_jobs; job++) {
+            // up to three earlier jobs, so there are chains, diamonds and jobs that depend on nothing
+            std::vector<AssetJobGraph::JobId> dependencies;
+            for (unsigned int i = 0, num_dependencies = job == 0 ? 0 : rng() % 4; i < num_dependencies; i++) {
+                dependencies.push_back(rng() % job);
+            }
+            AssetJobThread thread = job % 5 == 0 ? AssetJobThread::CONTEXT_THREAD : AssetJobThread::WORKER;
+            AssetJobGraph::JobId job_id = asset_job_graph.add_job(
+                "job " + std::to_string(job),
+                [&, job, dependencies] {
+                    for (AssetJobGraph::JobId dependency : dependencies) {
+                        if (not finished[dependency]) {
+                            early_starts++;
+                        }
+                    }
+                    run_counts[job]++;
+                    finished[job] = true;
+                },
+                dependencies, thread);
+            check(job_id == job, name + ": job ids aren't handed out in order");
+        }
+        asset_job_graph.run();
+
+        check(early_starts == 0, name + ": a job started before one of its dependencies finished");
+        for (std::size_t job = 0; job < num_jobs; job++) {
+            check(run_counts[job] == 1, name + ": job " + std::to_string(job) + " didn't run exactly once");
+        }
+        check_throws([&] { asset_job_graph.run(); }, name + ": running a second time");
+        check_throws([&] { asset_job_graph.add_job("late", [] {}); }, name + ": adding a job after running");
+    }
+
+    AssetJobGraph asset_job_graph(0);
+    check_throws([&] { asset_job_graph.add_job("orphan", [] {}, {0}); }, "depending on a job that doesn't exist");
+}
+
+void test_deduplicated_jobs_return_the_first_id() {
+    for (unsigned int num_workers : worker_counts) {
+        std::string name = std::to_string(num_workers) + " workers";
+        std::atomic<int> first_runs{0}, duplicate_runs{0}, dependent_runs{0};
+
+        AssetJobGraph asset_job_graph(num_workers);
+        AssetJobGraph::JobId unrelated_job = asset_job_graph.add_job("unrelated", [] {});
+        AssetJobGraph::JobId first_job =
+            asset_job_graph.add_deduplicated_job("flame.png", "first", [&] { first_runs++; });
+        AssetJobGraph::JobId duplicate_job =
+            asset_job_graph.add_deduplicated_job("flame.png", "duplicate", [&] { duplicate_runs++; }, {unrelated_job});
+        AssetJobGraph::JobId other_job = asset_job_graph.add_deduplicated_job("smoke.png", "other", [] {});
+        asset_job_graph.add_job("dependent", [&] { dependent_runs += first_runs.load(); }, {duplicate_job});
+
+        check(duplicate_job == first_job, name + ": the duplicate didn't get the first job's id");
+        check(other_job != first_job, name + ": a different dedupe key got the same id");
+        check(asset_job_graph.get_job_count() == 4, name + ": the duplicate was added as a job");
+        check(asset_job_graph.get_deduplicated_count() == 1, name + ": the duplicate wasn't counted");
+
+        asset_job_graph.run();
+        check(first_runs == 1 and duplicate_runs == 0, name + ": the duplicate's work ran");
+        check(dependent_runs == 1, name + ": a job depending on the duplicate didn't wait for the first job");
+    }
+}
+
+void test_context_thread_jobs_run_on_the_thread_that_calls_run() {
+    for (unsigned int num_workers : worker_counts) {
+        std::string name = std::to_string(num_workers) + " workers";
+        std::atomic<int> context_thread_jobs_elsewhere{0}, context_thread_jobs_run{0};
+        std::thread::id context_thread_id;
+
+        AssetJobGraph asset_job_graph(num_workers);
+        std::vector<AssetJobGraph::JobId> previous_jobs;
+        for (int job = 0; job < 60; job++) {
+            // alternating chains of worker and context thread jobs, the way a decode feeds an upload
+            bool on_context_thread = job % 2 == 0;
+            std::vector<AssetJobGraph::JobId> dependencies;
+            if (job >= 4) {
+                dependencies = {previous_jobs[job - 1], previous_jobs[job - 4]};
+            }
+            previous_jobs.push_back(asset_job_graph.add_job(
+                "job " + std::to_string(job),
+                [&, on_context_thread] {
+                    if (on_context_thread) {
+                        context_thread_jobs_run++;
+                        if (std::this_thread::get_id() != context_thread_id) {
+                            context_thread_jobs_elsewhere++;
+                        }
+                    } else {
+                        std::this_thread::sleep_for(std::chrono::microseconds(100));
+                    }
+                },
+                dependencies, on_context_thread ? AssetJobThread::CONTEXT_THREAD : AssetJobThread::WORKER));
+        }
+
+        // run from a thread other than main, so the check doesn't pass just because everything ran on main
+        std::thread context_thread([&] {
+            context_thread_id = std::this_thread::get_id();
+            asset_job_graph.run();
+        });
+        context_thread.join();
+
+        check(context_thread_jobs_run == 30, name + ": not every context thread job ran");
+        check(context_thread_jobs_elsewhere == 0, name + ": a context thread job ran on a worker");
+    }
+}
+
+void test_first_exception_is_rethrown_without_starting_dependents() {
+    for (unsigned int num_workers : worker_counts) {
+        std::string name = std::to_string(num_workers) + " workers";
+        std::atomic<bool> later_has_started{false}, first_has_thrown{false};
+        std::atomic<int> dependent_runs{0};
+
+        AssetJobGraph asset_job_graph(num_workers);
+        AssetJobGraph::JobId failing_job = asset_job_graph.add_job("failing", [&, num_workers] {
+            // with no workers the later one never gets to start
+            while (num_workers > 0 and not later_has_started) {
+                std::this_thread::yield();
+            }
+            first_has_thrown = true;
+            throw std::runtime_error("first");
+        });
+        // already running on another thread when the first one throws, its exception comes second
+        AssetJobGraph::JobId later_failing_job = asset_job_graph.add_job("later failing", [&] {
+            later_has_started = true;
+            while (not first_has_thrown) {
+                std::this_thread::yield();
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            throw std::runtime_error("second");
+        });
+        AssetJobGraph::JobId dependent_job =
+            asset_job_graph.add_job("dependent", [&] { dependent_runs++; }, {failing_job});
+        asset_job_graph.add_job("dependent of dependent", [&] { dependent_runs++; }, {dependent_job});
+        asset_job_graph.add_job("dependent on context thread", [&] { dependent_runs++; }, {later_failing_job},
+                                AssetJobThread::CONTEXT_THREAD);
+
+        std::string rethrown_message;
+        try {
+            asset_job_graph.run();
+        } catch (const std::runtime_error &e) {
+            rethrown_message = e.what();
+        }
+        check(rethrown_message == "first", name + ": run didn't rethrow the first exception");
+        check(dependent_runs == 0, name + ": a dependent of a failed job started");
+    }
+}
+
+} // namespace
+
+int main() {
+    return run_tests({
+        {"jobs start after their dependencies", test_jobs_start_after_their_dependencies},
+        {"deduplicated jobs return the first id", test_deduplicated_jobs_return_the_first_id},
+        {"context thread jobs run on the thread that calls run",
+         test_context_thread_jobs_run_on_the_thread_that_calls_run},
+        {"first exception is rethrown without starting dependents",
+         test_first_exception_is_rethrown_without_starting_dependents},
+    });
+}
@@ -0,0 +1,226 @@
+#include "utility/baked_rigged_model/baked_rigged_model.hpp"
+
+#include "test_check.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * a bake has to load back into the same meshes, bones and poses it was baked from, poses in between samples have to be
+ * the blend of the samples around them, and a bake from other sources or a damaged file must not be used
+ */
+
+namespace {
+
+const double DURATION_SEC = 1.5;
+const double SAMPLES_PER_SEC = 30.0;
+const std::uint64_t SOURCE_HASH = 0x1234abcd5678ef90ull;
+
+std::string get_temporary_path(const std::string &name) {
+    return (std::filesystem::temp_directory_path() / ("baked_rigged_model_test_" + name + ".baked_rigged_model"))
+        .string();
+}
+
+std::vector<BakedRiggedMeshSource> make_meshes() {
+    std::vector<BakedRiggedMeshSource> meshes;
+    for (int mesh_index = 0; mesh_index < 3; mesh_index++) {
+        BakedRiggedMeshSource &mesh = meshes.emplace_back();
+        mesh.packed_texture_index = mesh_index - 1;
+        // one of the meshes is empty, and the arrays are sizes that leave padding before the next one
+        int num_vertices = mesh_index == 1 ? 0 : 7 + mesh_index * 5;
+        for (int vertex = 0; vertex < num_vertices; vertex++) {
+            float x = vertex + mesh_index * 100.0f;
+            mesh.xyz_positions.emplace_back(x, x * 0.5f, -x);
+            mesh.normals.emplace_back(0.0f, x / 1000.0f, 1.0f);
+            mesh.packed_texture_coordinates.emplace_back(x / 64.0f, 1.0f - x / 64.0f);
+            mesh.bone_ids.emplace_back(vertex % 3, (vertex + 1) % 3, 0, -1);
+            mesh.bone_weights.emplace_back(0.5f, 0.25f, 0.25f, 0.0f);
+        }
+        for (unsigned int index = 0; index + 2 < static_cast<unsigned int>(num_vertices); index++) {
+            mesh.indices.insert(mesh.indices.end(), {index, index + 1, index + 2});
+        }
+    }
+    return meshes;
+}
+
+const std::vector<std::string> bone_names = {"root", "upper_arm.L", "hand.L"};
+
+std::vector<glm::mat4> make_bind_pose_transforms() {
+    std::vector<glm::mat4> bind_pose_transforms;
+    for (std::size_t bone_index = 0; bone_index < bone_names.size(); bone_index++) {
+        bind_pose_transforms.push_back(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -float(bone_index), 0.0f)));
+    }
+    return bind_pose_transforms;
+}
+
+/**
+ * a palette bigger than the bone count like the collector's, every bone turns and moves at its own speed
+ */
+void evaluate_source_pose(double time_sec, AnimationPose &pose) {
+    const std::size_t bone_palette_size = 5;
+    pose.bone_palette.clear();
+    for (std::size_t i = 0; i < bone_palette_size; i++) {
+        glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(time_sec * i, 0.0f, 1.0f));
+        pose.bone_palette.push_back(glm::rotate(transform, float(time_sec * (i + 1)), glm::vec3(0.0f, 0.0f, 1.0f)));
+    }
+    pose.animated_transforms_upto_bone.clear();
+    for (std::size_t bone_index = 0; bone_index < bone_names.size(); bone_index++) {
+        pose.animated_transforms_upto_bone.push_back(
+            glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, float(bone_index), time_sec)));
+    }
+}
+
+void bake(const std::string &file_path, const std::vector<BakedRiggedMeshSource> &meshes) {
+    bake_rigged_model(file_path, SOURCE_HASH, meshes, bone_names, make_bind_pose_transforms(), evaluate_source_pose,
+                      DURATION_SEC, SAMPLES_PER_SEC);
+}
+
+float get_max_difference(const std::vector<glm::mat4> &a, const std::vector<glm::mat4> &b) {
+    check(a.size() == b.size(), "the poses have different sizes");
+    float max_difference = 0.0f;
+    for (std::size_t i = 0; i < a.size(); i++) {
+        for (int column = 0; column < 4; column++) {
+            for (int row = 0; row < 4; row++) {
+                max_difference = std::max(max_difference, std::abs(a[i][column][row] - b[i][column][row]));
+            }
+        }
+    }
+    return max_difference;
+}
+
+template <typename T> bool same_elements(std::span<const T> baked, const std::vector<T> &source) {
+    return std::equal(baked.begin(), baked.end(), source.begin(), source.end());
+}
+
+void test_bake_loads_back_the_same_meshes_and_bones() {
+    std::string file_path = get_temporary_path("round_trip");
+    std::vector<BakedRiggedMeshSource> meshes = make_meshes();
+    bake(file_path, meshes);
+    BakedRiggedModel baked_rigged_model(file_path);
+
+    check(baked_rigged_model.get_source_hash() == SOURCE_HASH, "the source hash didn't survive the bake");
+    check(baked_rigged_model.get_mesh_count() == meshes.size(), "the mesh count changed");
+    for (std::size_t mesh_index = 0; mesh_index < meshes.size(); mesh_index++) {
+        const BakedRiggedMeshSource &mesh = meshes[mesh_index];
+        BakedRiggedMeshView baked_mesh = baked_rigged_model.get_mesh(mesh_index);
+        std::string name = "mesh " + std::to_string(mesh_index);
+        check(baked_mesh.packed_texture_index == mesh.packed_texture_index, name + " has another packed texture");
+        check(same_elements(baked_mesh.indices, mesh.indices), name + " has other indices");
+        check(same_elements(baked_mesh.xyz_positions, mesh.xyz_positions), name + " has other positions");
+        check(same_elements(baked_mesh.normals, mesh.normals), name + " has other normals");
+        check(same_elements(baked_mesh.packed_texture_coordinates, mesh.packed_texture_coordinates),
+              name + " has other texture coordinates");
+        check(same_elements(baked_mesh.bone_ids, mesh.bone_ids), name + " has other bone ids");
+        check(same_elements(baked_mesh.bone_weights, mesh.bone_weights), name + " has other bone weights");
+    }
+
+    check(baked_rigged_model.get_bone_count() == bone_names.size(), "the bone count changed");
+    for (std::size_t bone_index = 0; bone_index < bone_names.size(); bone_index++) {
+        auto it = baked_rigged_model.get_bone_name_to_index().find(bone_names[bone_index]);
+        check(it != baked_rigged_model.get_bone_name_to_index().end() and it->second == bone_index,
+              "the bone " + bone_names[bone_index] + " lost its index");
+    }
+    check(same_elements(baked_rigged_model.get_bind_pose_transforms(), make_bind_pose_transforms()),
+          "the bind poses changed");
+}
+
+void test_bake_loads_back_the_same_poses() {
+    std::string file_path = get_temporary_path("poses");
+    bake(file_path, make_meshes());
+    BakedRiggedModel baked_rigged_model(file_path);
+
+    check(baked_rigged_model.get_samples_per_sec() == SAMPLES_PER_SEC, "the sample rate changed");
+    check(std::abs(baked_rigged_model.get_duration_sec() - DURATION_SEC) < 1e-9, "the duration changed");
+
+    // at the sample times the baked pose is the one the source evaluated, up to rounding the time back to a sample
+    AnimationPose baked_pose, source_pose;
+    int num_samples = static_cast<int>(std::round(DURATION_SEC * SAMPLES_PER_SEC)) + 1;
+    for (int sample = 0; sample < num_samples; sample++) {
+        double time_sec = sample / SAMPLES_PER_SEC;
+        baked_rigged_model.evaluate_pose(time_sec, baked_pose);
+        evaluate_source_pose(time_sec, source_pose);
+        std::string name = "sample " + std::to_string(sample);
+        check(get_max_difference(baked_pose.bone_palette, source_pose.bone_palette) < 1e-4f,
+              name + " has another bone palette");
+        check(get_max_difference(baked_pose.animated_transforms_upto_bone, source_pose.animated_transforms_upto_bone) <
+                  1e-4f,
+              name + " has other bone transforms");
+    }
+
+    // outside of the baked time the first and last pose hold
+    AnimationPose first_pose, last_pose;
+    evaluate_source_pose(0.0, first_pose);
+    evaluate_source_pose(DURATION_SEC, last_pose);
+    baked_rigged_model.evaluate_pose(-1.0, baked_pose);
+    check(get_max_difference(baked_pose.bone_palette, first_pose.bone_palette) < 1e-4f, "before the start isn't held");
+    baked_rigged_model.evaluate_pose(DURATION_SEC + 1.0, baked_pose);
+    check(get_max_difference(baked_pose.bone_palette, last_pose.bone_palette) < 1e-4f, "after the end isn't held");
+}
+
+void test_poses_between_samples_are_blended() {
+    std::string file_path = get_temporary_path("blend");
+    bake(file_path, make_meshes());
+    BakedRiggedModel baked_rigged_model(file_path);
+
+    AnimationPose before, after, baked_pose;
+    for (int sample = 0; sample + 1 < DURATION_SEC * SAMPLES_PER_SEC; sample++) {
+        evaluate_source_pose(sample / SAMPLES_PER_SEC, before);
+        evaluate_source_pose((sample + 1) / SAMPLES_PER_SEC, after);
+        for (float fraction : {0.25f, 0.5f, 0.75f}) {
+            baked_rigged_model.evaluate_pose((sample + fraction) / SAMPLES_PER_SEC, baked_pose);
+
+            std::vector<glm::mat4> blended_palette, blended_transforms;
+            for (std::size_t i = 0; i < before.bone_palette.size(); i++) {
+                blended_palette.push_back(before.bone_palette[i] * (1.0f - fraction) +
+                                          after.bone_palette[i] * fraction);
+            }
+            for (std::size_t i = 0; i < before.animated_transforms_upto_bone.size(); i++) {
+                blended_transforms.push_back(before.animated_transforms_upto_bone[i] * (1.0f - fraction) +
+                                             after.animated_transforms_upto_bone[i] * fraction);
+            }
+            std::string name = "sample " + std::to_string(sample) + " + " + std::to_string(fraction);
+            check(get_max_difference(baked_pose.bone_palette, blended_palette) < 1e-4f,
+                  name + " isn't the blend of the samples around it");
+            check(get_max_difference(baked_pose.animated_transforms_upto_bone, blended_transforms) < 1e-4f,
+                  name + " isn't the blend of the bone transforms around it");
+        }
+    }
+}
+
+void test_stale_or_damaged_bakes_are_not_used() {
+    std::string file_path = get_temporary_path("stale");
+    bake(file_path, make_meshes());
+    check(try_load_baked_rigged_model(file_path, SOURCE_HASH) != nullptr, "a matching bake wasn't used");
+    check(try_load_baked_rigged_model(file_path, SOURCE_HASH + 1) == nullptr, "a bake of other sources was used");
+    check(try_load_baked_rigged_model(get_temporary_path("missing"), SOURCE_HASH) == nullptr, "a missing bake loaded");
+
+    std::string damaged_file_path = get_temporary_path("damaged");
+    {
+        std::ofstream file(damaged_file_path, std::ios::binary | std::ios::trunc);
+        file << "not a baked rigged model, but long enough to hold a header of one when it is read as one";
+    }
+    check(try_load_baked_rigged_model(damaged_file_path, SOURCE_HASH) == nullptr, "a damaged bake was used");
+
+    std::vector<BakedRiggedMeshSource> mismatched_meshes = make_meshes();
+    mismatched_meshes[2].normals.pop_back();
+    check_throws([&] { bake(get_temporary_path("mismatched"), mismatched_meshes); },
+                 "baking a mesh with mismatched attribute counts");
+}
+
+} // namespace
+
+int main() {
+    return run_tests({
+        {"bake loads back the same meshes and bones", test_bake_loads_back_the_same_meshes_and_bones},
+        {"bake loads back the same poses", test_bake_loads_back_the_same_poses},
+        {"poses between samples are blended", test_poses_between_samples_are_blended},
+        {"stale or damaged bakes are not used", test_stale_or_damaged_bakes_are_not_used},
+    });
+}
@@ -0,0 +1,169 @@
+#include "graphics/compiled_scripted_path/compiled_scripted_path.hpp"
+
+#include "test_check.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * a compiled path has to load back into a transform that behaves exactly like the one it was compiled from, the file
+ * has to be the same bytes every time the same path is compiled, and a corrupt file has to throw on load instead of
+ * being read out of bounds later in update
+ */
+
+namespace {
+
+std::vector<ScriptedTransformKeyframe> make_keyframes(std::size_t num_keyframes) {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> step_dist(-1.0f, 1.0f);
+    std::vector<ScriptedTransformKeyframe> keyframes;
+    glm::vec3 position(0.0f);
+    for (std::size_t i = 0; i < num_keyframes; i++) {
+        position += glm::vec3(step_dist(rng), step_dist(rng), step_dist(rng));
+        keyframes.push_back({position, glm::vec3(step_dist(rng), step_dist(rng), step_dist(rng)), glm::vec3(1.0f)});
+    }
+    return keyframes;
+}
+
+ScriptedTransform make_scripted_transform() {
+    return ScriptedTransform(make_keyframes(20), 1000.0, 9000.0, 0.5, 0.5, 0.5, 0.01, true);
+}
+
+std::string get_temporary_path(const std::string &name) {
+    return (std::filesystem::temp_directory_path() / ("compiled_scripted_path_test_" + name + ".scripted_path"))
+        .string();
+}
+
+std::vector<char> read_bytes(const std::string &file_path) {
+    std::ifstream file(file_path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void write_bytes(const std::string &file_path, const std::vector<char> &bytes) {
+    std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), bytes.size());
+}
+
+CompiledScriptedPathHeader read_header(const std::vector<char> &bytes) {
+    CompiledScriptedPathHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    return header;
+}
+
+void write_header(std::vector<char> &bytes, const CompiledScriptedPathHeader &header) {
+    std::memcpy(bytes.data(), &header, sizeof(header));
+}
+
+/**
+ * compiles the transform, lets corrupt change the bytes and checks that loading them throws
+ */
+void check_corrupt_file_throws(const std::string &name, const std::function<void(std::vector<char> &)> &corrupt) {
+    std::string file_path = get_temporary_path(name);
+    write_compiled_scripted_path(file_path, make_scripted_transform());
+    std::vector<char> bytes = read_bytes(file_path);
+    corrupt(bytes);
+    write_bytes(file_path, bytes);
+    check_throws([&] { load_compiled_scripted_path(file_path); }, "loading a file with " + name);
+    std::filesystem::remove(file_path);
+}
+
+void test_round_trip() {
+    std::string file_path = get_temporary_path("round_trip");
+    ScriptedTransform scripted_transform = make_scripted_transform();
+    write_compiled_scripted_path(file_path, scripted_transform);
+    ScriptedTransform loaded_scripted_transform = load_compiled_scripted_path(file_path);
+
+    for (double ms_curr_time = 0.0; ms_curr_time < 10000.0; ms_curr_time += 16.6) {
+        scripted_transform.update(ms_curr_time);
+        loaded_scripted_transform.update(ms_curr_time);
+        check(loaded_scripted_transform.transform.position == scripted_transform.transform.position and
+                  loaded_scripted_transform.transform.rotation == scripted_transform.transform.rotation and
+                  loaded_scripted_transform.transform.scale == scripted_transform.transform.scale,
+              "loaded transform differs at " + std::to_string(ms_curr_time) + " ms");
+
+        glm::mat4 transform_matrix, loaded_transform_matrix;
+        scripted_transform.update(ms_curr_time, transform_matrix);
+        loaded_scripted_transform.update(ms_curr_time, loaded_transform_matrix);
+        check(loaded_transform_matrix == transform_matrix,
+              "loaded quaternion matrix differs at " + std::to_string(ms_curr_time) + " ms");
+    }
+    std::filesystem::remove(file_path);
+}
+
+void test_compiling_is_reproducible() {
+    std::string first_file_path = get_temporary_path("first");
+    std::string second_file_path = get_temporary_path("second");
+    // garbage on the heap where the second transform's arrays will go, so that uninitialized bytes would differ
+    {
+        std::vector<unsigned char> garbage(1 << 20, 0xab);
+        write_compiled_scripted_path(first_file_path, make_scripted_transform());
+    }
+    write_compiled_scripted_path(second_file_path, make_scripted_transform());
+
+    std::vector<char> bytes = read_bytes(first_file_path);
+    check(bytes == read_bytes(second_file_path), "compiling the same path twice gave different files");
+
+    CompiledScriptedPathHeader header = read_header(bytes);
+    for (std::size_t i = 0; i < header.arc_length_sample_count; i++) {
+        ArcLengthSample sample;
+        std::memcpy(&sample, bytes.data() + header.arc_length_samples_offset + i * sizeof(ArcLengthSample),
+                    sizeof(sample));
+        check(sample.padding == 0, "arc length sample " + std::to_string(i) + " has non zero padding");
+    }
+    std::filesystem::remove(first_file_path);
+    std::filesystem::remove(second_file_path);
+}
+
+void test_corrupt_files_throw() {
+    check_corrupt_file_throws("a truncated header", [](std::vector<char> &bytes) { bytes.resize(10); });
+    check_corrupt_file_throws("truncated arrays", [](std::vector<char> &bytes) { bytes.resize(bytes.size() - 8); });
+    check_corrupt_file_throws("a wrong magic", [](std::vector<char> &bytes) { bytes[0] = 'X'; });
+    check_corrupt_file_throws("too few keyframes", [](std::vector<char> &bytes) {
+        CompiledScriptedPathHeader header = read_header(bytes);
+        header.keyframe_count = 3;
+        header.segment_count = 0;
+        write_header(bytes, header);
+    });
+    check_corrupt_file_throws("a segment count that doesn't match the keyframes", [](std::vector<char> &bytes) {
+        CompiledScriptedPathHeader header = read_header(bytes);
+        header.segment_count -= 1;
+        write_header(bytes, header);
+    });
+    check_corrupt_file_throws("no arc length samples", [](std::vector<char> &bytes) {
+        CompiledScriptedPathHeader header = read_header(bytes);
+        header.arc_length_sample_count = 0;
+        write_header(bytes, header);
+    });
+    check_corrupt_file_throws("a sample on a segment that doesn't exist", [](std::vector<char> &bytes) {
+        CompiledScriptedPathHeader header = read_header(bytes);
+        std::size_t last_sample_offset =
+            header.arc_length_samples_offset + (header.arc_length_sample_count - 1) * sizeof(ArcLengthSample);
+        unsigned int segment_index = header.segment_count;
+        std::memcpy(bytes.data() + last_sample_offset + offsetof(ArcLengthSample, segment_index), &segment_index,
+                    sizeof(segment_index));
+    });
+    check_corrupt_file_throws("unsorted arc length samples", [](std::vector<char> &bytes) {
+        CompiledScriptedPathHeader header = read_header(bytes);
+        double arc_length = -1.0;
+        std::memcpy(bytes.data() + header.arc_length_samples_offset + sizeof(ArcLengthSample) +
+                        offsetof(ArcLengthSample, arc_length),
+                    &arc_length, sizeof(arc_length));
+    });
+}
+
+} // namespace
+
+int main() {
+    return run_tests({
+        {"round trip", test_round_trip},
+        {"compiling is reproducible", test_compiling_is_reproducible},
+        {"corrupt files throw", test_corrupt_files_throw},
+    });
+}
@@ -0,0 +1,197 @@
+#include "utility/frame_packet_pipeline/frame_packet_pipeline.hpp"
+
+#include "test_check.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+/**
+ * the pipeline is driven the way main drives it, the test thread plays the gl thread. simulate and the render side
+ * both take their time over a packet so that sharing one would be caught
+ */
+
+namespace {
+
+struct TestPacket {
+    int frame = -1;
+    std::array<int, 64> simulated_values{};
+};
+
+void fill(TestPacket &packet) {
+    for (int &value : packet.simulated_values) {
+        value = packet.frame;
+        std::this_thread::yield();
+    }
+}
+
+bool is_filled_with(const TestPacket &packet, int frame) {
+    for (int value : packet.simulated_values) {
+        if (value != frame) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void test_rendering_stays_one_frame_behind() {
+    FramePacketPipeline<TestPacket> pipeline(fill);
+    check_throws([&] { pipeline.acquire_packet_to_render(); }, "acquiring before anything was simulated");
+    check_throws([&] { pipeline.release_rendered_packet(); }, "releasing before anything was acquired");
+
+    int next_frame = 0;
+    auto prepare = [&](TestPacket &packet) { packet.frame = next_frame++; };
+    pipeline.begin_simulation(prepare);
+    for (int frame = 0; frame < 200; frame++) {
+        pipeline.begin_simulation(prepare);
+        const TestPacket &packet = pipeline.acquire_packet_to_render();
+        check(packet.frame == frame, "frame " + std::to_string(frame) + " rendered the packet of frame " +
+                                         std::to_string(packet.frame));
+        check(next_frame == frame + 2, "the simulation isn't exactly one frame ahead of rendering");
+        check(is_filled_with(packet, frame), "frame " + std::to_string(frame) + " rendered before it was simulated");
+        check_throws([&] { pipeline.acquire_packet_to_render(); }, "acquiring twice without releasing");
+
+        // with both packets in use the simulation can't start another frame until this one is released
+        if (frame % 50 == 0) {
+            std::atomic<bool> began{false};
+            std::thread simulation_thread([&] {
+                pipeline.begin_simulation(prepare);
+                began = true;
+            });
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            bool began_before_release = began;
+            pipeline.release_rendered_packet();
+            simulation_thread.join();
+            check(not began_before_release, "a third frame began simulating while the other two packets were in use");
+            check(began, "releasing a packet didn't let the next frame begin");
+
+            // the extra frame is rendered right away to get back to one frame ahead
+            frame++;
+            pipeline.acquire_packet_to_render();
+        }
+        pipeline.release_rendered_packet();
+    }
+    pipeline.stop();
+}
+
+void test_packets_are_only_reused_after_release() {
+    std::atomic<const TestPacket *> rendering_packet{nullptr};
+    std::atomic<int> simulated_while_rendered{0};
+    FramePacketPipeline<TestPacket> pipeline([&](TestPacket &packet) {
+        if (&packet == rendering_packet.load()) {
+            simulated_while_rendered++;
+        }
+        fill(packet);
+    });
+
+    int next_frame = 0;
+    auto prepare = [&](TestPacket &packet) {
+        if (&packet == rendering_packet.load()) {
+            simulated_while_rendered++;
+        }
+        packet.frame = next_frame++;
+    };
+    pipeline.begin_simulation(prepare);
+    for (int frame = 0; frame < 500; frame++) {
+        pipeline.begin_simulation(prepare);
+        const TestPacket &packet = pipeline.acquire_packet_to_render();
+        rendering_packet = &packet;
+
+        // the render side reads the packet slowly, a simulation writing into it meanwhile would change what is read
+        bool consistent = true;
+        for (int pass = 0; pass < 4; pass++) {
+            consistent = consistent and is_filled_with(packet, frame);
+            std::this_thread::yield();
+        }
+        check(consistent, "frame " + std::to_string(frame) + "'s packet changed while it was being rendered");
+
+        rendering_packet = nullptr;
+        pipeline.release_rendered_packet();
+    }
+    pipeline.stop();
+    check(simulated_while_rendered == 0, "a packet was prepared or simulated while it was being rendered");
+}
+
+void test_simulation_exception_is_rethrown_on_acquire() {
+    const int failing_frame = 3;
+    FramePacketPipeline<TestPacket> pipeline([&](TestPacket &packet) {
+        if (packet.frame == failing_frame) {
+            throw std::runtime_error("simulation failed");
+        }
+        fill(packet);
+    });
+
+    int next_frame = 0;
+    auto prepare = [&](TestPacket &packet) { packet.frame = next_frame++; };
+    pipeline.begin_simulation(prepare);
+    for (int frame = 0; frame < failing_frame; frame++) {
+        pipeline.begin_simulation(prepare);
+        check(pipeline.acquire_packet_to_render().frame == frame, "a frame before the failure didn't render");
+        pipeline.release_rendered_packet();
+    }
+
+    pipeline.begin_simulation(prepare);
+    std::string rethrown_message;
+    try {
+        pipeline.acquire_packet_to_render();
+    } catch (const std::runtime_error &e) {
+        rethrown_message = e.what();
+    }
+    check(rethrown_message == "simulation failed", "acquiring the failed frame didn't rethrow its exception");
+    check_throws([&] { pipeline.acquire_packet_to_render(); }, "acquiring the failed frame again");
+
+    // the frame after the failure was already submitted, it is never simulated and stop still returns
+    pipeline.stop();
+}
+
+void test_stop_with_a_packet_in_flight() {
+    std::atomic<int> simulations_started{0}, simulations_finished{0};
+    {
+        FramePacketPipeline<TestPacket> pipeline([&](TestPacket &packet) {
+            simulations_started++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(30));
+            fill(packet);
+            simulations_finished++;
+        });
+
+        pipeline.begin_simulation([](TestPacket &packet) { packet.frame = 0; });
+        pipeline.begin_simulation([](TestPacket &packet) { packet.frame = 1; });
+        // let the worker get into the first packet
+        while (simulations_started == 0) {
+            std::this_thread::yield();
+        }
+        pipeline.stop();
+
+        check(simulations_started == simulations_finished, "stop returned while a simulation was still running");
+        check(simulations_finished <= 2, "more packets were simulated than were submitted");
+        check_throws([&] { pipeline.begin_simulation([](TestPacket &packet) {}); }, "beginning after stop");
+
+        // stopping again and the destructor after stop both just return
+        pipeline.stop();
+    }
+
+    // a pipeline that is destroyed mid frame stops itself
+    {
+        FramePacketPipeline<TestPacket> pipeline([&](TestPacket &packet) {
+            simulations_started++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(30));
+            simulations_finished++;
+        });
+        pipeline.begin_simulation([](TestPacket &packet) {});
+    }
+    check(simulations_started == simulations_finished, "the destructor didn't wait for the running simulation");
+}
+
+} // namespace
+
+int main() {
+    return run_tests({
+        {"rendering stays one frame behind", test_rendering_stays_one_frame_behind},
+        {"packets are only reused after release", test_packets_are_only_reused_after_release},
+        {"simulation exception is rethrown on acquire", test_simulation_exception_is_rethrown_on_acquire},
+        {"stop with a packet in flight", test_stop_with_a_packet_in_flight},
+    });
+}
@@ -0,0 +1,119 @@
+#include "utility/frame_profiler/frame_profiler.hpp"
+
+#include "test_check.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * the ring is hammered by one writer while another thread drains it, sometimes slowly enough that the writer laps it.
+ * every event the writer pushes is derived from its sequence number, so a drained event that was torn by the writer
+ * overwriting its slot mid copy shows up as fields that don't agree with each other
+ */
+
+namespace {
+
+const char *const event_names[] = {"particles", "bones", "upload", "draw", "swap"};
+const std::uint64_t num_event_names = std::size(event_names);
+
+FrameProfilerEvent make_event(std::uint64_t sequence_number) {
+    return {event_names[sequence_number % num_event_names], static_cast<std::int64_t>(sequence_number),
+            static_cast<std::int64_t>(sequence_number * 3 + 1),
+            sequence_number % 2 == 0 ? FrameProfilerEventType::ZONE : FrameProfilerEventType::COUNTER, 0};
+}
+
+bool is_consistent(const FrameProfilerEvent &event, unsigned int thread_index) {
+    std::uint64_t sequence_number = event.start_ns;
+    FrameProfilerEvent expected_event = make_event(sequence_number);
+    return event.start_ns >= 0 and event.name == expected_event.name and
+           event.duration_ns_or_value == expected_event.duration_ns_or_value and event.type == expected_event.type and
+           event.thread_index == thread_index;
+}
+
+void test_drain_only_returns_whole_events_while_being_written() {
+    const unsigned int thread_index = 7;
+    const std::uint64_t num_events = 20'000'000;
+    FrameProfilerThreadRing ring(thread_index);
+    std::atomic<bool> writer_done{false};
+
+    std::thread writer([&] {
+        for (std::uint64_t sequence_number = 0; sequence_number < num_events; sequence_number++) {
+            ring.push(make_event(sequence_number));
+        }
+        writer_done = true;
+    });
+
+    std::vector<FrameProfilerEvent> drained_events;
+    std::size_t drained_count = 0, lost_count = 0, inconsistent_count = 0, out_of_order_count = 0, drain_count = 0;
+    std::int64_t last_sequence_number = -1;
+    bool last_drain = false;
+    while (not last_drain) {
+        // the final drain after the writer finished picks up whatever is left
+        last_drain = writer_done;
+        drained_events.clear();
+        lost_count += ring.drain(drained_events);
+        drain_count++;
+
+        for (const FrameProfilerEvent &event : drained_events) {
+            if (not is_consistent(event, thread_index)) {
+                inconsistent_count++;
+            } else if (event.start_ns <= last_sequence_number) {
+                out_of_order_count++;
+            } else {
+                last_sequence_number = event.start_ns;
+            }
+        }
+        drained_count += drained_events.size();
+
+        // every few drains the reader falls behind by more than a ring so the writer laps it mid copy
+        if (drain_count % 8 == 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+    writer.join();
+
+    check(inconsistent_count == 0, std::to_string(inconsistent_count) + " drained events were torn");
+    check(out_of_order_count == 0, std::to_string(out_of_order_count) + " drained events came out of order");
+    check(drained_count + lost_count == num_events, "drained and lost events don't add up to what was written");
+    check(lost_count > 0, "the writer never lapped the reader, the test didn't test overruns");
+    check(drained_count > 0, "nothing was drained");
+}
+
+void test_drain_returns_everything_short_of_a_full_ring() {
+    const std::size_t capacity = FrameProfilerThreadRing::CAPACITY;
+    FrameProfilerThreadRing ring(0);
+    std::vector<FrameProfilerEvent> drained_events;
+    for (std::uint64_t sequence_number = 0; sequence_number < capacity - 1; sequence_number++) {
+        ring.push(make_event(sequence_number));
+    }
+    check(ring.drain(drained_events) == 0, "a ring one short of full lost events");
+    check(drained_events.size() == capacity - 1, "a ring one short of full didn't drain completely");
+    for (std::uint64_t sequence_number = 0; sequence_number < drained_events.size(); sequence_number++) {
+        check(drained_events[sequence_number].start_ns == static_cast<std::int64_t>(sequence_number) and
+                  is_consistent(drained_events[sequence_number], 0),
+              "the ring drained other events than were pushed");
+    }
+
+    // once the ring is full the oldest slot is the one the next push writes to, so it counts as lost
+    drained_events.clear();
+    for (std::uint64_t sequence_number = 0; sequence_number < capacity + 10; sequence_number++) {
+        ring.push(make_event(sequence_number));
+    }
+    check(ring.drain(drained_events) == 11, "lapping the ring didn't lose the lapped events and the next slot");
+    check(drained_events.size() == capacity - 1 and drained_events.front().start_ns == 11,
+          "lapping the ring didn't keep the newest events");
+}
+
+} // namespace
+
+int main() {
+    return run_tests({
+        {"drain only returns whole events while being written",
+         test_drain_only_returns_whole_events_while_being_written},
+        {"drain returns everything short of a full ring", test_drain_returns_everything_short_of_a_full_ring},
+    });
+}
@@ -0,0 +1,151 @@
+#include "graphics/light_uniform_manager/light_uniform_manager.hpp"
+
+#include "test_check.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * the manager runs against a recording stub instead of gl, so the tests see exactly which uniforms would be sent. the
+ * locations have to be looked up once, an upload without changes has to make no calls at all, and changing one light
+ * has to send only that light
+ */
+
+namespace {
+
+struct RecordedUniform {
+    GLint location;
+    std::vector<float> value;
+};
+
+struct RecordingGL {
+    std::map<std::string, GLint> name_to_location;
+    std::map<GLint, std::string> location_to_name;
+    std::map<std::string, int> lookup_counts;
+    int use_program_calls = 0;
+    std::vector<RecordedUniform> uniforms;
+
+    int get_num_calls() const { return use_program_calls + static_cast<int>(uniforms.size()); }
+
+    void clear_calls() {
+        use_program_calls = 0;
+        uniforms.clear();
+    }
+
+    const std::string &get_name(GLint location) const { return location_to_name.at(location); }
+
+    LightUniformGLFunctions get_functions() {
+        return {
+            [this](GLuint shader_program_id, const std::string &uniform_name) {
+                lookup_counts[uniform_name]++;
+                auto it = name_to_location.find(uniform_name);
+                if (it != name_to_location.end()) {
+                    return it->second;
+                }
+                GLint location = static_cast<GLint>(name_to_location.size());
+                name_to_location[uniform_name] = location;
+                location_to_name[location] = uniform_name;
+                return location;
+            },
+            [this](GLuint shader_program_id) { use_program_calls++; },
+            [this](GLint location, const glm::vec3 &value) {
+                uniforms.push_back({location, {value.x, value.y, value.z}});
+            },
+            [this](GLint location, float value) { uniforms.push_back({location, {value}}); },
+        };
+    }
+};
+
+PointLightAttributes make_point_light(float position) {
+    return {glm::vec3(position, 1, 2), glm::vec3(0.1f), glm::vec3(0.5f), glm::vec3(0.9f), 1.0f, 0.2f, 0.3f};
+}
+
+void test_locations_are_resolved_once() {
+    RecordingGL recording_gl;
+    LightUniformManager light_uniform_manager(1, 4, recording_gl.get_functions());
+
+    // view_pos, the 4 directional light fields, 7 per point light and the 10 spot light fields
+    check(recording_gl.lookup_counts.size() == 1 + 4 + 4 * 7 + 10, "the wrong number of uniforms was looked up");
+    for (const auto &[uniform_name, lookup_count] : recording_gl.lookup_counts) {
+        check(lookup_count == 1, uniform_name + " was looked up more than once");
+    }
+    check(recording_gl.lookup_counts.count("point_lights[3].quadratic") == 1, "the last point light wasn't resolved");
+
+    for (int frame = 0; frame < 10; frame++) {
+        light_uniform_manager.set_view_position(glm::vec3(frame));
+        light_uniform_manager.set_point_light(frame % 4, make_point_light(frame));
+        light_uniform_manager.upload();
+    }
+    for (const auto &[uniform_name, lookup_count] : recording_gl.lookup_counts) {
+        check(lookup_count == 1, uniform_name + " was looked up again after construction");
+    }
+}
+
+void test_upload_without_changes_makes_no_calls() {
+    RecordingGL recording_gl;
+    LightUniformManager light_uniform_manager(1, 4, recording_gl.get_functions());
+
+    // the first upload sends the defaults of everything
+    check(light_uniform_manager.has_changes(), "a new manager has nothing to send");
+    light_uniform_manager.upload();
+    check(recording_gl.use_program_calls == 1, "the first upload didn't bind the program once");
+    check(recording_gl.uniforms.size() == recording_gl.lookup_counts.size(), "the first upload didn't send everything");
+
+    recording_gl.clear_calls();
+    light_uniform_manager.upload();
+    check(recording_gl.get_num_calls() == 0, "an upload without changes made gl calls");
+
+    // setting what is already there isn't a change
+    light_uniform_manager.set_view_position(glm::vec3(0));
+    light_uniform_manager.set_directional_light(DirectionalLightAttributes{});
+    light_uniform_manager.set_point_light(2, PointLightAttributes{});
+    light_uniform_manager.set_spot_light(SpotLightAttributes{});
+    check(not light_uniform_manager.has_changes(), "setting the current values counted as a change");
+    light_uniform_manager.upload();
+    check(recording_gl.get_num_calls() == 0, "an upload after setting the current values made gl calls");
+}
+
+void test_only_the_changed_point_light_is_sent() {
+    RecordingGL recording_gl;
+    LightUniformManager light_uniform_manager(1, 4, recording_gl.get_functions());
+    light_uniform_manager.upload();
+    recording_gl.clear_calls();
+
+    PointLightAttributes point_light = make_point_light(5.0f);
+    light_uniform_manager.set_point_light(2, point_light);
+    // setting it twice still sends it once
+    light_uniform_manager.set_point_light(2, point_light);
+    light_uniform_manager.upload();
+
+    check(recording_gl.use_program_calls == 1, "the program wasn't bound once");
+    check(recording_gl.uniforms.size() == 7, "more or less than the 7 point light uniforms were sent");
+    std::map<std::string, std::vector<float>> sent;
+    for (const RecordedUniform &uniform : recording_gl.uniforms) {
+        const std::string &uniform_name = recording_gl.get_name(uniform.location);
+        check(uniform_name.rfind("point_lights[2].", 0) == 0, uniform_name + " was sent but didn't change");
+        sent[uniform_name] = uniform.value;
+    }
+    check(sent["point_lights[2].position"] == std::vector<float>{5, 1, 2}, "the position sent is wrong");
+    check(sent["point_lights[2].diffuse"] == std::vector<float>{0.5f, 0.5f, 0.5f}, "the diffuse sent is wrong");
+    check(sent["point_lights[2].linear"] == std::vector<float>{0.2f}, "the linear falloff sent is wrong");
+
+    recording_gl.clear_calls();
+    light_uniform_manager.set_view_position(glm::vec3(1, 2, 3));
+    light_uniform_manager.upload();
+    check(recording_gl.use_program_calls == 1 and recording_gl.uniforms.size() == 1 and
+              recording_gl.get_name(recording_gl.uniforms[0].location) == "view_pos",
+          "changing the view position sent more than view_pos");
+
+    check_throws([&] { light_uniform_manager.set_point_light(4, point_light); }, "setting a point light out of range");
+}
+
+} // namespace
+
+int main() {
+    return run_tests({
+        {"locations are resolved once", test_locations_are_resolved_once},
+        {"upload without changes makes no calls", test_upload_without_changes_makes_no_calls},
+        {"only the changed point light is sent", test_only_the_changed_point_light_is_sent},
+    });
+}
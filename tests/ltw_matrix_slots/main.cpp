@@ -0,0 +1,164 @@
+#include "graphics/ltw_matrix_slots/ltw_matrix_slots.hpp"
+
+#include "test_check.hpp"
+
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * slots have to come out lowest first and be reused after a release, a released slot has to go back to identity and
+ * reach the gpu again, and a flush has to cover every written slot with as few ranges as the merge gap allows
+ */
+
+namespace {
+
+// the same as LtwMatrixSlots::MAX_MERGE_GAP, runs with at most this many clean slots between them are one upload
+constexpr unsigned int max_merge_gap = 8;
+
+using SlotRange = std::pair<unsigned int, unsigned int>; // first slot, number of slots
+
+std::vector<SlotRange> flush(LtwMatrixSlots &ltw_matrix_slots) {
+    std::vector<SlotRange> ranges;
+    ltw_matrix_slots.flush_dirty_ranges(
+        [&](unsigned int first_slot, unsigned int num_slots) { ranges.emplace_back(first_slot, num_slots); });
+    return ranges;
+}
+
+glm::mat4 make_matrix(unsigned int slot) { return glm::mat4(static_cast<float>(slot + 2)); }
+
+void test_allocation_order() {
+    LtwMatrixSlots ltw_matrix_slots(4);
+    for (unsigned int expected_slot = 0; expected_slot < 4; expected_slot++) {
+        check(ltw_matrix_slots.allocate() == expected_slot, "slot " + std::to_string(expected_slot) + " wasn't next");
+    }
+    check(ltw_matrix_slots.get_allocated_count() == 4, "the allocated count is wrong when full");
+    check_throws([&] { ltw_matrix_slots.allocate(); }, "allocating past the capacity");
+
+    ltw_matrix_slots.release(2);
+    ltw_matrix_slots.release(0);
+    check(ltw_matrix_slots.get_allocated_count() == 2, "the allocated count is wrong after releasing");
+    // the last released slot is handed out first
+    check(ltw_matrix_slots.allocate() == 0, "the last released slot wasn't reused first");
+    check(ltw_matrix_slots.allocate() == 2, "the other released slot wasn't reused");
+    check_throws([&] { ltw_matrix_slots.allocate(); }, "allocating past the capacity after reusing slots");
+}
+
+void test_unallocated_slots_throw() {
+    LtwMatrixSlots ltw_matrix_slots(4);
+    unsigned int slot = ltw_matrix_slots.allocate();
+    check_throws([&] { ltw_matrix_slots.set(1, make_matrix(1)); }, "setting a slot that isn't allocated");
+    check_throws([&] { ltw_matrix_slots.release(1); }, "releasing a slot that isn't allocated");
+    check_throws([&] { ltw_matrix_slots.release(4); }, "releasing a slot past the capacity");
+    ltw_matrix_slots.release(slot);
+    check_throws([&] { ltw_matrix_slots.release(slot); }, "releasing a slot twice");
+}
+
+void test_release_resets_to_identity() {
+    LtwMatrixSlots ltw_matrix_slots(16);
+    unsigned int slot = ltw_matrix_slots.allocate();
+    unsigned int untouched_slot = ltw_matrix_slots.allocate();
+    ltw_matrix_slots.set(slot, make_matrix(slot));
+    flush(ltw_matrix_slots);
+    check(not ltw_matrix_slots.has_dirty_slots(), "the flush left dirty slots");
+
+    ltw_matrix_slots.release(slot);
+    check(ltw_matrix_slots.get(slot) == glm::mat4(1.0f), "the released slot isn't identity");
+    check(ltw_matrix_slots.has_dirty_slots(), "the released slot isn't dirty");
+    std::vector<SlotRange> ranges = flush(ltw_matrix_slots);
+    check(ranges.size() == 1 and ranges[0] == SlotRange(slot, 1), "the released slot wasn't uploaded on its own");
+
+    // already identity so there is nothing to upload
+    ltw_matrix_slots.release(untouched_slot);
+    check(not ltw_matrix_slots.has_dirty_slots(), "releasing an identity slot made it dirty");
+
+    check(ltw_matrix_slots.allocate() == untouched_slot, "the last released slot wasn't reused first");
+    check(ltw_matrix_slots.allocate() == slot, "the reset slot wasn't reused");
+    check(ltw_matrix_slots.get(slot) == glm::mat4(1.0f), "the reused slot inherited a transform");
+}
+
+void test_flush_merges_across_small_gaps() {
+    LtwMatrixSlots ltw_matrix_slots(64);
+    for (unsigned int i = 0; i < 64; i++) {
+        ltw_matrix_slots.allocate();
+    }
+
+    // exactly max_merge_gap clean slots in between still merges
+    ltw_matrix_slots.set(0, make_matrix(0));
+    ltw_matrix_slots.set(max_merge_gap + 1, make_matrix(max_merge_gap + 1));
+    std::vector<SlotRange> ranges = flush(ltw_matrix_slots);
+    check(ranges.size() == 1 and ranges[0] == SlotRange(0, max_merge_gap + 2), "a gap of max_merge_gap was split");
+
+    // one more clean slot splits it
+    ltw_matrix_slots.set(0, make_matrix(0));
+    ltw_matrix_slots.set(max_merge_gap + 2, make_matrix(max_merge_gap + 2));
+    ranges = flush(ltw_matrix_slots);
+    check(ranges.size() == 2 and ranges[0] == SlotRange(0, 1) and ranges[1] == SlotRange(max_merge_gap + 2, 1),
+          "a gap of max_merge_gap + 1 was merged");
+
+    // written out of order and twice, still sorted and once
+    ltw_matrix_slots.set(40, make_matrix(40));
+    ltw_matrix_slots.set(20, make_matrix(20));
+    ltw_matrix_slots.set(21, make_matrix(21));
+    ltw_matrix_slots.set(20, make_matrix(20));
+    ranges = flush(ltw_matrix_slots);
+    check(ranges.size() == 2 and ranges[0] == SlotRange(20, 2) and ranges[1] == SlotRange(40, 1),
+          "out of order writes weren't flushed as sorted runs");
+
+    check(flush(ltw_matrix_slots).empty(), "a flush with nothing written uploaded something");
+}
+
+void test_flush_covers_random_writes() {
+    const unsigned int capacity = 512;
+    LtwMatrixSlots ltw_matrix_slots(capacity);
+    for (unsigned int i = 0; i < capacity; i++) {
+        ltw_matrix_slots.allocate();
+    }
+
+    std::mt19937 rng(1);
+    for (int round = 0; round < 200; round++) {
+        std::vector<char> written(capacity, false);
+        unsigned int num_writes = rng() % 64;
+        for (unsigned int i = 0; i < num_writes; i++) {
+            unsigned int slot = rng() % capacity;
+            ltw_matrix_slots.set(slot, make_matrix(slot));
+            written[slot] = true;
+        }
+
+        std::vector<char> uploaded(capacity, false);
+        unsigned int previous_range_end = 0;
+        for (const auto &[first_slot, num_slots] : flush(ltw_matrix_slots)) {
+            check(num_slots > 0, "an empty range was uploaded");
+            check(first_slot + num_slots <= capacity, "a range goes past the capacity");
+            check(written[first_slot] and written[first_slot + num_slots - 1], "a range doesn't start and end dirty");
+            if (previous_range_end > 0) {
+                check(first_slot - previous_range_end > max_merge_gap, "two ranges close enough to merge were split");
+            }
+            unsigned int clean_run = 0;
+            for (unsigned int slot = first_slot; slot < first_slot + num_slots; slot++) {
+                uploaded[slot] = true;
+                clean_run = written[slot] ? 0 : clean_run + 1;
+                check(clean_run <= max_merge_gap, "a range spans more than max_merge_gap clean slots");
+            }
+            previous_range_end = first_slot + num_slots;
+        }
+        for (unsigned int slot = 0; slot < capacity; slot++) {
+            check(not written[slot] or uploaded[slot],
+                  "slot " + std::to_string(slot) + " was written but not uploaded");
+        }
+        check(not ltw_matrix_slots.has_dirty_slots(), "the flush left dirty slots");
+    }
+}
+
+} // namespace
+
+int main() {
+    return run_tests({
+        {"allocation order", test_allocation_order},
+        {"unallocated slots throw", test_unallocated_slots_throw},
+        {"release resets to identity", test_release_resets_to_identity},
+        {"flush merges across small gaps", test_flush_merges_across_small_gaps},
+        {"flush covers random writes", test_flush_covers_random_writes},
+    });
+}
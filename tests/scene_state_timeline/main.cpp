@@ -0,0 +1,216 @@
+#include "graphics/scene_state_timeline/scene_state_timeline.hpp"
+
+#include "test_check.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * the timeline is checked against a replay of the script from the start, both when advancing forward and when
+ * scrubbing back, in which case the changed slots have to be exactly the ones whose value is different after the seek
+ */
+
+namespace {
+
+using json = nlohmann::json;
+
+const std::vector<std::string> bool_keys = {"flame.draw", "flick.play", "smoke.emit"};
+const std::vector<std::string> number_keys = {"light.intensity", "camera.fov"};
+const std::vector<std::string> string_keys = {"subtitle"};
+
+std::string write_scene_script(const json &scene_script, const std::string &name) {
+    std::string file_path =
+        (std::filesystem::temp_directory_path() / ("scene_state_timeline_test_" + name + ".json")).string();
+    std::ofstream file(file_path, std::ios::trunc);
+    file << scene_script.dump(2);
+    return file_path;
+}
+
+/**
+ * changes at times 0, 100, 200, ... where every change sets one to three random keys, some changes set a key to the
+ * value it already has so that a delta doesn't always mean a different value
+ */
+json make_random_scene_script(unsigned int num_changes) {
+    std::mt19937 rng(1);
+    json scene_script;
+    for (const std::string &key : bool_keys) {
+        scene_script["state"][key] = false;
+    }
+    for (const std::string &key : number_keys) {
+        scene_script["state"][key] = 0.0;
+    }
+    for (const std::string &key : string_keys) {
+        scene_script["state"][key] = "";
+    }
+
+    scene_script["changes"] = json::array();
+    for (unsigned int i = 0; i < num_changes; i++) {
+        json change;
+        unsigned int num_keys = 1 + rng() % 3;
+        for (unsigned int j = 0; j < num_keys; j++) {
+            switch (rng() % 3) {
+            case 0:
+                change[bool_keys[rng() % bool_keys.size()]] = rng() % 2 == 0;
+                break;
+            case 1:
+                change[number_keys[rng() % number_keys.size()]] = static_cast<double>(rng() % 4);
+                break;
+            case 2:
+                change[string_keys[rng() % string_keys.size()]] = std::to_string(rng() % 3);
+                break;
+            }
+        }
+        scene_script["changes"].push_back({{"time", i * 100.0}, {"change", change}});
+    }
+    return scene_script;
+}
+
+/**
+ * the values of every key at ms_time by applying the changes one by one from the initial state
+ */
+json replay_scene_script(const json &scene_script, double ms_time) {
+    json state = scene_script["state"];
+    for (const json &change : scene_script["changes"]) {
+        if (change["time"].get<double>() > ms_time) {
+            break;
+        }
+        for (const auto &[key, value] : change["change"].items()) {
+            state[key] = value;
+        }
+    }
+    return state;
+}
+
+json get_value(const SceneState &state, const SceneStateSlot &slot) {
+    switch (slot.type) {
+    case SceneStateSlotType::BOOL:
+        return static_cast<bool>(state.bools[slot.index]);
+    case SceneStateSlotType::NUMBER:
+        return state.numbers[slot.index];
+    case SceneStateSlotType::STRING:
+        return state.strings[slot.index];
+    }
+    return nullptr;
+}
+
+bool contains_slot(const std::vector<SceneStateSlot> &slots, const SceneStateSlot &slot) {
+    return std::any_of(slots.begin(), slots.end(), [&](const SceneStateSlot &other) {
+        return other.type == slot.type and other.index == slot.index;
+    });
+}
+
+void check_state_matches_replay(const SceneStateTimeline &timeline, const json &scene_script, double ms_time) {
+    json expected_state = replay_scene_script(scene_script, ms_time);
+    for (const auto &[key, value] : expected_state.items()) {
+        check(get_value(timeline.get_current_state(), timeline.get_slot(key)) == value,
+              key + " differs from the replay at " + std::to_string(ms_time) + "ms");
+    }
+}
+
+void test_forward_advance_matches_replay() {
+    json scene_script = make_random_scene_script(200);
+    SceneStateTimeline timeline(write_scene_script(scene_script, "forward"), 4);
+
+    for (double ms_time = -50.0; ms_time < 20500.0; ms_time += 37.0) {
+        json previous_state = replay_scene_script(scene_script, ms_time - 37.0);
+        json state = replay_scene_script(scene_script, ms_time);
+        timeline.advance(ms_time);
+        check_state_matches_replay(timeline, scene_script, ms_time);
+
+        // every key whose value moved has to be reported, reporting a key that was set to the same value is fine
+        for (const auto &[key, value] : state.items()) {
+            if (previous_state[key] != value) {
+                check(contains_slot(timeline.get_slots_changed_by_last_advance(), timeline.get_slot(key)),
+                      key + " changed at " + std::to_string(ms_time) + "ms but wasn't reported");
+            }
+        }
+    }
+}
+
+void test_backward_advance_reports_differing_slots() {
+    json scene_script = make_random_scene_script(200);
+    SceneStateTimeline timeline(write_scene_script(scene_script, "backward"), 4);
+
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<double> time_dist(-100.0, 20100.0);
+    double ms_last_time = -100.0;
+    for (int i = 0; i < 500; i++) {
+        double ms_time = time_dist(rng);
+        timeline.advance(ms_time);
+        check_state_matches_replay(timeline, scene_script, ms_time);
+
+        json previous_state = replay_scene_script(scene_script, ms_last_time);
+        json state = replay_scene_script(scene_script, ms_time);
+        if (ms_time < ms_last_time) {
+            // going back the changed slots are exactly the ones with a different value
+            std::size_t num_differing = 0;
+            for (const auto &[key, value] : state.items()) {
+                bool differs = previous_state[key] != value;
+                num_differing += differs;
+                check(contains_slot(timeline.get_slots_changed_by_last_advance(), timeline.get_slot(key)) == differs,
+                      key + " was reported wrongly going back from " + std::to_string(ms_last_time) + "ms to " +
+                          std::to_string(ms_time) + "ms");
+            }
+            check(timeline.get_slots_changed_by_last_advance().size() == num_differing,
+                  "a slot was reported twice going back");
+        } else {
+            for (const auto &[key, value] : state.items()) {
+                if (previous_state[key] != value) {
+                    check(contains_slot(timeline.get_slots_changed_by_last_advance(), timeline.get_slot(key)),
+                          key + " changed going forward but wasn't reported");
+                }
+            }
+        }
+        ms_last_time = ms_time;
+    }
+}
+
+void test_backward_advance_to_the_same_state_reports_nothing() {
+    json scene_script;
+    scene_script["state"] = {{"flame.draw", false}, {"light.intensity", 0.0}};
+    scene_script["changes"] = {{{"time", 1000.0}, {"change", {{"flame.draw", true}}}},
+                               {{"time", 2000.0}, {"change", {{"light.intensity", 1.0}}}}};
+    SceneStateTimeline timeline(write_scene_script(scene_script, "same_state"));
+    unsigned int flame_draw_slot = timeline.get_bool_slot("flame.draw");
+
+    timeline.advance(1500.0);
+    check(timeline.get_slots_changed_by_last_advance().size() == 1, "the flame turning on wasn't reported");
+    timeline.advance(1200.0);
+    check(timeline.get_slots_changed_by_last_advance().empty(), "going back without a change reported a slot");
+    timeline.advance(2500.0);
+    check(timeline.get_slots_changed_by_last_advance().size() == 1, "the intensity change wasn't reported");
+    timeline.advance(500.0);
+    check(timeline.get_slots_changed_by_last_advance().size() == 2, "going back to the start didn't report both keys");
+    check(not timeline.get_current_state().bools[flame_draw_slot], "the flame is still on after going back");
+}
+
+void test_unknown_and_mistyped_keys_throw() {
+    json scene_script;
+    scene_script["state"] = {{"flame.draw", false}};
+    scene_script["changes"] = json::array();
+    SceneStateTimeline timeline(write_scene_script(scene_script, "keys"));
+
+    check_throws([&] { timeline.get_slot("flick.play"); }, "getting a key that isn't in the state");
+    check_throws([&] { timeline.get_number_slot("flame.draw"); }, "getting a bool key as a number");
+
+    scene_script["changes"] = {{{"time", 0.0}, {"change", {{"flame.draw", 1.0}}}}};
+    std::string mistyped_path = write_scene_script(scene_script, "mistyped");
+    check_throws([&] { SceneStateTimeline mistyped_timeline(mistyped_path); }, "changing a bool key to a number");
+}
+
+} // namespace
+
+int main() {
+    return run_tests({
+        {"forward advance matches replay", test_forward_advance_matches_replay},
+        {"backward advance reports differing slots", test_backward_advance_reports_differing_slots},
+        {"backward advance to the same state reports nothing", test_backward_advance_to_the_same_state_reports_nothing},
+        {"unknown and mistyped keys throw", test_unknown_and_mistyped_keys_throw},
+    });
+}
@@ -0,0 +1,328 @@
+#include "graphics/scripted_event_timeline/scripted_event_timeline.hpp"
+
+#include "test_check.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <filesystem>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * the timelines are written to temporary json files in the same format as assets/smoking/smoking_event.json, the
+ * callbacks record every call so the tests can check which edges fired in which frame and with which flags
+ */
+
+namespace {
+
+using json = nlohmann::json;
+
+std::string write_scripted_events(const json &scripted_events, const std::string &name) {
+    std::string file_path =
+        (std::filesystem::temp_directory_path() / ("scripted_event_timeline_test_" + name + ".json")).string();
+    std::ofstream file(file_path, std::ios::trunc);
+    file << scripted_events.dump(2);
+    return file_path;
+}
+
+json playthrough(const std::string &name, double time_sec) {
+    return {{"name", name}, {"time", time_sec}, {"type", "playthrough"}};
+}
+
+json toggle(const std::string &name, double start_time_sec, double end_time_sec) {
+    return {{"name", name}, {"start_time", start_time_sec}, {"end_time", end_time_sec}, {"type", "toggle"}};
+}
+
+struct RecordedCall {
+    std::string event_name;
+    bool first_call;
+    bool last_call;
+
+    bool operator==(const RecordedCall &other) const = default;
+};
+
+/**
+ * binds a recording callback to every event of the timeline
+ */
+std::vector<RecordedCall> &record_calls(ScriptedEventTimeline &timeline, std::vector<RecordedCall> &calls) {
+    for (unsigned int event_id = 0; event_id < timeline.get_event_count(); event_id++) {
+        timeline.bind_callback(event_id, [&calls, event_name = timeline.get_event_name(event_id)](
+                                             bool first_call, bool last_call) {
+            calls.push_back({event_name, first_call, last_call});
+        });
+    }
+    return calls;
+}
+
+void test_edges_fire_in_the_frame_that_reaches_them() {
+    json scripted_events = {{"events",
+                             {playthrough("grab", 0.5), toggle("flame", 1.0, 2.0), playthrough("flick", 1.0),
+                              playthrough("stab", 3.25)}}};
+    ScriptedEventTimeline timeline(write_scripted_events(scripted_events, "frames"));
+    std::vector<RecordedCall> calls;
+    record_calls(timeline, calls);
+
+    // frames of 0.25 sec, an edge exactly on a frame time fires in that frame and never again
+    std::vector<std::vector<RecordedCall>> calls_per_frame;
+    for (int frame = 0; frame <= 16; frame++) {
+        calls.clear();
+        timeline.run_scripted_events(frame * 0.25);
+        calls_per_frame.push_back(calls);
+    }
+
+    for (int frame = 0; frame <= 16; frame++) {
+        std::vector<RecordedCall> expected_calls;
+        if (frame == 2) {
+            expected_calls = {{"grab", true, true}};
+        } else if (frame == 4) {
+            expected_calls = {{"flame", true, false}, {"flick", true, true}};
+        } else if (frame == 8) {
+            expected_calls = {{"flame", false, true}};
+        } else if (frame == 13) {
+            expected_calls = {{"stab", true, true}};
+        }
+        check(calls_per_frame[frame] == expected_calls, "frame " + std::to_string(frame) + " fired the wrong edges");
+    }
+
+    // a frame that skips over a whole toggle still fires both of its edges, in order
+    ScriptedEventTimeline skipping_timeline(write_scripted_events(scripted_events, "skipping"));
+    std::vector<RecordedCall> skipping_calls;
+    record_calls(skipping_timeline, skipping_calls);
+    skipping_timeline.run_scripted_events(2.5);
+    std::vector<RecordedCall> expected_calls = {
+        {"grab", true, true}, {"flame", true, false}, {"flick", true, true}, {"flame", false, true}};
+    check(skipping_calls == expected_calls, "a long frame didn't fire every edge it passed in time order");
+
+    // time only moves forward, going back fires nothing
+    skipping_calls.clear();
+    skipping_timeline.run_scripted_events(0.0);
+    check(skipping_calls.empty(), "running an earlier time fired edges again");
+}
+
+void test_first_and_last_call_flags() {
+    json scripted_events = {{"events",
+                             {toggle("inhale", 1.0, 2.0), toggle("inhale", 2.0, 3.0), toggle("empty", 4.0, 4.0),
+                              playthrough("grab", 5.0)}}};
+    ScriptedEventTimeline timeline(write_scripted_events(scripted_events, "flags"));
+    std::vector<RecordedCall> calls;
+    record_calls(timeline, calls);
+    timeline.run_scripted_events(10.0);
+
+    // back to back toggles end before the next one starts, a toggle without length fires once like a playthrough
+    std::vector<RecordedCall> expected_calls = {{"inhale", true, false}, {"inhale", false, true},
+                                                {"inhale", true, false}, {"inhale", false, true},
+                                                {"empty", true, true},   {"grab", true, true}};
+    check(calls == expected_calls, "the first_call and last_call flags are wrong");
+    check(timeline.get_end_time_sec() == 5.0, "the end time isn't the time of the last edge");
+}
+
+void test_interned_ids_are_stable() {
+    json scripted_events = {{"events",
+                             {playthrough("grab", 2.0), toggle("inhale", 1.0, 3.0), playthrough("grab", 4.0),
+                              toggle("exhale", 0.5, 0.75)}}};
+    ScriptedEventTimeline timeline(write_scripted_events(scripted_events, "interning"));
+
+    // names get dense ids in the order they first appear in the file
+    check(timeline.get_event_count() == 3, "repeated names got more than one id");
+    check(timeline.intern_event_name("grab") == 0 and timeline.intern_event_name("inhale") == 1 and
+              timeline.intern_event_name("exhale") == 2,
+          "the ids aren't dense in file order");
+    for (unsigned int event_id = 0; event_id < timeline.get_event_count(); event_id++) {
+        check(timeline.intern_event_name(timeline.get_event_name(event_id)) == event_id,
+              "interning a name twice gave a different id");
+    }
+
+    std::vector<unsigned int> expected_firing_order = {2, 1, 0};
+    check(timeline.get_event_ids_in_firing_order() == expected_firing_order, "the firing order is wrong");
+
+    // binding by name and by id reaches the same event
+    int grab_calls = 0;
+    timeline.bind_callbacks({{"grab", [&](bool first_call, bool last_call) { grab_calls++; }}});
+    timeline.run_scripted_events(10.0);
+    check(grab_calls == 2, "the callback bound by name didn't get both grabs");
+}
+
+void test_unknown_names() {
+    json scripted_events = {{"events", {playthrough("grab", 1.0), toggle("inhale", 2.0, 3.0)}}};
+    ScriptedEventTimeline timeline(write_scripted_events(scripted_events, "unknown"));
+
+    // a name that isn't in the timeline still gets an id and a callback, which never fires
+    unsigned int unknown_event_id = timeline.intern_event_name("knife_throw");
+    check(unknown_event_id == 2, "the unknown name didn't get the next id");
+    check(timeline.get_event_count() == 3, "the unknown name wasn't added");
+    check(timeline.get_event_name(unknown_event_id) == "knife_throw", "the unknown name isn't kept");
+    check(timeline.intern_event_name("grab") == 0 and timeline.intern_event_name("inhale") == 1,
+          "interning an unknown name moved the known ones");
+
+    bool unknown_fired = false;
+    std::vector<RecordedCall> calls;
+    record_calls(timeline, calls);
+    timeline.bind_callbacks({{"knife_throw", [&](bool first_call, bool last_call) { unknown_fired = true; }},
+                             {"couch_stab", [&](bool first_call, bool last_call) { unknown_fired = true; }}});
+    timeline.run_scripted_events(10.0);
+    check(not unknown_fired, "a callback of an event that isn't in the timeline fired");
+    check(calls.size() == 3, "binding unknown names changed what the known events fire");
+
+    // events without a callback are skipped
+    ScriptedEventTimeline unbound_timeline(write_scripted_events(scripted_events, "unbound"));
+    unbound_timeline.run_scripted_events(10.0);
+
+    json unknown_type = {{"events", {{{"name", "grab"}, {"time", 1.0}, {"type", "sometimes"}}}}};
+    std::string unknown_type_path = write_scripted_events(unknown_type, "unknown_type");
+    check_throws([&] { ScriptedEventTimeline unknown_type_timeline(unknown_type_path); }, "an unknown event type");
+    check_throws([&] { ScriptedEventTimeline missing_timeline("scripted_event_timeline_test_missing.json"); },
+                 "a missing file");
+}
+
+/**
+ * what the callbacks of a timeline have turned on, and whether they ever started a toggle that was already on or ended
+ * one that was off
+ */
+struct ToggleStates {
+    std::vector<bool> on;
+    bool consistent = true;
+};
+
+void track_toggle_states(ScriptedEventTimeline &timeline, ToggleStates &toggle_states) {
+    toggle_states.on.assign(timeline.get_event_count(), false);
+    for (unsigned int event_id = 0; event_id < timeline.get_event_count(); event_id++) {
+        timeline.bind_callback(event_id, [&toggle_states, event_id](bool first_call, bool last_call) {
+            if (first_call and last_call) {
+                return;
+            }
+            if (toggle_states.on[event_id] == first_call) {
+                toggle_states.consistent = false;
+            }
+            toggle_states.on[event_id] = first_call;
+        });
+    }
+}
+
+bool same_active_toggles(const std::vector<ActiveToggle> &a, const std::vector<ActiveToggle> &b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const ActiveToggle &x, const ActiveToggle &y) {
+        return x.event_id == y.event_id and x.count == y.count;
+    });
+}
+
+void test_overlapping_toggles_are_counted() {
+    json scripted_events = {{"events", {toggle("flame", 1.0, 3.0), toggle("flame", 2.0, 4.0)}}};
+    std::string file_path = write_scripted_events(scripted_events, "overlapping");
+
+    ScriptedEventTimeline timeline(file_path);
+    std::vector<RecordedCall> calls;
+    record_calls(timeline, calls);
+    timeline.run_scripted_events(10.0);
+    std::vector<RecordedCall> expected_calls = {{"flame", true, false}, {"flame", false, true}};
+    check(calls == expected_calls, "overlapping toggles didn't start once and end once when playing forward");
+
+    ScriptedEventTimeline seeking_timeline(file_path);
+    std::vector<RecordedCall> seeking_calls;
+    record_calls(seeking_timeline, seeking_calls);
+    seeking_timeline.seek(2.5);
+    check(seeking_calls.size() == 1 and seeking_calls[0] == RecordedCall{"flame", true, false},
+          "seeking into the overlap didn't start the toggle once");
+    check(same_active_toggles(seeking_timeline.get_active_toggles(), {{0, 2}}), "the overlap isn't counted twice");
+
+    // playing on from the overlap ends the toggle only when the second one ends
+    seeking_calls.clear();
+    seeking_timeline.run_scripted_events(3.5);
+    check(seeking_calls.empty(), "the end of the first overlapping toggle reached the callback");
+    seeking_timeline.run_scripted_events(4.0);
+    check(seeking_calls.size() == 1 and seeking_calls[0] == RecordedCall{"flame", false, true},
+          "the end of the last overlapping toggle didn't reach the callback");
+
+    // seeking back into the overlap after playing through it starts it once again
+    seeking_calls.clear();
+    seeking_timeline.seek(2.5);
+    seeking_timeline.seek(0.0);
+    expected_calls = {{"flame", true, false}, {"flame", false, true}};
+    check(seeking_calls == expected_calls, "seeking back and forth through the overlap fired the wrong edges");
+}
+
+/**
+ * seeks a timeline around at random, after every seek the toggles it has turned on must be the ones a fresh timeline
+ * turns on by playing forward to just before the target, since seek leaves the edges at the target unfired. the
+ * timelines have overlapping toggles of the same events and are long enough to go past several checkpoints
+ */
+void test_seek_matches_forward_replay() {
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<int> name_distribution(0, 5);
+    std::uniform_int_distribution<int> quarter_distribution(0, 200);
+    std::uniform_int_distribution<int> length_distribution(0, 20);
+
+    int forward_seeks = 0;
+    int backward_seeks = 0;
+    for (int timeline_index = 0; timeline_index < 8; timeline_index++) {
+        json events = json::array();
+        for (int i = 0; i < 150; i++) {
+            std::string name = "event_" + std::to_string(name_distribution(random));
+            double start_time_sec = quarter_distribution(random) * 0.25;
+            if (i % 3 == 0) {
+                events.push_back(playthrough(name, start_time_sec));
+            } else {
+                events.push_back(toggle(name, start_time_sec, start_time_sec + length_distribution(random) * 0.25));
+            }
+        }
+        std::string file_path = write_scripted_events({{"events", events}}, "random_" + std::to_string(timeline_index));
+
+        ScriptedEventTimeline seeking_timeline(file_path);
+        ToggleStates seeking_states;
+        track_toggle_states(seeking_timeline, seeking_states);
+
+        double curr_time_sec = 0.0;
+        for (int seek_index = 0; seek_index < 100; seek_index++) {
+            // half of the targets land on the quarter grid the edges are on, the other half between them
+            double target_time_sec = quarter_distribution(random) * 0.25 - 1.0;
+            if (seek_index % 2 == 1) {
+                target_time_sec += 0.1;
+            }
+            (target_time_sec < curr_time_sec ? backward_seeks : forward_seeks)++;
+            seeking_timeline.seek(target_time_sec);
+
+            ScriptedEventTimeline replaying_timeline(file_path);
+            ToggleStates replaying_states;
+            track_toggle_states(replaying_timeline, replaying_states);
+            for (double time_sec = 0.0; time_sec < target_time_sec; time_sec += 0.5) {
+                replaying_timeline.run_scripted_events(time_sec);
+            }
+            replaying_timeline.run_scripted_events(std::nextafter(target_time_sec, -1.0e9));
+
+            check(seeking_states.on == replaying_states.on, "seek turned on different toggles than playing forward");
+            check(same_active_toggles(seeking_timeline.get_active_toggles(), replaying_timeline.get_active_toggles()),
+                  "seek left different active toggles than playing forward");
+
+            // the edges at the target fire on the next frame, the same as for the replay
+            seeking_timeline.run_scripted_events(target_time_sec);
+            replaying_timeline.run_scripted_events(target_time_sec);
+            check(seeking_states.on == replaying_states.on, "the frame after a seek didn't catch up with the replay");
+            check(replaying_states.consistent,
+                  "playing forward started a toggle that was on or ended one that was off");
+            curr_time_sec = target_time_sec;
+        }
+        check(seeking_states.consistent, "seek started a toggle that was on or ended one that was off");
+
+        // seeking to the end turns everything off, the same as playing through
+        seeking_timeline.seek(seeking_timeline.get_end_time_sec() + 1.0);
+        check(seeking_timeline.get_active_toggles().empty(), "toggles are still on after the end");
+        check(std::find(seeking_states.on.begin(), seeking_states.on.end(), true) == seeking_states.on.end(),
+              "a callback didn't hear that its toggle ended");
+    }
+    check(forward_seeks > 100 and backward_seeks > 100, "the random seeks didn't go both ways");
+}
+
+} // namespace
+
+int main() {
+    return run_tests({
+        {"edges fire in the frame that reaches them", test_edges_fire_in_the_frame_that_reaches_them},
+        {"first and last call flags", test_first_and_last_call_flags},
+        {"interned ids are stable", test_interned_ids_are_stable},
+        {"unknown names", test_unknown_names},
+        {"overlapping toggles are counted", test_overlapping_toggles_are_counted},
+        {"seek matches forward replay", test_seek_matches_forward_replay},
+    });
+}
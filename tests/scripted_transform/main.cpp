@@ -0,0 +1,320 @@
+#include "graphics/scripted_transform/scripted_transform.hpp"
+
+#include "test_check.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+/**
+ * the arc length sample lookup (the binary search and the cursor that update keeps on top of it) has to pick exactly
+ * the sample the old linear scan picked, the first one whose end is at or past the arc length. both are compared
+ * against a linear scan here, the cursor through update since that is the only way it's used.
+ */
+
+namespace {
+
+const std::vector<std::size_t> KEYFRAME_COUNTS = {4, 5, 16, 100, 1000};
+
+std::vector<ScriptedTransformKeyframe> make_keyframes(std::size_t num_keyframes, unsigned int seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> step_dist(-1.0f, 1.0f);
+    std::vector<ScriptedTransformKeyframe> keyframes;
+    glm::vec3 position(0.0f);
+    for (std::size_t i = 0; i < num_keyframes; i++) {
+        // a random walk, so that the segments have different lengths and the speed varies inside of them
+        position += glm::vec3(step_dist(rng), step_dist(rng), step_dist(rng)) * (1.0f + i % 3);
+        keyframes.push_back({position, glm::vec3(step_dist(rng), step_dist(rng), step_dist(rng)),
+                             glm::vec3(1.0f + 0.5f * step_dist(rng))});
+    }
+    // a keyframe repeated makes a segment of zero length, which the lookup has to get through too
+    if (num_keyframes > 8) {
+        keyframes[5].position = keyframes[4].position;
+    }
+    return keyframes;
+}
+
+std::size_t linear_scan_sample_index(std::span<const ArcLengthSample> arc_length_samples, double arc_length) {
+    for (std::size_t i = 0; i < arc_length_samples.size(); i++) {
+        if (arc_length_samples[i].arc_length >= arc_length) {
+            return i;
+        }
+    }
+    return arc_length_samples.size() - 1;
+}
+
+/**
+ * what update computes for the position, with the sample found by a linear scan
+ */
+glm::vec3 linear_scan_position(const ScriptedTransformView &view, double ms_curr_time) {
+    if (ms_curr_time <= view.ms_start_time) {
+        return view.keyframes[1].position;
+    }
+    if (ms_curr_time >= view.ms_end_time) {
+        return view.keyframes[view.keyframes.size() - 2].position;
+    }
+
+    double total_arc_length = view.cummulative_arc_lengths_position.back();
+    double curr_arc_length =
+        total_arc_length * (ms_curr_time - view.ms_start_time) / (view.ms_end_time - view.ms_start_time);
+
+    std::size_t sample_index = linear_scan_sample_index(view.arc_length_samples, curr_arc_length);
+    const ArcLengthSample &sample = view.arc_length_samples[sample_index];
+    double sample_start_arc_length = sample_index == 0 ? 0.0 : view.arc_length_samples[sample_index - 1].arc_length;
+    double sample_arc_length = sample.arc_length - sample_start_arc_length;
+    double sample_percentage =
+        sample_arc_length > 0.0 ? (curr_arc_length - sample_start_arc_length) / sample_arc_length : 0.0;
+
+    float t = sample.t_start + sample_percentage * (sample.t_end - sample.t_start);
+    return view.coef_matrices_position[sample.segment_index] * glm::vec4(1, t, t * t, t * t * t);
+}
+
+void check_update_matches_linear_scan(ScriptedTransform &scripted_transform, const std::vector<double> &times,
+                                      const std::string &order) {
+    ScriptedTransformView view = scripted_transform.get_view();
+    for (double ms_curr_time : times) {
+        scripted_transform.update(ms_curr_time);
+        check(scripted_transform.transform.position == linear_scan_position(view, ms_curr_time),
+              order + " update at " + std::to_string(ms_curr_time) + " ms with " +
+                  std::to_string(view.keyframes.size()) + " keyframes differs from the linear scan");
+    }
+}
+
+void test_binary_search_matches_linear_scan() {
+    for (std::size_t num_keyframes : KEYFRAME_COUNTS) {
+        ScriptedTransform scripted_transform(make_keyframes(num_keyframes, 1), 0.0, 10000.0);
+        std::span<const ArcLengthSample> arc_length_samples = scripted_transform.get_view().arc_length_samples;
+
+        // every sample end, just before and after it, and past both ends of the path
+        std::vector<double> arc_lengths = {-1.0, 0.0, arc_length_samples.back().arc_length * 2.0};
+        for (const ArcLengthSample &sample : arc_length_samples) {
+            arc_lengths.push_back(sample.arc_length);
+            arc_lengths.push_back(std::nextafter(sample.arc_length, -1.0));
+            arc_lengths.push_back(std::nextafter(sample.arc_length, sample.arc_length * 2.0 + 1.0));
+        }
+        std::mt19937 rng(2);
+        std::uniform_real_distribution<double> arc_length_dist(0.0, arc_length_samples.back().arc_length);
+        for (int i = 0; i < 1000; i++) {
+            arc_lengths.push_back(arc_length_dist(rng));
+        }
+
+        for (double arc_length : arc_lengths) {
+            check(scripted_transform.find_arc_length_sample_index(arc_length) ==
+                      linear_scan_sample_index(arc_length_samples, arc_length),
+                  "binary search at arc length " + std::to_string(arc_length) + " with " +
+                      std::to_string(num_keyframes) + " keyframes differs from the linear scan");
+        }
+    }
+}
+
+void test_forward_playback_matches_linear_scan() {
+    for (std::size_t num_keyframes : KEYFRAME_COUNTS) {
+        ScriptedTransform scripted_transform(make_keyframes(num_keyframes, 3), 500.0, 20500.0);
+        std::vector<double> times;
+        // 60 fps, with a frame now and then that took much longer
+        for (double ms_curr_time = 0.0; ms_curr_time < 21000.0; ms_curr_time += times.size() % 97 == 0 ? 250.0 : 16.6) {
+            times.push_back(ms_curr_time);
+        }
+        check_update_matches_linear_scan(scripted_transform, times, "forward");
+    }
+}
+
+void test_backward_playback_matches_linear_scan() {
+    for (std::size_t num_keyframes : KEYFRAME_COUNTS) {
+        ScriptedTransform scripted_transform(make_keyframes(num_keyframes, 4), 500.0, 20500.0);
+        std::vector<double> times;
+        for (double ms_curr_time = 21000.0; ms_curr_time > 0.0; ms_curr_time -= 16.6) {
+            times.push_back(ms_curr_time);
+        }
+        check_update_matches_linear_scan(scripted_transform, times, "backward");
+    }
+}
+
+void test_random_access_matches_linear_scan() {
+    for (std::size_t num_keyframes : KEYFRAME_COUNTS) {
+        ScriptedTransform scripted_transform(make_keyframes(num_keyframes, 5), 500.0, 20500.0);
+        std::mt19937 rng(6);
+        std::uniform_real_distribution<double> time_dist(0.0, 21000.0);
+        std::vector<double> times;
+        for (int i = 0; i < 2000; i++) {
+            times.push_back(time_dist(rng));
+        }
+        check_update_matches_linear_scan(scripted_transform, times, "random access");
+    }
+}
+
+void test_boundary_times_match_linear_scan() {
+    for (std::size_t num_keyframes : KEYFRAME_COUNTS) {
+        const double ms_start_time = 500.0;
+        const double ms_end_time = 20500.0;
+        ScriptedTransform scripted_transform(make_keyframes(num_keyframes, 7), ms_start_time, ms_end_time);
+        ScriptedTransformView view = scripted_transform.get_view();
+
+        std::vector<double> times = {-1000.0,
+                                     ms_start_time,
+                                     std::nextafter(ms_start_time, ms_end_time),
+                                     std::nextafter(ms_end_time, ms_start_time),
+                                     ms_end_time,
+                                     ms_end_time + 1000.0,
+                                     ms_start_time};
+        // the times at which each sample ends, where the cursor has to move on to the next sample
+        double total_arc_length = view.cummulative_arc_lengths_position.back();
+        for (const ArcLengthSample &sample : view.arc_length_samples) {
+            double ms_sample_end_time =
+                ms_start_time + sample.arc_length / total_arc_length * (ms_end_time - ms_start_time);
+            times.push_back(std::nextafter(ms_sample_end_time, ms_start_time));
+            times.push_back(ms_sample_end_time);
+            times.push_back(std::nextafter(ms_sample_end_time, ms_end_time));
+        }
+        check_update_matches_linear_scan(scripted_transform, times, "boundary");
+    }
+}
+
+bool nearly_equal(const glm::mat4 &a, const glm::mat4 &b, float tolerance) {
+    for (int column = 0; column < 4; column++) {
+        for (int row = 0; row < 4; row++) {
+            if (std::abs(a[column][row] - b[column][row]) > tolerance) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void test_quaternion_matrix_requires_quaternion_track() {
+    ScriptedTransform scripted_transform(make_keyframes(16, 8), 0.0, 10000.0);
+    glm::mat4 transform_matrix;
+    check_throws([&] { scripted_transform.update(5000.0, transform_matrix); },
+                 "update into a matrix without use_quaternion_rotation");
+}
+
+/**
+ * the quaternion track only changes how the rotation is interpolated, the translation and scale have to be exactly
+ * what the euler update gives
+ */
+void test_quaternion_matrix_translation_and_scale() {
+    for (std::size_t num_keyframes : KEYFRAME_COUNTS) {
+        ScriptedTransform scripted_transform(make_keyframes(num_keyframes, 9), 500.0, 20500.0, 0.5, 0.5, 0.5, 0.01,
+                                             true);
+        std::mt19937 rng(10);
+        std::uniform_real_distribution<double> time_dist(0.0, 21000.0);
+        for (int i = 0; i < 200; i++) {
+            double ms_curr_time = time_dist(rng);
+            glm::mat4 transform_matrix;
+            scripted_transform.update(ms_curr_time, transform_matrix);
+            scripted_transform.update(ms_curr_time);
+            std::string where = "at " + std::to_string(ms_curr_time) + " ms with " + std::to_string(num_keyframes) +
+                                " keyframes";
+
+            check(glm::vec3(transform_matrix[3]) == scripted_transform.transform.position, "translation " + where);
+            check(transform_matrix[0][3] == 0 and transform_matrix[1][3] == 0 and transform_matrix[2][3] == 0 and
+                      transform_matrix[3][3] == 1,
+                  "last row " + where);
+            for (int axis = 0; axis < 3; axis++) {
+                float axis_length = glm::length(glm::vec3(transform_matrix[axis]));
+                float scale = scripted_transform.transform.scale[axis];
+                check(std::abs(axis_length - std::abs(scale)) <= 1e-4f * (1.0f + std::abs(scale)), "scale " + where);
+            }
+        }
+    }
+}
+
+/**
+ * the interpolation goes through every keyframe, so at the time the path reaches a keyframe the quaternion matrix has
+ * to be the keyframe's transform as Transform builds it from the euler angles
+ */
+void test_quaternion_matrix_matches_euler_at_keyframes() {
+    for (std::size_t num_keyframes : KEYFRAME_COUNTS) {
+        std::vector<ScriptedTransformKeyframe> keyframes = make_keyframes(num_keyframes, 11);
+        const double ms_start_time = 500.0;
+        const double ms_end_time = 20500.0;
+        ScriptedTransform scripted_transform(keyframes, ms_start_time, ms_end_time, 0.5, 0.5, 0.5, 0.01, true);
+        ScriptedTransformView view = scripted_transform.get_view();
+
+        double total_arc_length = view.cummulative_arc_lengths_position.back();
+        for (std::size_t i = 0; i < view.cummulative_arc_lengths_position.size(); i++) {
+            // the i-th arc length is reached at keyframe i + 1, the first and last keyframe only shape the ends
+            double ms_keyframe_time = ms_start_time + view.cummulative_arc_lengths_position[i] / total_arc_length *
+                                                          (ms_end_time - ms_start_time);
+            glm::mat4 transform_matrix;
+            scripted_transform.update(ms_keyframe_time, transform_matrix);
+
+            Transform keyframe_transform;
+            keyframe_transform.position = keyframes[i + 1].position;
+            keyframe_transform.rotation = keyframes[i + 1].rotation;
+            keyframe_transform.scale = keyframes[i + 1].scale;
+            check(nearly_equal(transform_matrix, keyframe_transform.get_transform_matrix(), 1e-3f),
+                  "keyframe " + std::to_string(i + 1) + " of " + std::to_string(num_keyframes));
+        }
+    }
+}
+
+/**
+ * the largest relative difference between the speed measured by stepping update through the path and the constant
+ * speed the path is supposed to move at
+ */
+double measure_max_speed_error(double arc_length_tolerance) {
+    // keyframes on a rising arc with a big step after every two small ones, so that the raw spline parameter moves at
+    // very different speeds, but without corners where the distance between two steps would cut through the curve
+    std::vector<ScriptedTransformKeyframe> keyframes;
+    float angle = 0.0f;
+    for (int i = 0; i < 12; i++) {
+        angle += i % 3 == 0 ? 0.6f : 0.1f;
+        keyframes.push_back(
+            {glm::vec3(10.0f * std::cos(angle), 10.0f * std::sin(angle), 0.5f * i * i), glm::vec3(0), glm::vec3(1)});
+    }
+    const double ms_start_time = 0.0;
+    const double ms_end_time = 10000.0;
+    ScriptedTransform scripted_transform(keyframes, ms_start_time, ms_end_time, 0.5, 0.5, 0.5, arc_length_tolerance);
+
+    double total_arc_length = scripted_transform.get_view().cummulative_arc_lengths_position.back();
+    double expected_speed = total_arc_length / (ms_end_time - ms_start_time);
+
+    // coarse enough that float positions don't dominate the measured distances
+    const int num_steps = 2000;
+    double ms_step = (ms_end_time - ms_start_time) / num_steps;
+    scripted_transform.update(ms_start_time);
+    glm::vec3 previous_position = scripted_transform.transform.position;
+    double max_speed_error = 0.0;
+    for (int step = 1; step <= num_steps; step++) {
+        scripted_transform.update(ms_start_time + step * ms_step);
+        double speed = glm::length(scripted_transform.transform.position - previous_position) / ms_step;
+        max_speed_error = std::max(max_speed_error, std::abs(speed / expected_speed - 1.0));
+        previous_position = scripted_transform.transform.position;
+    }
+    return max_speed_error;
+}
+
+/**
+ * the inverse arc length table is built so that the speed along the path stays within arc_length_tolerance of
+ * constant, the small extra margin covers measuring with chords and float positions
+ */
+void test_speed_stays_within_arc_length_tolerance() {
+    for (double arc_length_tolerance : {0.05, 0.01, 0.002}) {
+        double max_speed_error = measure_max_speed_error(arc_length_tolerance);
+        check(max_speed_error <= arc_length_tolerance + 0.001,
+              "the speed is off by " + std::to_string(max_speed_error) + " with a tolerance of " +
+                  std::to_string(arc_length_tolerance));
+    }
+    // without a table worth the name the speed isn't close to constant, otherwise the check above proves nothing
+    check(measure_max_speed_error(10.0) > 0.2, "the test path moves at a constant speed on its own");
+}
+
+} // namespace
+
+int main() {
+    return run_tests({
+        {"binary search matches linear scan", test_binary_search_matches_linear_scan},
+        {"forward playback matches linear scan", test_forward_playback_matches_linear_scan},
+        {"backward playback matches linear scan", test_backward_playback_matches_linear_scan},
+        {"random access matches linear scan", test_random_access_matches_linear_scan},
+        {"boundary times match linear scan", test_boundary_times_match_linear_scan},
+        {"quaternion matrix requires a quaternion track", test_quaternion_matrix_requires_quaternion_track},
+        {"quaternion matrix translation and scale", test_quaternion_matrix_translation_and_scale},
+        {"quaternion matrix matches euler at keyframes", test_quaternion_matrix_matches_euler_at_keyframes},
+        {"speed stays within arc length tolerance", test_speed_stays_within_arc_length_tolerance},
+    });
+}
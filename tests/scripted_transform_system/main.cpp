@@ -0,0 +1,137 @@
+#include "graphics/scripted_transform/scripted_transform.hpp"
+#include "graphics/scripted_transform_system/scripted_transform_system.hpp"
+
+#include "test_check.hpp"
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * the system has to give what every track's own ScriptedTransform::update gives. it evaluates the cubics with horner's
+ * method in float where update multiplies by the powers of t, so the two agree up to rounding and not bit for bit.
+ * the track counts go through the avx2 lanes of 8, the sse lanes of 4 and the scalar tail.
+ */
+
+namespace {
+
+const std::vector<std::size_t> KEYFRAME_COUNTS = {4, 5, 16, 100};
+const std::vector<std::size_t> TRACK_COUNTS = {1, 3, 4, 8, 13, 29};
+
+std::vector<ScriptedTransformKeyframe> make_keyframes(std::size_t num_keyframes, std::mt19937 &rng) {
+    std::uniform_real_distribution<float> step_dist(-1.0f, 1.0f);
+    std::vector<ScriptedTransformKeyframe> keyframes;
+    glm::vec3 position(0.0f);
+    glm::vec3 rotation(0.0f);
+    for (std::size_t i = 0; i < num_keyframes; i++) {
+        position += glm::vec3(step_dist(rng), step_dist(rng), step_dist(rng));
+        rotation += glm::vec3(step_dist(rng), step_dist(rng), step_dist(rng)) * 0.3f;
+        keyframes.push_back({position, rotation, glm::vec3(1.0f + 0.5f * step_dist(rng))});
+    }
+    return keyframes;
+}
+
+bool nearly_equal(const glm::vec3 &a, const glm::vec3 &b) {
+    for (int axis = 0; axis < 3; axis++) {
+        if (std::abs(a[axis] - b[axis]) > 1e-4f * (1.0f + std::abs(b[axis]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * tracks with different keyframe counts and time ranges, evaluated by the system and one by one at the given times
+ */
+void check_system_matches_tracks(std::size_t num_keyframes, std::size_t num_tracks, const std::vector<double> &times) {
+    std::mt19937 rng(num_keyframes * 100 + num_tracks);
+    std::uniform_real_distribution<double> ms_start_time_dist(0.0, 2000.0);
+    std::uniform_real_distribution<double> ms_duration_dist(1000.0, 20000.0);
+
+    std::vector<ScriptedTransform> scripted_transforms;
+    ScriptedTransformSystem scripted_transform_system;
+    for (std::size_t i = 0; i < num_tracks; i++) {
+        double ms_start_time = ms_start_time_dist(rng);
+        // a few tracks longer than the others so that they don't all hit their segment boundaries together
+        scripted_transforms.emplace_back(make_keyframes(num_keyframes + i % 3, rng), ms_start_time,
+                                         ms_start_time + ms_duration_dist(rng));
+        check(scripted_transform_system.add_track(scripted_transforms.back()) == i,
+              "add_track didn't return the tracks in order");
+    }
+    check(scripted_transform_system.get_track_count() == num_tracks, "wrong track count");
+
+    std::vector<Transform> transforms(num_tracks);
+    for (double ms_curr_time : times) {
+        scripted_transform_system.update(ms_curr_time, transforms.data());
+        for (std::size_t i = 0; i < num_tracks; i++) {
+            scripted_transforms[i].update(ms_curr_time);
+            const Transform &expected = scripted_transforms[i].transform;
+            std::string where = "track " + std::to_string(i) + " of " + std::to_string(num_tracks) + " with " +
+                                std::to_string(num_keyframes) + " keyframes at " + std::to_string(ms_curr_time) +
+                                " ms";
+            check(nearly_equal(transforms[i].position, expected.position), "position of " + where);
+            check(nearly_equal(transforms[i].rotation, expected.rotation), "rotation of " + where);
+            check(nearly_equal(transforms[i].scale, expected.scale), "scale of " + where);
+        }
+    }
+}
+
+void test_forward_playback() {
+    std::vector<double> times;
+    for (double ms_curr_time = 0.0; ms_curr_time < 23000.0; ms_curr_time += 16.6) {
+        times.push_back(ms_curr_time);
+    }
+    for (std::size_t num_keyframes : KEYFRAME_COUNTS) {
+        for (std::size_t num_tracks : TRACK_COUNTS) {
+            check_system_matches_tracks(num_keyframes, num_tracks, times);
+        }
+    }
+}
+
+void test_backward_playback() {
+    std::vector<double> times;
+    for (double ms_curr_time = 23000.0; ms_curr_time > 0.0; ms_curr_time -= 16.6) {
+        times.push_back(ms_curr_time);
+    }
+    for (std::size_t num_keyframes : KEYFRAME_COUNTS) {
+        for (std::size_t num_tracks : TRACK_COUNTS) {
+            check_system_matches_tracks(num_keyframes, num_tracks, times);
+        }
+    }
+}
+
+void test_random_access() {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> time_dist(-1000.0, 23000.0);
+    std::vector<double> times;
+    for (int i = 0; i < 500; i++) {
+        times.push_back(time_dist(rng));
+    }
+    for (std::size_t num_keyframes : KEYFRAME_COUNTS) {
+        for (std::size_t num_tracks : TRACK_COUNTS) {
+            check_system_matches_tracks(num_keyframes, num_tracks, times);
+        }
+    }
+}
+
+void test_before_start_and_after_end() {
+    // every track is before its start at -1000 ms and past its end at 100000 ms
+    std::vector<double> times = {-1000.0, 100000.0, -1000.0};
+    for (std::size_t num_keyframes : KEYFRAME_COUNTS) {
+        for (std::size_t num_tracks : TRACK_COUNTS) {
+            check_system_matches_tracks(num_keyframes, num_tracks, times);
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    return run_tests({
+        {"forward playback matches the tracks", test_forward_playback},
+        {"backward playback matches the tracks", test_backward_playback},
+        {"random access matches the tracks", test_random_access},
+        {"before the start and after the end match the tracks", test_before_start_and_after_end},
+    });
+}
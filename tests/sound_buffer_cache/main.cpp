@@ -0,0 +1,171 @@
+#include "sound_buffer_cache/sound_buffer_cache.hpp"
+
+#include "test_check.hpp"
+
+#include <AL/alc.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * runs the cache against a real openal context, ctest sets ALSOFT_DRIVERS=null so that no audio device is needed. the
+ * sounds are short wav files written here, every sample is 2 bytes so their decoded sizes are known exactly
+ */
+
+namespace {
+
+constexpr unsigned int sound_num_frames = 1000;
+constexpr std::size_t sound_size_bytes = sound_num_frames * sizeof(std::int16_t);
+
+class OpenALContext {
+  public:
+    OpenALContext() {
+        device = alcOpenDevice(nullptr);
+        check(device != nullptr, "couldn't open an openal device, is ALSOFT_DRIVERS=null set");
+        context = alcCreateContext(device, nullptr);
+        check(context != nullptr and alcMakeContextCurrent(context), "couldn't create an openal context");
+    }
+
+    ~OpenALContext() {
+        alcMakeContextCurrent(nullptr);
+        alcDestroyContext(context);
+        alcCloseDevice(device);
+    }
+
+  private:
+    ALCdevice *device;
+    ALCcontext *context;
+};
+
+template <typename T> void write_value(std::ofstream &file, T value) {
+    file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+/**
+ * a 16 bit mono wav file of a quiet ramp
+ */
+std::string write_sound(const std::string &name, unsigned int num_frames = sound_num_frames) {
+    std::string file_path =
+        (std::filesystem::temp_directory_path() / ("sound_buffer_cache_test_" + name + ".wav")).string();
+    std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+    std::uint32_t data_size = num_frames * sizeof(std::int16_t);
+    std::uint32_t sample_rate = 8000;
+    file.write("RIFF", 4);
+    write_value<std::uint32_t>(file, 36 + data_size);
+    file.write("WAVEfmt ", 8);
+    write_value<std::uint32_t>(file, 16);
+    write_value<std::uint16_t>(file, 1); // pcm
+    write_value<std::uint16_t>(file, 1); // mono
+    write_value<std::uint32_t>(file, sample_rate);
+    write_value<std::uint32_t>(file, sample_rate * sizeof(std::int16_t));
+    write_value<std::uint16_t>(file, sizeof(std::int16_t));
+    write_value<std::uint16_t>(file, 16);
+    file.write("data", 4);
+    write_value<std::uint32_t>(file, data_size);
+    for (unsigned int i = 0; i < num_frames; i++) {
+        write_value<std::int16_t>(file, static_cast<std::int16_t>(i % 256));
+    }
+    return file_path;
+}
+
+void test_wait_until_idle_loads_every_request() {
+    OpenALContext openal_context;
+    SoundBufferCache sound_buffer_cache(1 << 20);
+
+    std::vector<std::string> file_paths = {write_sound("a"), write_sound("b"), write_sound("c")};
+    std::string missing_file_path = "sound_buffer_cache_test_missing.wav";
+    sound_buffer_cache.prewarm(file_paths);
+    sound_buffer_cache.request(missing_file_path);
+    sound_buffer_cache.wait_until_idle();
+
+    for (const std::string &file_path : file_paths) {
+        check(sound_buffer_cache.is_ready(file_path), file_path + " isn't ready after waiting until idle");
+    }
+    check(sound_buffer_cache.has_failed(missing_file_path), "the missing sound didn't fail");
+    check(not sound_buffer_cache.is_ready(missing_file_path), "the missing sound is ready");
+    check(sound_buffer_cache.get_loaded_count() == 3, "the loaded count is wrong");
+    check(sound_buffer_cache.get_memory_usage() == 3 * sound_size_bytes, "the memory usage isn't the decoded size");
+
+    // nothing is requested any more so this has to return right away
+    sound_buffer_cache.wait_until_idle();
+
+    // acquiring a sound that was never requested requests it
+    std::string late_file_path = write_sound("late");
+    check(sound_buffer_cache.acquire(late_file_path) == 0, "a sound that was never requested was ready");
+    sound_buffer_cache.wait_until_idle();
+    ALuint buffer = sound_buffer_cache.acquire(late_file_path);
+    check(buffer != 0 and alIsBuffer(buffer), "the acquired sound has no openal buffer");
+    ALint buffer_size = 0;
+    alGetBufferi(buffer, AL_SIZE, &buffer_size);
+    check(buffer_size == static_cast<ALint>(sound_size_bytes), "the openal buffer has the wrong size");
+    sound_buffer_cache.release(late_file_path);
+}
+
+void test_least_recently_used_is_evicted() {
+    OpenALContext openal_context;
+    // room for two sounds and a half
+    SoundBufferCache sound_buffer_cache(sound_size_bytes * 5 / 2);
+
+    std::string a = write_sound("lru_a"), b = write_sound("lru_b"), c = write_sound("lru_c");
+    sound_buffer_cache.prewarm({a, b});
+    sound_buffer_cache.wait_until_idle();
+    check(sound_buffer_cache.get_eviction_count() == 0, "something was evicted while under budget");
+
+    // using a makes b the least recently used
+    sound_buffer_cache.acquire(a);
+    sound_buffer_cache.release(a);
+
+    sound_buffer_cache.request(c);
+    sound_buffer_cache.wait_until_idle();
+    check(sound_buffer_cache.is_ready(a), "the recently used sound was evicted");
+    check(not sound_buffer_cache.is_ready(b), "the least recently used sound wasn't evicted");
+    check(sound_buffer_cache.is_ready(c), "the newest sound was evicted");
+    check(sound_buffer_cache.get_eviction_count() == 1, "more than one sound was evicted");
+    check(sound_buffer_cache.get_memory_usage() <= sound_buffer_cache.get_memory_budget(), "the cache is over budget");
+
+    // an evicted sound can be loaded again
+    sound_buffer_cache.request(b);
+    sound_buffer_cache.wait_until_idle();
+    check(sound_buffer_cache.is_ready(b), "the evicted sound didn't load again");
+    check(not sound_buffer_cache.is_ready(a), "loading the evicted sound again didn't evict the next oldest");
+}
+
+void test_acquired_sounds_are_not_evicted() {
+    OpenALContext openal_context;
+    SoundBufferCache sound_buffer_cache(sound_size_bytes * 3);
+
+    std::string a = write_sound("acquired_a"), b = write_sound("acquired_b"), c = write_sound("acquired_c");
+    sound_buffer_cache.prewarm({a, b, c});
+    sound_buffer_cache.wait_until_idle();
+
+    // a is the least recently used but playing
+    ALuint a_buffer = sound_buffer_cache.acquire(a);
+    sound_buffer_cache.acquire(b);
+    sound_buffer_cache.release(b);
+    sound_buffer_cache.acquire(c);
+    sound_buffer_cache.release(c);
+
+    sound_buffer_cache.set_memory_budget(0);
+    check(sound_buffer_cache.is_ready(a), "an acquired sound was evicted");
+    check(alIsBuffer(a_buffer), "the buffer of an acquired sound was deleted");
+    check(not sound_buffer_cache.is_ready(b), "a released sound was kept over budget");
+    check(sound_buffer_cache.is_ready(c), "the most recently used sound wasn't kept");
+
+    // once it is released a is the least recently used and over budget
+    sound_buffer_cache.release(a);
+    check(not sound_buffer_cache.is_ready(a), "the released sound wasn't evicted");
+    check(sound_buffer_cache.get_loaded_count() == 1, "more than the most recently used sound is left");
+}
+
+} // namespace
+
+int main() {
+    return run_tests({
+        {"wait until idle loads every request", test_wait_until_idle_loads_every_request},
+        {"least recently used is evicted", test_least_recently_used_is_evicted},
+        {"acquired sounds are not evicted", test_acquired_sounds_are_not_evicted},
+    });
+}
@@ -0,0 +1,56 @@
+#ifndef TEST_CHECK_HPP
+#define TEST_CHECK_HPP
+
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * just enough to write the tests without pulling in a framework. a test is a function that calls check, the first
+ * failed check throws and run_tests reports it and moves on to the next test, every test executable returns the result
+ * of run_tests from main so that ctest sees the failures
+ */
+
+inline void check(bool condition, const std::string &message) {
+    if (not condition) {
+        throw std::runtime_error(message);
+    }
+}
+
+/**
+ * passes if running throws a std::exception
+ */
+inline void check_throws(const std::function<void()> &run, const std::string &message) {
+    try {
+        run();
+    } catch (const std::exception &) {
+        return;
+    }
+    throw std::runtime_error(message + " didn't throw");
+}
+
+struct TestCase {
+    std::string name;
+    std::function<void()> run;
+};
+
+inline int run_tests(const std::vector<TestCase> &test_cases) {
+    int num_failed = 0;
+    for (const TestCase &test_case : test_cases) {
+        try {
+            test_case.run();
+            std::cout << "passed " << test_case.name << std::endl;
+        } catch (const std::exception &e) {
+            std::cout << "FAILED " << test_case.name << ": " << e.what() << std::endl;
+            num_failed++;
+        }
+    }
+    std::cout << test_cases.size() - num_failed << "/" << test_cases.size() << " passed" << std::endl;
+    return num_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif // TEST_CHECK_HPP
@@ -0,0 +1,303 @@
+#include "utility/work_stealing_scheduler/work_stealing_scheduler.hpp"
+
+#include "test_check.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * every test runs on schedulers with no workers, a few workers and in deterministic mode, the results have to be the
+ * same in all of them. a scheduler is reused across frames and after a throw, so every test runs its work many times on
+ * the same one
+ */
+
+namespace {
+
+struct SchedulerConfiguration {
+    unsigned int num_workers;
+    bool deterministic;
+
+    std::string get_name() const {
+        return std::to_string(num_workers) + " workers" + (deterministic ? " deterministic" : "");
+    }
+};
+
+const std::vector<SchedulerConfiguration> scheduler_configurations = {
+    {0, false}, {1, false}, {2, false}, {4, false}, {8, false}, {4, true},
+};
+
+void for_each_scheduler(const std::function<void(WorkStealingScheduler &, const std::string &)> &run) {
+    for (const SchedulerConfiguration &configuration : scheduler_configurations) {
+        WorkStealingScheduler scheduler(configuration.num_workers, configuration.deterministic);
+        run(scheduler, configuration.get_name());
+    }
+}
+
+void test_tasks_start_after_their_dependencies() {
+    for_each_scheduler([](WorkStealingScheduler &scheduler, const std::string &name) {
+        std::mt19937 rng(1);
+        for (int frame = 0; frame < 50; frame++) {
+            const std::size_t num_tasks = 100;
+            std::atomic<unsigned int> next_ticket{0};
+            std::vector<unsigned int> start_tickets(num_tasks), finish_tickets(num_tasks);
+            std::vector<std::atomic<int>> run_counts(num_tasks);
+            std::vector<std::vector<WorkStealingScheduler::TaskId>> dependencies(num_tasks);
+
+            for (std::size_t task = 0; task < num_tasks; task++) {
+                // up to three earlier tasks, so there are chains, diamonds and tasks that depend on nothing
+                for (unsigned int i = 0, num_dependencies = task == 0 ? 0 : rng() % 4; i < num_dependencies; i++) {
+                    dependencies[task].push_back(rng() % task);
+                }
+                WorkStealingScheduler::TaskId task_id = scheduler.add_task(
+                    [&, task] {
+                        start_tickets[task] = next_ticket++;
+                        run_counts[task]++;
+                        finish_tickets[task] = next_ticket++;
+                    },
+                    dependencies[task]);
+                check(task_id == task, name + ": task ids aren't handed out in adding order");
+            }
+            scheduler.run_tasks();
+
+            for (std::size_t task = 0; task < num_tasks; task++) {
+                check(run_counts[task] == 1, name + ": task " + std::to_string(task) + " didn't run exactly once");
+                for (WorkStealingScheduler::TaskId dependency : dependencies[task]) {
+                    check(start_tickets[task] > finish_tickets[dependency],
+                          name + ": task " + std::to_string(task) + " started before its dependency finished");
+                }
+                if (scheduler.is_deterministic()) {
+                    check(start_tickets[task] == 2 * task, name + ": deterministic tasks didn't run in adding order");
+                }
+            }
+        }
+
+        // nothing left over from the last frame
+        scheduler.run_tasks();
+    });
+}
+
+void test_dependencies_have_to_be_added_first() {
+    for_each_scheduler([](WorkStealingScheduler &scheduler, const std::string &name) {
+        WorkStealingScheduler::TaskId first_task = scheduler.add_task([] {});
+        check_throws([&] { scheduler.add_task([] {}, {first_task + 1}); }, name + ": depending on a later task");
+        scheduler.run_tasks();
+    });
+}
+
+void test_parallel_for_covers_the_range_in_grain_sized_chunks() {
+    struct Range {
+        std::size_t begin, end, grain_size;
+    };
+    const std::vector<Range> ranges = {{0, 1000, 16}, {5, 1005, 64}, {0, 1001, 100}, {0, 7, 0},
+                                       {0, 1, 256},   {3, 3, 8},     {10, 2, 8},     {0, 100000, 256}};
+
+    for_each_scheduler([&](WorkStealingScheduler &scheduler, const std::string &name) {
+        for (const Range &range : ranges) {
+            std::mutex chunks_mutex;
+            std::vector<std::pair<std::size_t, std::size_t>> chunks;
+            scheduler.parallel_for(range.begin, range.end, range.grain_size,
+                                   [&](std::size_t chunk_begin, std::size_t chunk_end) {
+                                       std::lock_guard<std::mutex> lock(chunks_mutex);
+                                       chunks.emplace_back(chunk_begin, chunk_end);
+                                   });
+            std::sort(chunks.begin(), chunks.end());
+
+            std::vector<std::pair<std::size_t, std::size_t>> expected_chunks;
+            std::size_t grain_size = std::max<std::size_t>(range.grain_size, 1);
+            for (std::size_t chunk_begin = range.begin; chunk_begin < range.end; chunk_begin += grain_size) {
+                expected_chunks.emplace_back(chunk_begin, std::min(chunk_begin + grain_size, range.end));
+            }
+            check(chunks == expected_chunks, name + ": the chunks of [" + std::to_string(range.begin) + ", " +
+                                                 std::to_string(range.end) + ") aren't the grain sized ones");
+        }
+    });
+}
+
+void test_nested_parallel_for() {
+    for_each_scheduler([](WorkStealingScheduler &scheduler, const std::string &name) {
+        const std::size_t num_outer = 64, num_inner = 500;
+        for (int frame = 0; frame < 20; frame++) {
+            std::vector<std::atomic<int>> visit_counts(num_outer * num_inner);
+
+            // a parallel_for inside a parallel_for, and a parallel_for inside tasks
+            scheduler.parallel_for(0, num_outer / 2, 1, [&](std::size_t chunk_begin, std::size_t chunk_end) {
+                for (std::size_t outer = chunk_begin; outer < chunk_end; outer++) {
+                    scheduler.parallel_for(0, num_inner, 32, [&](std::size_t inner_begin, std::size_t inner_end) {
+                        for (std::size_t inner = inner_begin; inner < inner_end; inner++) {
+                            visit_counts[outer * num_inner + inner]++;
+                        }
+                    });
+                }
+            });
+            for (std::size_t outer = num_outer / 2; outer < num_outer; outer++) {
+                scheduler.add_task([&, outer] {
+                    scheduler.parallel_for(0, num_inner, 32, [&](std::size_t inner_begin, std::size_t inner_end) {
+                        for (std::size_t inner = inner_begin; inner < inner_end; inner++) {
+                            visit_counts[outer * num_inner + inner]++;
+                        }
+                    });
+                });
+            }
+            scheduler.run_tasks();
+
+            for (std::size_t i = 0; i < visit_counts.size(); i++) {
+                check(visit_counts[i] == 1, name + ": index " + std::to_string(i) + " wasn't visited exactly once");
+            }
+        }
+    });
+}
+
+void test_exceptions_propagate_and_the_scheduler_is_reusable() {
+    for_each_scheduler([](WorkStealingScheduler &scheduler, const std::string &name) {
+        for (int frame = 0; frame < 20; frame++) {
+            std::atomic<bool> dependent_ran{false};
+            std::atomic<int> independent_run_count{0};
+            for (int i = 0; i < 8; i++) {
+                scheduler.add_task([&] { independent_run_count++; });
+            }
+            WorkStealingScheduler::TaskId throwing_task =
+                scheduler.add_task([] { throw std::runtime_error("task failed"); });
+            scheduler.add_task([&] { dependent_ran = true; }, {throwing_task});
+
+            bool rethrown = false;
+            try {
+                scheduler.run_tasks();
+            } catch (const std::runtime_error &e) {
+                rethrown = std::string(e.what()) == "task failed";
+            }
+            check(rethrown, name + ": the task's exception wasn't rethrown by run_tasks");
+            check(not dependent_ran, name + ": a task ran after its dependency threw");
+            check(independent_run_count <= 8, name + ": a task ran more than once");
+
+            // the next frame starts from nothing and runs normally
+            std::atomic<int> run_count{0};
+            WorkStealingScheduler::TaskId first_task = scheduler.add_task([&] { run_count++; });
+            check(first_task == 0, name + ": the failed frame's tasks weren't cleared");
+            scheduler.add_task([&] { run_count++; }, {first_task});
+            scheduler.run_tasks();
+            check(run_count == 2, name + ": the scheduler didn't run tasks after a throw");
+
+            rethrown = false;
+            try {
+                scheduler.parallel_for(0, 1000, 10, [](std::size_t chunk_begin, std::size_t chunk_end) {
+                    if (chunk_begin <= 500 and 500 < chunk_end) {
+                        throw std::runtime_error("chunk failed");
+                    }
+                });
+            } catch (const std::runtime_error &e) {
+                rethrown = std::string(e.what()) == "chunk failed";
+            }
+            check(rethrown, name + ": the chunk's exception wasn't rethrown by parallel_for");
+
+            std::atomic<std::size_t> sum{0};
+            scheduler.parallel_for(0, 1000, 10, [&](std::size_t chunk_begin, std::size_t chunk_end) {
+                for (std::size_t i = chunk_begin; i < chunk_end; i++) {
+                    sum += i;
+                }
+            });
+            check(sum == 999 * 1000 / 2, name + ": parallel_for didn't cover the range after a throw");
+        }
+    });
+}
+
+/**
+ * what one frame of the comparison computes, every value is written by exactly one chunk or task and the sums are
+ * only ever combined in index or chunk order, never in the order the work happened to finish
+ */
+struct ParallelResults {
+    std::vector<float> values;     // one per index, from parallel_for
+    std::vector<float> chunk_sums; // the values of each parallel_for chunk summed in index order
+    std::vector<float> task_sums;  // one per task, over a slice of the values
+    float total;                   // the task sums combined in task order by a task that depends on all of them
+};
+
+void compute_parallel_results(WorkStealingScheduler &scheduler, ParallelResults &results) {
+    const std::size_t num_values = 100000, grain_size = 256, num_tasks = 37;
+    const float unset = std::numeric_limits<float>::quiet_NaN();
+
+    // cleared first so that a value nobody wrote can't pass for one left over from the previous run
+    results.values.assign(num_values, unset);
+    results.chunk_sums.assign((num_values + grain_size - 1) / grain_size, unset);
+    results.task_sums.assign(num_tasks, unset);
+    results.total = unset;
+
+    scheduler.parallel_for(0, num_values, grain_size, [&](std::size_t chunk_begin, std::size_t chunk_end) {
+        float chunk_sum = 0.0f;
+        for (std::size_t i = chunk_begin; i < chunk_end; i++) {
+            float x = i * 0.001f;
+            results.values[i] = std::sin(x) * std::exp(-x * 0.01f) + std::sqrt(static_cast<float>(i)) * 1e-3f;
+            chunk_sum += results.values[i];
+        }
+        results.chunk_sums[chunk_begin / grain_size] = chunk_sum;
+    });
+
+    std::vector<WorkStealingScheduler::TaskId> task_ids;
+    for (std::size_t task = 0; task < num_tasks; task++) {
+        task_ids.push_back(scheduler.add_task([&, task] {
+            float task_sum = 0.0f;
+            for (std::size_t i = task * num_values / num_tasks; i < (task + 1) * num_values / num_tasks; i++) {
+                task_sum += results.values[i] * results.values[i];
+            }
+            results.task_sums[task] = task_sum;
+        }));
+    }
+    scheduler.add_task(
+        [&] {
+            float total = 0.0f;
+            for (float task_sum : results.task_sums) {
+                total += task_sum;
+            }
+            results.total = total;
+        },
+        task_ids);
+    scheduler.run_tasks();
+}
+
+bool same_bits(const std::vector<float> &a, const std::vector<float> &b) {
+    return a.size() == b.size() and std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+}
+
+void test_parallel_results_match_deterministic_ones() {
+    ParallelResults deterministic_results;
+    WorkStealingScheduler deterministic_scheduler(4, true);
+    compute_parallel_results(deterministic_scheduler, deterministic_results);
+    check(not std::isnan(deterministic_results.total), "the deterministic run didn't compute everything");
+
+    for_each_scheduler([&](WorkStealingScheduler &scheduler, const std::string &name) {
+        ParallelResults results;
+        for (int frame = 0; frame < 20; frame++) {
+            compute_parallel_results(scheduler, results);
+            check(same_bits(results.values, deterministic_results.values),
+                  name + ": the per index values differ from the deterministic run");
+            check(same_bits(results.chunk_sums, deterministic_results.chunk_sums),
+                  name + ": the chunk sums differ from the deterministic run");
+            check(same_bits(results.task_sums, deterministic_results.task_sums),
+                  name + ": the task sums differ from the deterministic run");
+            check(same_bits({results.total}, {deterministic_results.total}),
+                  name + ": the total differs from the deterministic run");
+        }
+    });
+}
+
+} // namespace
+
+int main() {
+    return run_tests({
+        {"tasks start after their dependencies", test_tasks_start_after_their_dependencies},
+        {"dependencies have to be added first", test_dependencies_have_to_be_added_first},
+        {"parallel_for covers the range in grain sized chunks",
+         test_parallel_for_covers_the_range_in_grain_sized_chunks},
+        {"nested parallel_for", test_nested_parallel_for},
+        {"exceptions propagate and the scheduler is reusable", test_exceptions_propagate_and_the_scheduler_is_reusable},
+        {"parallel results match deterministic ones", test_parallel_results_match_deterministic_ones},
+    });
+}
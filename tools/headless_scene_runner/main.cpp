@@ -0,0 +1,178 @@
+#include "graphics/compiled_scripted_path/compiled_scripted_path.hpp"
+#include "graphics/particle_budget_manager/particle_budget_manager.hpp"
+#include "graphics/scene_state_timeline/scene_state_timeline.hpp"
+#include "graphics/scripted_event_timeline/scripted_event_timeline.hpp"
+#include "graphics/smoke_particle_emitters/smoke_particle_emitters.hpp"
+
+#include "utility/animation_pose_cache/animation_pose_cache.hpp"
+#include "utility/bone_socket_system/bone_socket_system.hpp"
+#include "utility/rigged_model_loading/rigged_model_loading.hpp"
+#include "utility/simulation_clock/simulation_clock.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct HeadlessSceneRunnerArguments {
+    double duration_sec = 25.0;
+    double fixed_timestep_sec = 1.0 / 60.0;
+};
+
+static HeadlessSceneRunnerArguments parse_arguments(int argc, char *argv[]) {
+    std::string usage = "usage: " + std::string(argv[0]) + " [--duration sec] [--timestep sec]";
+    auto parse_seconds = [&](const char *value) {
+        try {
+            return std::stod(value);
+        } catch (const std::exception &) {
+            throw std::runtime_error(std::string(value) + " isn't a number of seconds\n" + usage);
+        }
+    };
+
+    HeadlessSceneRunnerArguments arguments;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "--duration" and i + 1 < argc) {
+            arguments.duration_sec = parse_seconds(argv[++i]);
+        } else if (argument == "--timestep" and i + 1 < argc) {
+            arguments.fixed_timestep_sec = parse_seconds(argv[++i]);
+        } else {
+            throw std::runtime_error(usage);
+        }
+    }
+    // with a timestep that isn't positive or a duration that isn't finite the run would never end
+    if (not std::isfinite(arguments.fixed_timestep_sec) or arguments.fixed_timestep_sec <= 0.0) {
+        throw std::runtime_error("the timestep has to be a positive number of seconds\n" + usage);
+    }
+    if (not std::isfinite(arguments.duration_sec) or arguments.duration_sec < 0.0) {
+        throw std::runtime_error("the duration has to be a finite number of seconds, zero or more\n" + usage);
+    }
+    return arguments;
+}
+
+/**
+ * steps the scripted parts of the smoking scene (camera path, events, scene state, smoke particles and the bone
+ * animation) with a fixed timestep and no window or gl context, as fast as the cpu allows
+ */
+int main(int argc, char *argv[]) {
+    HeadlessSceneRunnerArguments arguments;
+    try {
+        arguments = parse_arguments(argc, argv);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    ScriptedTransform scripted_transform =
+        load_compiled_scripted_path("assets/scripted_paths/smoking_camera.scripted_path");
+    ScriptedEventTimeline scripted_event_timeline("assets/smoking/smoking_event.json");
+    SceneStateTimeline scene_state_timeline("assets/scene_script.json");
+
+    RecIvpntRiggedCollector rirc;
+    std::vector<IVPNTRigged> smoke_ivpntrs = rirc.parse_model_into_ivpntrs("assets/smoking/smoking.fbx");
+
+    Transform spe_transform;
+    spe_transform.position = glm::vec3(0, 0, 0);
+    spe_transform.scale = glm::vec3(.2, .2, .2);
+    // fixed seeds so that two runs of the same script simulate the same smoke
+    CigaretteSmokeParticleEmitter cs_pe(300, spe_transform, 1);
+    BlowingSmokeParticleEmitter bs_pe(300, spe_transform, 2);
+    bs_pe.stop_emitting_particles();
+    cs_pe.stop_emitting_particles();
+
+    // same budget as the windowed scene, there is no camera distance here so screen importance stays at 1
+    ParticleBudgetManager particle_budget_manager(400, 0.001);
+    particle_budget_manager.register_emitter("cigarette smoke", cs_pe.budget, 1.0f);
+    particle_budget_manager.register_emitter("blowing smoke", bs_pe.budget, 2.0f);
+
+    // same particle toggles as the windowed scene so that the particle load matches it, every edge is counted
+    unsigned long long fired_event_edges = 0;
+    for (unsigned int event_id = 0; event_id < scripted_event_timeline.get_event_count(); event_id++) {
+        scripted_event_timeline.bind_callback(event_id,
+                                              [&](bool first_call, bool last_call) { fired_event_edges++; });
+    }
+    scripted_event_timeline.bind_callback(scripted_event_timeline.intern_event_name("inhale"),
+                                          [&](bool first_call, bool last_call) {
+                                              fired_event_edges++;
+                                              if (first_call) {
+                                                  cs_pe.stop_emitting_particles();
+                                              }
+                                              if (last_call) {
+                                                  cs_pe.resume_emitting_particles();
+                                              }
+                                          });
+    scripted_event_timeline.bind_callback(scripted_event_timeline.intern_event_name("exhale"),
+                                          [&](bool first_call, bool last_call) {
+                                              fired_event_edges++;
+                                              if (first_call) {
+                                                  bs_pe.resume_emitting_particles();
+                                              }
+                                              if (last_call) {
+                                                  bs_pe.stop_emitting_particles();
+                                              }
+                                          });
+
+    SimulationClock simulation_clock(arguments.fixed_timestep_sec);
+    AnimationPoseCache animation_pose_cache;
+    unsigned int smoking_clip_id = animation_pose_cache.register_clip(rirc);
+
+    // the emitters ride on the same bones as in the windowed scene
+    BoneSocketSystem bone_socket_system(rirc);
+    Transform cig_tip_offset;
+    cig_tip_offset.position = glm::vec3(.05, 0, -.05);
+    unsigned int cig_tip_socket = bone_socket_system.register_socket("cig_root", cig_tip_offset);
+    Transform mouth_offset;
+    mouth_offset.position = glm::vec3(0, 0.02, .08);
+    unsigned int mouth_socket = bone_socket_system.register_socket("head", mouth_offset);
+
+    unsigned long long scene_state_changes = 0;
+    unsigned long long simulated_particles = 0;
+
+    auto wall_clock_start = std::chrono::steady_clock::now();
+
+    while (simulation_clock.get_time_sec() < arguments.duration_sec) {
+        simulation_clock.tick();
+        double delta_time = simulation_clock.get_delta_time_sec();
+
+        scripted_transform.update(simulation_clock.get_time_ms());
+        glm::mat4 world_to_camera = glm::inverse(scripted_transform.transform.get_transform_matrix());
+
+        scene_state_timeline.advance(simulation_clock.get_time_ms());
+        scene_state_changes += scene_state_timeline.get_slots_changed_by_last_advance().size();
+
+        cs_pe.update(delta_time, world_to_camera);
+        bs_pe.update(delta_time, world_to_camera);
+        simulated_particles += cs_pe.get_particles_sorted_by_distance().size();
+        simulated_particles += bs_pe.get_particles_sorted_by_distance().size();
+        particle_budget_manager.rebalance();
+
+        bone_socket_system.evaluate(animation_pose_cache.get_pose(smoking_clip_id, simulation_clock.get_time_sec()));
+        cs_pe.transform.set_transform_matrix(bone_socket_system.get_socket_transform(cig_tip_socket));
+        bs_pe.transform.set_transform_matrix(bone_socket_system.get_socket_transform(mouth_socket));
+
+        scripted_event_timeline.run_scripted_events(simulation_clock.get_time_sec());
+    }
+
+    std::chrono::duration<double> wall_clock_duration = std::chrono::steady_clock::now() - wall_clock_start;
+    double wall_clock_sec = wall_clock_duration.count();
+
+    std::cout << "simulated " << simulation_clock.get_time_sec() << "s in " << simulation_clock.get_tick_count()
+              << " ticks of " << arguments.fixed_timestep_sec << "s" << std::endl;
+    std::cout << "wall clock " << wall_clock_sec << "s, "
+              << simulation_clock.get_time_sec() / wall_clock_sec << "x real time, "
+              << wall_clock_sec * 1e6 / simulation_clock.get_tick_count() << "us per tick" << std::endl;
+    std::cout << "event edges fired: " << fired_event_edges << ", scene state changes: " << scene_state_changes
+              << ", particle updates: " << simulated_particles << std::endl;
+    std::cout << "animation poses: " << animation_pose_cache.get_hit_count() << " hits, "
+              << animation_pose_cache.get_miss_count() << " misses" << std::endl;
+    for (const ParticleEmitterStats &stats : particle_budget_manager.get_emitter_stats()) {
+        std::cout << stats.name << ": " << stats.alive_particle_count << " alive, spawn rate scale "
+                  << stats.spawn_rate_scale << ", life span scale " << stats.life_span_scale << ", "
+                  << stats.average_update_cost_sec * 1e6 << "us per update" << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
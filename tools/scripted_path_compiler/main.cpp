@@ -0,0 +1,23 @@
+#include "graphics/compiled_scripted_path/compiled_scripted_path.hpp"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+
+// compiles the json description of a scripted path into the binary format that load_compiled_scripted_path maps
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        std::cerr << "usage: " << argv[0] << " <scripted_path_description.json> <output.scripted_path>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try {
+        ScriptedTransform scripted_transform = parse_scripted_path_description(argv[1]);
+        write_compiled_scripted_path(argv[2], scripted_transform);
+    } catch (const std::exception &e) {
+        std::cerr << "failed to compile " << argv[1] << ": " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}